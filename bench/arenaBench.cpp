@@ -0,0 +1,79 @@
+#include "programGenerator.h"
+
+#include "fdlang/scanner.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// resident set size in bytes
+static size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// touch every operand the way a transfer function does
+static long long scanOperands(const IR::Functions &funcs) {
+    long long sum = 0;
+    for (IR::Function *function : funcs)
+        for (IR::Inst *inst : function->getInsts())
+            for (size_t i = 0; i < inst->getOperandSize(); i++) {
+                IR::Value *value = inst->getOperand(i);
+                sum += value->isNumber() ? value->getAsNumber()
+                                         : value->getAsVariable();
+            }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 2500;
+    size_t rounds = argc > 2 ? std::atol(argv[2]) : 20;
+    std::string src = bench::generateNestedProgram(numFunctions, 40);
+
+    size_t before = residentBytes();
+    auto begin = Clock::now();
+    auto *scanner = new Scanner(src);
+    auto *parser = new LoweringParser(*scanner);
+    parser->parse();
+    IR::Functions funcs = parser->getBuilder().getFunctions();
+    double lowerTime = since(begin);
+    size_t memory = residentBytes() - before;
+
+    size_t numInsts = 0;
+    for (IR::Function *function : funcs)
+        numInsts += function->getInsts().size();
+
+    long long sum = 0;
+    begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++)
+        sum += scanOperands(funcs);
+    double scanTime = since(begin) / rounds;
+
+    begin = Clock::now();
+    delete parser;
+    delete scanner;
+    double freeTime = since(begin);
+
+    std::cout << "instructions:   " << numInsts << " (" << sum << ")\n";
+    std::cout << "lowering:       " << lowerTime * 1e3 << " ms, "
+              << memory / (1 << 20) << " MiB resident\n";
+    std::cout << "operand scan:   " << scanTime * 1e3 << " ms\n";
+    std::cout << "teardown:       " << freeTime * 1e3 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "fdlang/AST.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+
+#include "IR/IR.h"
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/callGraph.h"
+
+#include "programGenerator.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 100000;
+    std::string src = bench::generateProgram(numFunctions);
+
+    // the parser resolves AST callees once it has every function
+    auto begin = Clock::now();
+    Scanner astScanner(src);
+    Parser astParser(astScanner);
+    ASTNode *root = astParser.parse();
+    double parseTime = since(begin);
+    delete root;
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    if (scanner.hadError() || parser.hadError())
+        return 1;
+    IR::Functions funcs = parser.getBuilder().getFunctions();
+
+    begin = Clock::now();
+    IR::IRBuilder::link(funcs);
+    double linkTime = since(begin);
+
+    begin = Clock::now();
+    IR::CallGraph graph(funcs);
+    double graphTime = since(begin);
+
+    std::cout << "functions:   " << graph.size() << "\n";
+    std::cout << "components:  " << graph.numComponents() << "\n";
+    std::cout << "roots:       " << graph.getRoots().size() << "\n";
+    std::cout << "AST parse:   " << parseTime * 1e3 << " ms\n";
+    std::cout << "IR link:     " << linkTime * 1e3 << " ms\n";
+    std::cout << "call graph:  " << graphTime * 1e3 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "programGenerator.h"
+
+#include "fdlang/scanner.h"
+
+#include "IR/CSRGraph.h"
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// breadth-first search from every function entry over Inst pointers and the
+// label map, as the worklist engines did
+static size_t visitPointers(const IR::Functions &funcs) {
+    size_t visited = 0;
+    for (IR::Function *function : funcs) {
+        std::vector<bool> seen(function->getInsts().size(), false);
+        std::vector<IR::Inst *> queue = {function->getInsts().front()};
+        seen[0] = true;
+        for (size_t i = 0; i < queue.size(); i++) {
+            visited++;
+            for (IR::Inst *successor : queue[i]->getSuccessors()) {
+                size_t index = function->getIndex(successor->getLabel());
+                if (!seen[index]) {
+                    seen[index] = true;
+                    queue.push_back(successor);
+                }
+            }
+        }
+    }
+    return visited;
+}
+
+static size_t visitCSR(const std::vector<IR::CSRGraph> &graphs) {
+    size_t visited = 0;
+    for (const IR::CSRGraph &graph : graphs) {
+        std::vector<bool> seen(graph.size(), false);
+        std::vector<IR::NodeId> queue = {0};
+        seen[0] = true;
+        for (size_t i = 0; i < queue.size(); i++) {
+            visited++;
+            for (IR::NodeId successor : graph.successors(queue[i])) {
+                if (!seen[successor]) {
+                    seen[successor] = true;
+                    queue.push_back(successor);
+                }
+            }
+        }
+    }
+    return visited;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 1000;
+    size_t rounds = argc > 2 ? std::atol(argv[2]) : 100;
+    std::string src = bench::generateNestedProgram(numFunctions, 40);
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    IR::Functions funcs = parser.getBuilder().getFunctions();
+
+    auto begin = Clock::now();
+    std::vector<IR::CSRGraph> graphs;
+    for (IR::Function *function : funcs)
+        graphs.push_back(IR::CSRGraph::fromInsts(function));
+    double buildTime = since(begin);
+
+    size_t pointerVisits = 0, csrVisits = 0;
+    begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++)
+        pointerVisits += visitPointers(funcs);
+    double pointerTime = since(begin) / rounds;
+
+    begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++)
+        csrVisits += visitCSR(graphs);
+    double csrTime = since(begin) / rounds;
+
+    if (pointerVisits != csrVisits) {
+        std::cerr << "traversals disagree\n";
+        return 1;
+    }
+    std::cout << "instructions:   " << pointerVisits / rounds << "\n";
+    std::cout << "CSR build:      " << buildTime * 1e3 << " ms\n";
+    std::cout << "Inst pointers:  " << pointerTime * 1e3 << " ms\n";
+    std::cout << "CSR:            " << csrTime * 1e3 << " ms ("
+              << pointerTime / csrTime << "x)\n";
+    return 0;
+}
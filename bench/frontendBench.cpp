@@ -0,0 +1,57 @@
+#include "programGenerator.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+#include "frontend/frontend.h"
+
+#include "IR/IRBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// scan, parse, Sema and IRBuilder::build on the calling thread
+static double timeSequential(const std::string &src) {
+    auto begin = Clock::now();
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    Sema sema(root);
+    sema.check();
+    IR::IRBuilder irBuilder(root);
+    irBuilder.build();
+    return since(begin);
+}
+
+static double timeParallel(const std::string &src, unsigned numThreads) {
+    auto begin = Clock::now();
+    frontend::Frontend frontend(src, numThreads);
+    frontend.run();
+    return since(begin);
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 5000;
+    std::string src = bench::generateProgram(numFunctions);
+
+    std::cout << "functions:  " << numFunctions << "\n";
+    std::cout << "sequential: " << timeSequential(src) * 1e3 << " ms\n";
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned numThreads = 1; numThreads <= hardware; numThreads *= 2)
+        std::cout << numThreads << " threads:  "
+                  << timeParallel(src, numThreads) * 1e3 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "programGenerator.h"
+
+#include "frontend/frontend.h"
+#include "frontend/incremental.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static double timeFull(const std::string &src) {
+    auto begin = Clock::now();
+    frontend::Frontend frontend(src);
+    frontend.run();
+    return since(begin);
+}
+
+static double timeUpdate(frontend::IncrementalFrontend &frontend,
+                         const std::string &src) {
+    auto begin = Clock::now();
+    frontend.update(src);
+    return since(begin);
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 5000;
+    std::string src = bench::generateProgram(numFunctions);
+
+    // change a constant in the middle function
+    std::string edited = src;
+    size_t middle = edited.find("function_" + std::to_string(numFunctions / 2) +
+                                "(counter_value, upper_bound)");
+    size_t constant = edited.find("+ 128", middle);
+    edited.replace(constant, 5, "+ 129");
+
+    frontend::IncrementalFrontend frontend;
+    std::cout << "functions:       " << numFunctions << "\n";
+    std::cout << "full frontend:   " << timeFull(edited) * 1e3 << " ms\n";
+    std::cout << "first update:    " << timeUpdate(frontend, src) * 1e3
+              << " ms\n";
+    std::cout << "one edit:        " << timeUpdate(frontend, edited) * 1e3
+              << " ms (" << frontend.rebuiltFunctions() << " rebuilt)\n";
+    std::cout << "lines inserted:  "
+              << timeUpdate(frontend, "\n\n" + edited) * 1e3 << " ms ("
+              << frontend.rebuiltFunctions() << " rebuilt)\n";
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "fdlang/scanner.h"
+
+#include "analysis/intervalAnalysis.h"
+#include "analysis/packedIntervals.h"
+#include "analysis/valueSetAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// loops updating `numVars' variables each, so joins dominate
+static std::string generateProgram(size_t numVars, size_t numLoops) {
+    auto var = [](size_t i) { return "v" + std::to_string(i); };
+    std::string src = "function main() {\n";
+    for (size_t i = 0; i < numVars; i++)
+        src += "    " + var(i) + " = input();\n";
+    for (size_t loop = 0; loop < numLoops; loop++) {
+        src += "    i = 0;\n    while (i < 200) {\n";
+        for (size_t i = 0; i < numVars; i++)
+            src += "        " + var(i) + " = " + var((i + loop + 1) % numVars) +
+                   " - 1;\n";
+        src += "        i = i + 1;\n    }\n";
+        src += "    check_interval(i, 200, 200);\n";
+    }
+    src += "}\n";
+    return src;
+}
+
+// the join of std::vector<Interval> states, one variable at a time
+static bool joinInto(const States &x, States &y) {
+    bool changed = false;
+    for (size_t i = 0; i < x.size(); i++) {
+        if (x[i].isBottom)
+            continue;
+        Interval joined = x[i];
+        if (!y[i].isBottom) {
+            joined.l = std::min(joined.l, y[i].l);
+            joined.r = std::max(joined.r, y[i].r);
+        }
+        changed |= !(joined == y[i]);
+        y[i] = joined;
+    }
+    return changed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numVars = argc > 1 ? std::atol(argv[1]) : 200;
+    size_t numLoops = argc > 2 ? std::atol(argv[2]) : 4;
+    size_t numJoins = 1000000;
+
+    // joins of states differing in every variable
+    std::vector<Interval> unpackedX(numVars), unpackedY(numVars);
+    PackedIntervals packedX(numVars, true), packedY(numVars, true);
+    for (size_t i = 0; i < numVars; i++) {
+        unpackedX[i] = {(long long)(i % 7), 200, false};
+        unpackedY[i] = {5, (long long)(100 + i % 100), false};
+        packedX.set(i, unpackedX[i]);
+        packedY.set(i, unpackedY[i]);
+    }
+    size_t changes = 0;
+    double unpackedTime[3], packedTime[3];
+    // a transfer: copy the state and set one variable
+    auto begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++) {
+        States y = unpackedY;
+        y[i % numVars] = unpackedX[i % numVars];
+        changes += y[0].l;
+    }
+    unpackedTime[0] = since(begin);
+    begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++) {
+        PackedIntervals y = packedY;
+        y.set(i % numVars, unpackedX[i % numVars]);
+        changes += y.get(0).l;
+    }
+    packedTime[0] = since(begin);
+
+    // a join into a copy, changing every variable
+    begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++) {
+        States y = unpackedY;
+        changes += joinInto(unpackedX, y);
+    }
+    unpackedTime[1] = since(begin);
+    begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++) {
+        PackedIntervals y = packedY;
+        changes += y.joinWith(packedX);
+    }
+    packedTime[1] = since(begin);
+
+    // a join that changes nothing, as at a fixed point
+    States unpackedJoin = unpackedY;
+    joinInto(unpackedX, unpackedJoin);
+    PackedIntervals packedJoin = packedY;
+    packedJoin.joinWith(packedX);
+    begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++)
+        changes += joinInto(unpackedX, unpackedJoin);
+    unpackedTime[2] = since(begin);
+    begin = Clock::now();
+    for (size_t i = 0; i < numJoins; i++)
+        changes += packedJoin.joinWith(packedX);
+    packedTime[2] = since(begin);
+
+    std::string src = generateProgram(numVars, numLoops);
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    if (scanner.hadError() || parser.hadError())
+        return 1;
+    begin = Clock::now();
+    IntervalAnalysis analysis(parser.getBuilder().getFunctions());
+    analysis.run();
+    double analysisTime = since(begin);
+    begin = Clock::now();
+    ValueSetAnalysis valueSets(parser.getBuilder().getFunctions());
+    valueSets.run();
+    double valueSetTime = since(begin);
+
+    const char *names[] = {"copy and set", "copy and join", "stable join"};
+    std::cout << numVars << " variables, " << numJoins << " times each ("
+              << changes << ")\n";
+    std::cout << "                std::vector<Interval>  PackedIntervals\n";
+    for (int i = 0; i < 3; i++)
+        std::cout << "  " << names[i] << ":\t" << unpackedTime[i] * 1e3
+                  << " ms\t" << packedTime[i] * 1e3 << " ms\n";
+    std::cout << "interval analysis: " << analysisTime * 1e3 << " ms, "
+              << analysis.getIterations() << " transfers\n";
+    std::cout << "value-set analysis: " << valueSetTime * 1e3 << " ms, "
+              << valueSets.getIterations() << " transfers\n";
+    return 0;
+}
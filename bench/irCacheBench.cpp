@@ -0,0 +1,82 @@
+#include "programGenerator.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/IRCache.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// map a file and build its IR, then free it all
+template <typename Load>
+static double timeLoad(const std::string &path, Load load, size_t &numInsts) {
+    auto begin = Clock::now();
+    {
+        SourceBuffer buffer(path);
+        numInsts = 0;
+        load(buffer.text(), numInsts);
+    }
+    return since(begin);
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 2000;
+    std::string srcPath = "irCacheBench.fdlang";
+    std::string cachePath = "irCacheBench.irc";
+    std::ofstream(srcPath) << bench::generateProgram(numFunctions);
+
+    {
+        SourceBuffer src(srcPath);
+        Scanner scanner(src.text());
+        LoweringParser parser(scanner);
+        parser.parse();
+        std::ofstream out(cachePath, std::ios::binary);
+        IR::IRCache::write(parser.getBuilder().getFunctions(), out);
+    }
+
+    size_t loweredInsts, cachedInsts;
+    double loweringTime = timeLoad(
+        srcPath,
+        [](std::string_view text, size_t &numInsts) {
+            Scanner scanner(text);
+            LoweringParser parser(scanner);
+            parser.parse();
+            for (IR::Function *func : parser.getBuilder().getFunctions())
+                numInsts += func->getInsts().size();
+        },
+        loweredInsts);
+    double cacheTime = timeLoad(
+        cachePath,
+        [](std::string_view image, size_t &numInsts) {
+            IR::IRCache cache(image);
+            for (IR::Function *func : cache.getFunctions())
+                numInsts += func->getInsts().size();
+        },
+        cachedInsts);
+
+    std::ifstream cacheFile(cachePath, std::ios::binary | std::ios::ate);
+    std::cout << "functions:     " << numFunctions << "\n";
+    std::cout << "instructions:  " << loweredInsts << " / " << cachedInsts
+              << "\n";
+    std::cout << "cache size:    " << cacheFile.tellg() / 1024 << " KiB\n";
+    std::cout << "frontend:      " << loweringTime * 1e3 << " ms\n";
+    std::cout << "IR cache:      " << cacheTime * 1e3 << " ms ("
+              << loweringTime / cacheTime << "x)\n";
+    std::remove(srcPath.c_str());
+    std::remove(cachePath.c_str());
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "fdlang/scanner.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/controlFlowInfo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// `numNests' nests of `depth' counting while loops one after another, the
+// innermost loop of each like that of loop3.fdlang
+static std::string generateDeepNests(size_t numNests, size_t depth) {
+    auto var = [](size_t level) { return "l" + std::to_string(level); };
+    std::string src = "function main() {\n    x = 1;\n";
+    for (size_t nest = 0; nest < numNests; nest++) {
+        for (size_t level = 0; level < depth; level++) {
+            std::string indent(4 * (level + 1), ' ');
+            src += indent + var(level) + " = 0;\n";
+            src += indent + "while (" + var(level) + " < " +
+                   std::to_string(level % 250 + 2) + ") {\n";
+        }
+        std::string indent(4 * (depth + 1), ' ');
+        src += indent + "x = x + x;\n";
+        src += indent + "if (x >= 101) {\n";
+        src += indent + "    x = x - 101;\n";
+        src += indent + "} else {\n";
+        src += indent + "    nop;\n";
+        src += indent + "}\n";
+        for (size_t level = depth; level-- > 0;) {
+            std::string indent(4 * (level + 1), ' ');
+            src += indent + "    " + var(level) + " = " + var(level) +
+                   " + 1;\n";
+            src += indent + "}\n";
+        }
+    }
+    src += "    check_interval(x, 0, 100);\n}\n";
+    return src;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numNests = argc > 1 ? std::atol(argv[1]) : 200;
+    size_t depth = argc > 2 ? std::atol(argv[2]) : 64;
+    std::string src = generateDeepNests(numNests, depth);
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    if (scanner.hadError() || parser.hadError())
+        return 1;
+    IR::Function *function = parser.getBuilder().getFunctions()[0];
+    IR::ControlFlowInfo &info = function->getControlFlow();
+
+    auto begin = Clock::now();
+    info.getGraph();
+    double graphTime = since(begin);
+    begin = Clock::now();
+    info.getDominators();
+    double dominatorTime = since(begin);
+    begin = Clock::now();
+    info.getPostDominators();
+    double postDominatorTime = since(begin);
+    begin = Clock::now();
+    const IR::LoopForest &loops = info.getLoops();
+    double loopTime = since(begin);
+
+    // later queries find everything cached
+    begin = Clock::now();
+    size_t numInsts = function->getInsts().size(), maxDepth = 0;
+    for (size_t i = 0; i < 1000; i++)
+        maxDepth = std::max<size_t>(
+            maxDepth,
+            function->getControlFlow().getLoops().getDepth(i % numInsts));
+    double cachedTime = since(begin);
+
+    std::cout << "instructions:     " << numInsts << "\n";
+    std::cout << "loops:            " << loops.size() << "\n";
+    std::cout << "max depth:        " << maxDepth << "\n";
+    std::cout << "graph:            " << graphTime * 1e3 << " ms\n";
+    std::cout << "dominators:       " << dominatorTime * 1e3 << " ms\n";
+    std::cout << "post-dominators:  " << postDominatorTime * 1e3 << " ms\n";
+    std::cout << "loop forest:      " << loopTime * 1e3 << " ms\n";
+    std::cout << "1000 cached uses: " << cachedTime * 1e3 << " ms\n";
+    return 0;
+}
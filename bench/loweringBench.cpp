@@ -0,0 +1,71 @@
+#include "programGenerator.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// scan, parse, Sema and IRBuilder::build over the AST, then free it all
+static double timeAST(const std::string &src, size_t &numInsts) {
+    auto begin = Clock::now();
+    {
+        Scanner scanner(src);
+        Parser parser(scanner);
+        ASTNode *root = parser.parse();
+        Sema sema(root);
+        sema.check();
+        IR::IRBuilder irBuilder(root);
+        numInsts = 0;
+        for (IR::Function *func : irBuilder.build())
+            numInsts += func->getInsts().size();
+        delete root;
+    }
+    return since(begin);
+}
+
+// the same through LoweringParser
+static double timeLowering(const std::string &src, size_t &numInsts) {
+    auto begin = Clock::now();
+    {
+        Scanner scanner(src);
+        LoweringParser parser(scanner);
+        parser.parse();
+        numInsts = 0;
+        for (IR::Function *func : parser.getBuilder().getFunctions())
+            numInsts += func->getInsts().size();
+    }
+    return since(begin);
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 2000;
+    std::string src = bench::generateProgram(numFunctions);
+
+    size_t astInsts, loweredInsts;
+    double astTime = timeAST(src, astInsts);
+    double loweringTime = timeLowering(src, loweredInsts);
+
+    std::cout << "functions:     " << numFunctions << "\n";
+    std::cout << "instructions:  " << astInsts << " / " << loweredInsts
+              << "\n";
+    std::cout << "AST + build:   " << astTime * 1e3 << " ms\n";
+    std::cout << "fused:         " << loweringTime * 1e3 << " ms ("
+              << astTime / loweringTime << "x)\n";
+    return 0;
+}
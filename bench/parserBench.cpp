@@ -0,0 +1,109 @@
+#include "programGenerator.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+
+#include "IR/IRBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+struct Timing {
+    double parse = 1e30, lower = 1e30, teardown = 1e30;
+};
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// Sema and IRBuilder::build over `root'
+template <typename Root> static double lower(Root root) {
+    auto begin = Clock::now();
+    Sema sema(root);
+    sema.check();
+    IR::IRBuilder builder(root);
+    builder.build();
+    return since(begin);
+}
+
+// Best parse, check and lower, and teardown times over `rounds' runs
+static Timing timePointer(const std::vector<Token> &tokens, int rounds) {
+    Timing best;
+    for (int i = 0; i < rounds; i++) {
+        auto begin = Clock::now();
+        Parser parser(tokens);
+        ASTNode *root = parser.parse();
+        best.parse = std::min(best.parse, since(begin));
+        best.lower = std::min(best.lower, lower(root));
+
+        begin = Clock::now();
+        delete root;
+        best.teardown = std::min(best.teardown, since(begin));
+    }
+    return best;
+}
+
+static Timing timeFlat(const std::vector<Token> &tokens, int rounds) {
+    Timing best;
+    for (int i = 0; i < rounds; i++) {
+        auto begin = Clock::now();
+        auto *parser = new FlatParser(tokens);
+        NodeIndex root = parser->parse();
+        best.parse = std::min(best.parse, since(begin));
+        FlatNodeRef ref = {&parser->getBuilder().getAST(), root};
+        best.lower = std::min(best.lower, lower(ref));
+
+        begin = Clock::now();
+        delete parser;
+        best.teardown = std::min(best.teardown, since(begin));
+    }
+    return best;
+}
+
+// Check and lower time through a materialized pointer AST instead
+static double timeMaterialized(const std::vector<Token> &tokens,
+                               int rounds) {
+    FlatParser parser(tokens);
+    NodeIndex root = parser.parse();
+    double best = 1e30;
+    for (int i = 0; i < rounds; i++) {
+        auto begin = Clock::now();
+        ASTNode *materialized = parser.getBuilder().getAST().materialize(root);
+        lower(materialized);
+        best = std::min(best, since(begin));
+        delete materialized;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 20000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string src = bench::generateProgram(numFunctions);
+    std::vector<Token> tokens = Scanner(src).scanTokens();
+
+    Timing pointer = timePointer(tokens, rounds);
+    Timing flat = timeFlat(tokens, rounds);
+    double materialized = timeMaterialized(tokens, rounds);
+
+    std::cout << "tokens:   " << tokens.size() << "\n";
+    std::cout << "pointer:  parse " << pointer.parse * 1e3 << " ms, lower "
+              << pointer.lower * 1e3 << " ms, teardown "
+              << pointer.teardown * 1e3 << " ms\n";
+    std::cout << "flat:     parse " << flat.parse * 1e3 << " ms, lower "
+              << flat.lower * 1e3 << " ms, teardown " << flat.teardown * 1e3
+              << " ms\n";
+    std::cout << "materialize and lower: " << materialized * 1e3 << " ms\n";
+    std::cout << "(the pointer parse includes linking AST callees, which "
+                 "the flat AST never needs)\n";
+    return 0;
+}
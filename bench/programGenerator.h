@@ -0,0 +1,72 @@
+#ifndef BENCH_PROGRAMGENERATOR_H
+#define BENCH_PROGRAMGENERATOR_H
+
+#include <string>
+
+namespace fdlang::bench {
+
+/**
+ * @brief A well-formed fdlang program with `numFunctions' functions, each
+ * calling the previous one, for feeding the frontend large inputs
+ */
+inline std::string generateProgram(size_t numFunctions) {
+    std::string src;
+    for (size_t i = 0; i < numFunctions; i++) {
+        std::string name = "function_" + std::to_string(i);
+        src += "function " + name + "(counter_value, upper_bound) {\n";
+        src += "    counter_value = input();\n";
+        src += "    while (counter_value <= 200) {\n";
+        src += "        if (counter_value == 42) {\n";
+        src += "            temporary_result = counter_value + 128;\n";
+        src += "        } else {\n";
+        src += "            temporary_result = counter_value - 17;\n";
+        src += "            nop;\n";
+        src += "        }\n";
+        src += "        counter_value = counter_value + 1;\n";
+        src += "    }\n";
+        if (i > 0)
+            src += "    call function_" + std::to_string(i - 1) +
+                   "(counter_value, 255);\n";
+        src += "    check_interval(counter_value, 0, 255);\n";
+        src += "}\n\n";
+    }
+    src += "function main() {\n    call function_" +
+           std::to_string(numFunctions - 1) + "(0, 200);\n}\n";
+    return src;
+}
+
+/**
+ * @brief A well-formed fdlang program with `numFunctions' functions whose
+ * bodies nest `depth' levels of alternating while and if statements, for
+ * exercising AST traversals
+ */
+inline std::string generateNestedProgram(size_t numFunctions, size_t depth) {
+    std::string src;
+    for (size_t i = 0; i < numFunctions; i++) {
+        src += "function nested_" + std::to_string(i) + "(x) {\n";
+        for (size_t level = 0; level < depth; level++) {
+            std::string indent(4 * (level + 1), ' ');
+            src += indent + "x = x + 1;\n";
+            if (level % 2 == 0)
+                src += indent + "while (x < 200) {\n";
+            else
+                src += indent + "if (x == " + std::to_string(level % 256) +
+                       ") {\n";
+        }
+        src += std::string(4 * (depth + 1), ' ') + "nop;\n";
+        for (size_t level = depth; level-- > 0;) {
+            std::string indent(4 * (level + 1), ' ');
+            if (level % 2 == 0)
+                src += indent + "}\n";
+            else
+                src += indent + "} else {\n" + indent + "    nop;\n" +
+                       indent + "}\n";
+        }
+        src += "}\n\n";
+    }
+    return src;
+}
+
+} // namespace fdlang::bench
+
+#endif
@@ -0,0 +1,93 @@
+#include "programGenerator.h"
+
+#include "fdlang/scanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace fdlang;
+
+// Best tokens/sec over `rounds' scans of `src'
+static double tokensPerSecond(const std::string &src, bool vectorized,
+                              int rounds) {
+    double best = 0;
+    for (int i = 0; i < rounds; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        Scanner scanner(src, vectorized);
+        size_t numTokens = scanner.scanTokens().size();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - begin;
+        best = std::max(best, numTokens / elapsed.count());
+    }
+    return best;
+}
+
+// The keyword table the scanner used before keywordType(), kept to time the
+// lookup alone: Scanner(src, false) already uses the perfect hash
+static const std::unordered_map<std::string, TokenType> baselineKeywords = {
+    {"if", TokenType::IF},
+    {"else", TokenType::ELSE},
+    {"while", TokenType::WHILE},
+    {"input", TokenType::CALL_INPUT},
+    {"check_interval", TokenType::CALL_CHECK_INTERVAL},
+    {"nop", TokenType::NOP},
+    {"call", TokenType::CALL},
+    {"function", TokenType::FUNCTION}};
+
+// Best lookups/sec over `rounds' passes of `words', through the baseline
+// map when `baseline' is set, and Scanner::keywordType otherwise
+static double lookupsPerSecond(const std::vector<std::string_view> &words,
+                               bool baseline, int rounds) {
+    double best = 0;
+    size_t found = 0;
+    for (int i = 0; i < rounds; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (std::string_view word : words) {
+            if (baseline)
+                found += baselineKeywords.count(std::string(word));
+            else
+                found += Scanner::keywordType(word).has_value();
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - begin;
+        best = std::max(best, words.size() / elapsed.count());
+    }
+    // keep the lookups from being optimized away
+    if (found == 0)
+        std::cerr << "no keywords\n";
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 20000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string src = bench::generateProgram(numFunctions);
+
+    double scalar = tokensPerSecond(src, false, rounds);
+    double vectorized = tokensPerSecond(src, true, rounds);
+
+    std::cout << "source size: " << src.size() << " bytes\n";
+    std::cout << "scalar:     " << (size_t)scalar << " tokens/sec\n";
+    std::cout << "vectorized: " << (size_t)vectorized << " tokens/sec\n";
+    std::cout << "speedup:    " << vectorized / scalar << "x\n";
+
+    // every identifier and keyword, as the scanner looks them up
+    std::vector<std::string_view> words;
+    for (const Token &token : Scanner(src).scanTokens())
+        if (token.type == TokenType::IDENTIFIER ||
+            Scanner::keywordType(token.lexeme))
+            words.push_back(token.lexeme);
+    double map = lookupsPerSecond(words, true, rounds);
+    double hash = lookupsPerSecond(words, false, rounds);
+    std::cout << "keyword lookup, unordered_map: " << (size_t)map
+              << " lookups/sec\n";
+    std::cout << "keyword lookup, perfect hash:  " << (size_t)hash
+              << " lookups/sec\n";
+    std::cout << "speedup:    " << hash / map << "x\n";
+    return 0;
+}
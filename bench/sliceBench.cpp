@@ -0,0 +1,86 @@
+#include "fdlang/scanner.h"
+
+#include "analysis/relationalNumericalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/passManager.h"
+#include "IR/slicingPass.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// a loop over `numVars' variables of which only one is checked, like
+// generated code where most values never reach a check
+static std::string generateProgram(size_t numVars, size_t numLoops) {
+    auto var = [](size_t i) { return "v" + std::to_string(i); };
+    std::string src = "function main() {\n    x = 0;\n";
+    for (size_t i = 0; i < numVars; i++)
+        src += "    " + var(i) + " = input();\n";
+    for (size_t loop = 0; loop < numLoops; loop++) {
+        src += "    i = 0;\n    while (i < 20) {\n";
+        for (size_t i = 0; i < numVars; i++)
+            src += "        " + var(i) + " = " + var((i + loop + 1) % numVars) +
+                   " + 1;\n";
+        src += "        x = x + 1;\n        i = i + 1;\n    }\n";
+    }
+    src += "    check_interval(x, 0, 255);\n}\n";
+    return src;
+}
+
+static double timeZones(const IR::Functions &funcs, std::string &result) {
+    auto begin = Clock::now();
+    analysis::RelationalNumericalAnalysis analysis(funcs);
+    analysis.run();
+    double time = since(begin);
+    std::stringstream out;
+    analysis.dumpResult(out);
+    result = out.str();
+    return time;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numVars = argc > 1 ? std::atol(argv[1]) : 60;
+    size_t numLoops = argc > 2 ? std::atol(argv[2]) : 4;
+    std::string src = generateProgram(numVars, numLoops);
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    if (scanner.hadError() || parser.hadError())
+        return 1;
+    IR::Functions funcs = parser.getBuilder().getFunctions();
+    size_t instsBefore = funcs[0]->getInsts().size();
+    size_t varsBefore = funcs[0]->getVars().size();
+    std::string before, after;
+    double zoneBefore = timeZones(funcs, before);
+
+    auto begin = Clock::now();
+    IR::PassManager manager;
+    manager.addPass(std::make_unique<IR::BackwardSlicing>());
+    manager.run(funcs);
+    double sliceTime = since(begin);
+    double zoneAfter = timeZones(funcs, after);
+
+    std::cout << "instructions:  " << instsBefore << " -> "
+              << funcs[0]->getInsts().size() << "\n";
+    std::cout << "variables:     " << varsBefore << " -> "
+              << funcs[0]->getVars().size() << "\n";
+    std::cout << "slicing:       " << sliceTime * 1e3 << " ms\n";
+    std::cout << "zone analysis: " << zoneBefore * 1e3 << " ms -> "
+              << zoneAfter * 1e3 << " ms\n";
+    std::cout << "same results:  " << (before == after ? "yes" : "no")
+              << "\n";
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "fdlang/scanner.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/SSAForm.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// a function over `numVars' variables made of `numBlocks' if statements,
+// each branch a straight run of `run' assignments
+static std::string generateWideProgram(size_t numVars, size_t numBlocks,
+                                       size_t run) {
+    auto var = [](size_t i) { return "v" + std::to_string(i); };
+    std::string src = "function main() {\n";
+    for (size_t i = 0; i < numVars; i++)
+        src += "    " + var(i) + " = input();\n";
+    size_t next = 0;
+    for (size_t block = 0; block < numBlocks; block++) {
+        src += "    if (" + var(block % numVars) + " < 100) {\n";
+        for (size_t i = 0; i < run; i++, next++)
+            src += "        " + var(next % numVars) + " = " +
+                   var((next * 7 + 3) % numVars) + " + 1;\n";
+        src += "    } else {\n";
+        for (size_t i = 0; i < run; i++, next++)
+            src += "        " + var(next % numVars) + " = " +
+                   var((next * 5 + 1) % numVars) + " - 1;\n";
+        src += "    }\n";
+    }
+    src += "    check_interval(v0, 0, 255);\n}\n";
+    return src;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numVars = argc > 1 ? std::atol(argv[1]) : 1000;
+    size_t numBlocks = argc > 2 ? std::atol(argv[2]) : 200;
+    size_t run = argc > 3 ? std::atol(argv[3]) : 50;
+    std::string src = generateWideProgram(numVars, numBlocks, run);
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    IR::Function *function = parser.getBuilder().getFunctions()[0];
+    size_t numInsts = function->getInsts().size();
+
+    auto begin = Clock::now();
+    IR::SSAForm ssa(function);
+    double buildTime = since(begin);
+
+    size_t edges = 0;
+    for (uint32_t version = 0; version < ssa.numVersions(); version++)
+        edges += ssa.getUses(version).size();
+
+    // a dense analysis keeps one fact per variable at every instruction,
+    // a sparse one a fact per version sent along each def-use edge
+    std::cout << "instructions:     " << numInsts << "\n";
+    std::cout << "variables:        " << function->getVars().size() - 1
+              << "\n";
+    std::cout << "SSA build:        " << buildTime * 1e3 << " ms\n";
+    std::cout << "phis:             " << ssa.numPhis() << "\n";
+    std::cout << "dense facts:      " << numInsts * numVars << "\n";
+    std::cout << "versions + edges: " << ssa.numVersions() + edges << " ("
+              << double(numInsts * numVars) / (ssa.numVersions() + edges)
+              << "x fewer)\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "programGenerator.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/ASTVisitor.h"
+#include "fdlang/ASTWalker.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// the same pass written against both traversal facilities: count the nodes
+// and sum the lines of the assigned variables
+class VirtualCounter : public ASTVisitor {
+public:
+    size_t nodes = 0, lines = 0;
+
+    void visit(Stmts *node) override {
+        nodes++;
+        for (ASTNode *child : node->children)
+            child->accept(this);
+    }
+    void visit(Cond *node) override { nodes++; }
+    void visit(UnaryAssignStmt *node) override {
+        nodes++;
+        lines += node->variable.line;
+    }
+    void visit(BinaryAssignStmt *node) override {
+        nodes++;
+        lines += node->variable.line;
+    }
+    void visit(IfStmt *node) override {
+        nodes++;
+        node->cond->accept(this);
+        node->trueBody->accept(this);
+        node->falseBody->accept(this);
+    }
+    void visit(WhileStmt *node) override {
+        nodes++;
+        node->cond->accept(this);
+        node->body->accept(this);
+    }
+    void visit(CheckStmt *node) override { nodes++; }
+    void visit(NopStmt *node) override { nodes++; }
+    void visit(CallStmt *node) override { nodes++; }
+    void visit(FunctionNodes *node) override {
+        nodes++;
+        for (ASTNode *child : node->children)
+            child->accept(this);
+    }
+    void visit(FunctionNode *node) override {
+        nodes++;
+        node->body->accept(this);
+    }
+};
+
+class StaticCounter : public ASTWalker<StaticCounter> {
+public:
+    size_t nodes = 0, lines = 0;
+
+    template <typename Node> void visit(Node *node) {
+        nodes++;
+        ASTWalker<StaticCounter>::visit(node);
+    }
+    void visit(UnaryAssignStmt *node) {
+        nodes++;
+        lines += node->variable.line;
+    }
+    void visit(BinaryAssignStmt *node) {
+        nodes++;
+        lines += node->variable.line;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    size_t numFunctions = argc > 1 ? std::atol(argv[1]) : 200;
+    size_t depth = argc > 2 ? std::atol(argv[2]) : 200;
+    size_t rounds = argc > 3 ? std::atol(argv[3]) : 50;
+    std::string src = bench::generateNestedProgram(numFunctions, depth);
+
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+
+    VirtualCounter virtualCounter;
+    auto begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++)
+        root->accept(&virtualCounter);
+    double virtualTime = since(begin) / rounds;
+
+    StaticCounter staticCounter;
+    begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++)
+        staticCounter.walk(root);
+    double staticTime = since(begin) / rounds;
+
+    begin = Clock::now();
+    for (size_t i = 0; i < rounds; i++) {
+        Sema sema(root);
+        sema.check();
+    }
+    double semaTime = since(begin) / rounds;
+
+    if (virtualCounter.nodes != staticCounter.nodes ||
+        virtualCounter.lines != staticCounter.lines) {
+        std::cerr << "traversals disagree\n";
+        return 1;
+    }
+
+    std::cout << "nodes:          " << virtualCounter.nodes / rounds << "\n";
+    std::cout << "ASTVisitor:     " << virtualTime * 1e3 << " ms\n";
+    std::cout << "ASTWalker:      " << staticTime * 1e3 << " ms ("
+              << virtualTime / staticTime << "x)\n";
+    std::cout << "Sema (walker):  " << semaTime * 1e3 << " ms\n";
+    delete root;
+    return 0;
+}
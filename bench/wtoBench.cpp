@@ -0,0 +1,82 @@
+#include "fdlang/scanner.h"
+
+#include "analysis/intervalAnalysis.h"
+#include "analysis/relationalNumericalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// `numNests' nests of `depth' counting while loops one after another, with
+// straight-line code around each inner loop that FIFO keeps revisiting
+static std::string generateNests(size_t numNests, size_t depth) {
+    auto var = [](size_t level) { return "l" + std::to_string(level); };
+    std::string src = "function main() {\n    x = 0;\n    y = 0;\n";
+    for (size_t nest = 0; nest < numNests; nest++) {
+        for (size_t level = 0; level < depth; level++) {
+            std::string indent(4 * (level + 1), ' ');
+            src += indent + var(level) + " = 0;\n";
+            src += indent + "while (" + var(level) + " < " +
+                   std::to_string(10 * (level + 1)) + ") {\n";
+            src += indent + "    y = x + " + std::to_string(level) + ";\n";
+        }
+        std::string indent(4 * (depth + 1), ' ');
+        src += indent + "x = x + 1;\n";
+        for (size_t level = depth; level-- > 0;) {
+            std::string indent(4 * (level + 1), ' ');
+            src += indent + "    " + var(level) + " = " + var(level) +
+                   " + 1;\n";
+            src += indent + "}\n";
+        }
+        src += "    check_interval(" + var(0) + ", 10, 10);\n";
+    }
+    src += "}\n";
+    return src;
+}
+
+template <typename Analysis>
+static void measure(const char *name, const IR::Functions &funcs) {
+    for (IterationStrategy strategy :
+         {IterationStrategy::FIFO, IterationStrategy::WTO}) {
+        auto begin = Clock::now();
+        Analysis analysis(funcs);
+        analysis.setIterationStrategy(strategy);
+        analysis.run();
+        double time = since(begin);
+        std::cout << "  " << name << ", "
+                  << (strategy == IterationStrategy::FIFO ? "FIFO" : "WTO ")
+                  << ": " << analysis.getIterations() << " transfers, "
+                  << time * 1e3 << " ms\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t numNests = argc > 1 ? std::atol(argv[1]) : 20;
+    size_t depth = argc > 2 ? std::atol(argv[2]) : 4;
+    std::string src = generateNests(numNests, depth);
+
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    if (scanner.hadError() || parser.hadError())
+        return 1;
+    const IR::Functions &funcs = parser.getBuilder().getFunctions();
+    std::cout << numNests << " nests of depth " << depth << ", "
+              << funcs[0]->getInsts().size() << " instructions\n";
+    measure<IntervalAnalysis>("interval analysis", funcs);
+    measure<RelationalNumericalAnalysis>("zone analysis", funcs);
+    return 0;
+}
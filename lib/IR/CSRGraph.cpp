@@ -0,0 +1,53 @@
+#include "CSRGraph.h"
+
+using namespace fdlang::IR;
+
+// stable counting sort of `edges' by `key', into offsets and targets
+template <typename Key, typename Target>
+static void layOut(size_t numNodes,
+                   const std::vector<std::pair<NodeId, NodeId>> &edges,
+                   Key key, Target target, std::vector<uint32_t> &offsets,
+                   std::vector<NodeId> &targets) {
+    offsets.assign(numNodes + 1, 0);
+    for (const auto &edge : edges)
+        offsets[key(edge) + 1]++;
+    for (size_t i = 0; i < numNodes; i++)
+        offsets[i + 1] += offsets[i];
+
+    targets.resize(edges.size());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (const auto &edge : edges)
+        targets[next[key(edge)]++] = target(edge);
+}
+
+CSRGraph CSRGraph::Builder::build() const {
+    CSRGraph graph;
+    graph.numNodes = numNodes;
+    auto from = [](const std::pair<NodeId, NodeId> &edge) {
+        return edge.first;
+    };
+    auto to = [](const std::pair<NodeId, NodeId> &edge) {
+        return edge.second;
+    };
+    layOut(numNodes, edges, from, to, graph.succOffsets, graph.succEdges);
+    layOut(numNodes, edges, to, from, graph.predOffsets, graph.predEdges);
+    return graph;
+}
+
+CSRGraph CSRGraph::fromInsts(Function *function) {
+    Insts &insts = function->getInsts();
+    Builder builder(insts.size());
+    builder.reserve(insts.size() + insts.size() / 2);
+    for (size_t i = 0; i < insts.size(); i++)
+        for (Inst *successor : insts[i]->getSuccessors())
+            builder.addEdge(i, function->getIndex(successor->getLabel()));
+    return builder.build();
+}
+
+CSRGraph CSRGraph::fromBlocks(const BlockGraph &blocks) {
+    Builder builder(blocks.size());
+    for (size_t id = 0; id < blocks.size(); id++)
+        for (BasicBlock *successor : blocks.getBlock(id)->getSuccessors())
+            builder.addEdge(id, successor->getId());
+    return builder.build();
+}
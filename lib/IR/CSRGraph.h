@@ -0,0 +1,104 @@
+#ifndef IR_CSRGRAPH_H
+#define IR_CSRGRAPH_H
+
+#include "IR.h"
+#include "basicBlock.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace fdlang::IR {
+
+using NodeId = uint32_t;
+
+/**
+ * Immutable directed graph over the nodes 0 .. size() - 1, stored in
+ * compressed sparse row form: the successors of every node are one slice
+ * of a single edge array, and likewise the predecessors. Reading a node's
+ * neighbours needs no hashing and no pointer chasing.
+ *
+ * Each node's successors keep the order their edges were added in, so an
+ * IfInst's false branch comes first and its taken branch second.
+ */
+class CSRGraph {
+public:
+    /**
+     * A node's neighbours, a slice of an edge array
+     */
+    class NodeRange {
+    private:
+        const NodeId *first, *last;
+
+    public:
+        NodeRange(const NodeId *first, const NodeId *last)
+            : first(first), last(last) {}
+
+        const NodeId *begin() const { return first; }
+        const NodeId *end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        NodeId operator[](size_t i) const { return first[i]; }
+    };
+
+    /**
+     * Collects the edges of a graph with a known number of nodes and lays
+     * them out with one counting sort per direction
+     */
+    class Builder {
+    private:
+        size_t numNodes;
+        std::vector<std::pair<NodeId, NodeId>> edges;
+
+    public:
+        Builder(size_t numNodes) : numNodes(numNodes) {}
+
+        void reserve(size_t numEdges) { edges.reserve(numEdges); }
+
+        void addEdge(NodeId from, NodeId to) {
+            assert(from < numNodes && to < numNodes);
+            edges.emplace_back(from, to);
+        }
+
+        CSRGraph build() const;
+    };
+
+    CSRGraph() = default;
+
+    /**
+     * @brief The instruction-level graph of a linked function. Node i is
+     * getInsts()[i], see Function::getIndex().
+     */
+    static CSRGraph fromInsts(Function *function);
+
+    /**
+     * @brief The block-level graph of `blocks', node i is block i
+     */
+    static CSRGraph fromBlocks(const BlockGraph &blocks);
+
+    size_t size() const { return numNodes; }
+
+    size_t numEdges() const { return succEdges.size(); }
+
+    NodeRange successors(NodeId node) const {
+        assert(node < numNodes);
+        return NodeRange(succEdges.data() + succOffsets[node],
+                         succEdges.data() + succOffsets[node + 1]);
+    }
+
+    NodeRange predecessors(NodeId node) const {
+        assert(node < numNodes);
+        return NodeRange(predEdges.data() + predOffsets[node],
+                         predEdges.data() + predOffsets[node + 1]);
+    }
+
+private:
+    size_t numNodes = 0;
+    // the successors of node n are succEdges[succOffsets[n], succOffsets[n+1])
+    std::vector<uint32_t> succOffsets, predOffsets;
+    std::vector<NodeId> succEdges, predEdges;
+};
+
+} // namespace fdlang::IR
+
+#endif
@@ -1,4 +1,6 @@
 #include "IR.h"
+#include "controlFlowInfo.h"
+
 #include <string>
 #include <vector>
 
@@ -22,6 +24,31 @@ std::string fdlang::IR::getCmpOperatorSpelling(CmpOperator op) {
     return "UNKNOWN";
 }
 
+CmpOperator fdlang::IR::getCmpOperator(TokenType type) {
+    switch (type) {
+    case TokenType::EQUAL_EQUAL:
+        return CmpOperator::EQ;
+    case TokenType::GREATER_EQUAL:
+        return CmpOperator::GEQ;
+    case TokenType::GREATER:
+        return CmpOperator::GT;
+    case TokenType::LESS_EQUAL:
+        return CmpOperator::LEQ;
+    case TokenType::LESS:
+        return CmpOperator::LT;
+    default:
+        assert(false && "Unknown Operator");
+    }
+    return CmpOperator::EQ;
+}
+
+VarId VarTable::lookup(SymbolId symbol) const {
+    for (VarId var = ZeroVar + 1; var < symbols.size(); var++)
+        if (symbols[var] == symbol)
+            return var;
+    return ZeroVar;
+}
+
 static std::string labelPrefix(size_t label, size_t size = 3) {
     std::string ret = "L" + std::to_string(label);
     while (ret.size() < size)
@@ -102,7 +129,7 @@ void LabelInst::dump(std::ostream &out) const {
 void CallInst::dump(std::ostream &out) const {
     out << labelPrefix(getLabel());
     out << "call ";
-    out << calleeName << "(";
+    out << symbolName(calleeName) << "(";
     for (int i = 0; i < args.size(); i++) {
         if (i == args.size() - 1) {
             args[i]->dump(out);
@@ -114,27 +141,92 @@ void CallInst::dump(std::ostream &out) const {
     }
 }
 
+// operand0 = phi(incoming...);
+void PhiInst::dump(std::ostream &out) const {
+    out << labelPrefix(getLabel());
+    getOperand(0)->dump(out);
+    out << " = phi(";
+    for (size_t i = 0; i < incoming.size(); i++) {
+        if (i > 0)
+            out << ", ";
+        incoming[i]->dump(out);
+    }
+    out << ");";
+}
+
 void CallInst::setCallee(Function *calleeFunction) { callee = calleeFunction; }
 Function *CallInst::getCallee() { return callee; }
-std::string CallInst::getCalleeName() { return calleeName; }
-std::vector<Value *> CallInst::getArgs() { return args; }
+fdlang::SymbolId CallInst::getCalleeName() { return calleeName; }
+
+Function::Function(SymbolId funcName, std::vector<Value *> args,
+                   Insts insts, VarTable vars)
+    : funcName(funcName), args(args), insts(insts), vars(std::move(vars)) {
+    isRootFunc = true;
+    endFunctionLable = new LabelInst();
+}
+
+Function::~Function() { delete endFunctionLable; }
+
+void Function::setInsts(Insts instructions) {
+    insts = std::move(instructions);
+    controlFlow.reset();
+}
+
+ControlFlowInfo &Function::getControlFlow() {
+    if (!controlFlow)
+        controlFlow = std::make_unique<ControlFlowInfo>(this);
+    return *controlFlow;
+}
 
 bool Function::isArg(Value *value) {
-    auto val = value->getAsVariable();
+    SymbolId val = value->getAsVariable();
     for (auto arg : args) {
-        auto argVal = arg->getAsVariable();
-        if (val == argVal)
+        if (arg->getAsVariable() == val)
             return true;
     }
     return false;
 }
 
-std::vector<Value *> Function::getArgs() { return args; }
+void Function::linkPredecessors() {
+    controlFlow.reset();
+    for (Inst *inst : insts)
+        inst->numPredecessors = 0;
+    for (Inst *inst : insts)
+        for (Inst *successor : inst->getSuccessors())
+            successor->numPredecessors++;
+
+    size_t offset = 0;
+    for (Inst *inst : insts)
+        offset += inst->numPredecessors;
+    predecessors.assign(offset, nullptr);
+    offset = 0;
+    for (Inst *inst : insts) {
+        inst->predecessors = predecessors.data() + offset;
+        offset += inst->numPredecessors;
+        inst->numPredecessors = 0;
+    }
+
+    auto addEdge = [](Inst *from, Inst *to) {
+        to->predecessors[to->numPredecessors++] = from;
+    };
+    auto fallsThrough = [&](size_t i) {
+        return i + 1 < insts.size() && insts[i]->type != InstType::GotoInst;
+    };
+    for (size_t i = 0; i < insts.size(); i++) {
+        if (fallsThrough(i)) {
+            assert(insts[i]->successors[0] == insts[i + 1]);
+            addEdge(insts[i], insts[i + 1]);
+        }
+    }
+    for (size_t i = 0; i < insts.size(); i++)
+        for (size_t k = fallsThrough(i); k < insts[i]->numSuccessors; k++)
+            addEdge(insts[i], insts[i]->successors[k]);
+}
 
 void Function::dump(std::ostream &out) const {
     out << std::unitbuf;
     out << labelPrefix(getBeginLabel());
-    out << "function " << funcName << "(";
+    out << "function " << symbolName(funcName) << "(";
     if (args.empty()) {
         out << ")" << "{" << std::endl;
     }
@@ -4,17 +4,21 @@
 #include "fdlang/AST.h"
 #include "fdlang/token.h"
 
-#include <any>
 #include <assert.h>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace fdlang::IR {
 
-enum class ValueType { Number, Variable };
+enum class ValueType : unsigned char { Number, Variable };
 
 /**
  * EQ  =
@@ -34,76 +38,267 @@ enum class InstType {
     IfInst,
     GotoInst,
     LabelInst,
-    CallInst
+    CallInst,
+    PhiInst
 };
 
 std::string getCmpOperatorSpelling(CmpOperator op);
 
+// the comparison of a conditional operator token
+CmpOperator getCmpOperator(TokenType type);
+
+// Position of a variable in its function's VarTable
+using VarId = uint32_t;
+
+// The distinguished zero variable, first in every VarTable
+constexpr VarId ZeroVar = 0;
+
+/**
+ * The variables of a function, numbered densely from 1 in the order the
+ * builders first meet them: body variables in source order, then arguments
+ * the body never uses. ZeroVar stands for the constant 0, so analyses can
+ * index their states by VarId and keep constraints against 0 in slot 0.
+ */
+class VarTable {
+private:
+    std::vector<SymbolId> symbols = {EmptySymbol};
+
+public:
+    /**
+     * @brief Number of variables, counting the zero variable
+     */
+    size_t size() const { return symbols.size(); }
+
+    SymbolId getSymbol(VarId var) const {
+        assert(var < size());
+        return symbols[var];
+    }
+
+    std::string_view getName(VarId var) const {
+        return symbolName(getSymbol(var));
+    }
+
+    /**
+     * @brief Number `symbol' next, it must not be in the table yet
+     */
+    VarId add(SymbolId symbol) {
+        symbols.push_back(symbol);
+        return symbols.size() - 1;
+    }
+
+    /**
+     * @brief The number of `symbol', ZeroVar if the function has no such
+     * variable. Linear in the number of variables.
+     */
+    VarId lookup(SymbolId symbol) const;
+};
+
+// A number or a variable, as a tag plus an 8-byte payload. A variable also
+// carries its VarId in the function it belongs to, and in SSA form the
+// number of the SSA name it stands for.
 class Value {
+public:
+    static constexpr uint32_t NoVersion = UINT32_MAX;
+
 private:
     ValueType type;
-    std::any value;
+    VarId var = ZeroVar;
+    uint32_t version = NoVersion;
+    union {
+        long long number;
+        SymbolId variable;
+    };
+
+    Value() = default;
 
 public:
-    Value(const Token &token) {
+    Value(const Token &token, VarId var = ZeroVar) : var(var) {
         if (token.type == TokenType::IDENTIFIER) {
-            value = token.lexeme;
+            variable = token.getLiteralAsSymbol();
             type = ValueType::Variable;
         } else if (token.type == TokenType::NUMBER) {
-            value = token.getLiteralAsNumber();
+            number = token.getLiteralAsNumber();
             type = ValueType::Number;
         } else {
-            assert(false && "Value must be long long integer or std::string!");
+            assert(false && "Value must be long long integer or SymbolId!");
         }
     }
 
-    bool isNumber() { return type == ValueType::Number; }
+    static Value ofNumber(long long number) {
+        Value ret;
+        ret.type = ValueType::Number;
+        ret.number = number;
+        return ret;
+    }
+
+    static Value ofVariable(SymbolId symbol, VarId var) {
+        Value ret;
+        ret.type = ValueType::Variable;
+        ret.var = var;
+        ret.variable = symbol;
+        return ret;
+    }
+
+    bool isNumber() const { return type == ValueType::Number; }
 
-    bool isVariable() { return type == ValueType::Variable; };
+    bool isVariable() const { return type == ValueType::Variable; };
 
-    long long getAsNumber() {
+    long long getAsNumber() const {
         assert(isNumber());
-        return std::any_cast<long long>(value);
+        return number;
     }
 
-    std::string getAsVariable() {
+    SymbolId getAsVariable() const {
         assert(isVariable());
-        return std::any_cast<std::string>(value);
+        return variable;
     }
 
-    void dump(std::ostream &out, bool showType = false) {
+    VarId getVarId() const {
+        assert(isVariable());
+        return var;
+    }
+
+    /**
+     * @brief Whether this is an SSA name made by SSAForm
+     */
+    bool isVersioned() const { return version != NoVersion; }
+
+    uint32_t getVersion() const {
+        assert(isVersioned());
+        return version;
+    }
+
+    /**
+     * @brief A copy of this variable standing for SSA name `version'
+     */
+    Value withVersion(uint32_t version) const {
+        assert(isVariable());
+        Value ret = *this;
+        ret.version = version;
+        return ret;
+    }
+
+    std::string_view getVariableName() const {
+        return symbolName(getAsVariable());
+    }
+
+    void dump(std::ostream &out, bool showType = false) const {
         if (showType) {
             if (isNumber())
                 out << "Number(" << getAsNumber() << ")";
             else if (isVariable())
-                out << "Var(" << getAsVariable() << ")";
+                out << "Var(" << getVariableName() << ")";
         } else {
             if (isNumber())
                 out << getAsNumber();
             else if (isVariable())
-                out << getAsVariable();
+                out << getVariableName();
         }
+        if (isVersioned())
+            out << "." << version;
     }
 };
+static_assert(std::is_trivially_copyable_v<Value>);
+
+// A view of consecutive Value pointers
+class ValueRange {
+    // the owners of a range may replace its values
+    friend class CallInst;
+    friend class PhiInst;
+
+private:
+    Value **first = nullptr;
+    Value **last = nullptr;
+
+public:
+    ValueRange() = default;
+    ValueRange(Value **first, size_t size)
+        : first(first), last(first + size) {}
+
+    Value *const *begin() const { return first; }
+    Value *const *end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+
+    Value *operator[](size_t i) const {
+        assert(i < size());
+        return first[i];
+    }
+};
+
+class Inst;
+
+// A view of consecutive Inst pointers
+class InstRange {
+private:
+    Inst *const *first = nullptr;
+    Inst *const *last = nullptr;
+
+public:
+    InstRange() = default;
+    InstRange(Inst *const *first, size_t size)
+        : first(first), last(first + size) {}
+
+    Inst *const *begin() const { return first; }
+    Inst *const *end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+
+    Inst *operator[](size_t i) const {
+        assert(i < size());
+        return first[i];
+    }
+};
+
 class Function;
 class Inst {
     friend class Function;
+    friend class IRCache;
+    friend class SSAForm;
+
+public:
+    static constexpr size_t MaxOperands = 3;
+    static constexpr size_t MaxSuccessors = 2;
 
 protected:
     InstType type;
+    unsigned char numOperands = 0;
+    unsigned char numSuccessors = 0;
+    uint32_t numPredecessors = 0;
     size_t label;
-    std::vector<Value *> operands;
-    std::vector<Inst *> successors, predecessors;
+    // values are shared, they belong to the IRArena like the instruction
+    Value *operands[MaxOperands] = {};
+    // the fall-through successor first, if any, then the jump target
+    Inst *successors[MaxSuccessors] = {};
+    // a run of the parent Function's predecessor array
+    Inst **predecessors = nullptr;
     Function *func;
-    Inst(const std::vector<Value *> &ops = {}) : operands(ops) {}
+
+    Inst(std::initializer_list<Value *> ops = {}) {
+        assert(ops.size() <= MaxOperands);
+        for (Value *op : ops)
+            operands[numOperands++] = op;
+    }
 
     friend class IRBuilder;
 
     void setLabel(size_t l) { label = l; }
 
-    void addSuccessor(Inst *inst) { successors.push_back(inst); }
+    void setOperand(size_t id, Value *value) {
+        assert(id < numOperands);
+        operands[id] = value;
+    }
+
+    void addSuccessor(Inst *inst) {
+        assert(numSuccessors < MaxSuccessors);
+        successors[numSuccessors++] = inst;
+    }
 
-    void addPredecessor(Inst *inst) { predecessors.push_back(inst); }
+    void clearEdges() {
+        numSuccessors = 0;
+        numPredecessors = 0;
+        predecessors = nullptr;
+    }
 
     void setParent(Function *func) { func = func; }
     Function *getParent() { return func; }
@@ -112,29 +307,47 @@ public:
     virtual void dump(std::ostream &out) const = 0;
 
     Value *getOperand(size_t id) const {
-        assert(id < operands.size() &&
+        assert(id < numOperands &&
                "The index cannot exceed the number of operands");
         return operands[id];
     }
 
-    size_t getOperandSize() const { return operands.size(); }
+    size_t getOperandSize() const { return numOperands; }
 
     InstType getInstType() const { return type; };
 
-    size_t getLabel() const { return label; }
+    /**
+     * @brief Whether the inst writes the variable in its operand 0
+     */
+    bool isDef() const {
+        switch (type) {
+        case InstType::AddInst:
+        case InstType::SubInst:
+        case InstType::AssignInst:
+        case InstType::InputInst:
+            return true;
+        default:
+            return false;
+        }
+    }
 
-    const std::vector<Inst *> &getSuccessors() const { return successors; }
+    size_t getLabel() const { return label; }
 
-    const std::vector<Inst *> &getPredecessors() const { return predecessors; }
+    InstRange getSuccessors() const {
+        return InstRange(successors, numSuccessors);
+    }
 
-    virtual ~Inst() {
-        for (Value *v : operands)
-            delete v;
+    InstRange getPredecessors() const {
+        return InstRange(predecessors, numPredecessors);
     }
+
+    virtual ~Inst() = default;
 };
 
 using Insts = std::vector<Inst *>;
 
+class ControlFlowInfo;
+
 // operand0 = operand1 + operand2;
 class AddInst : public Inst {
 public:
@@ -198,7 +411,6 @@ public:
 // if operand0 cmpop operand1 then goto dest;
 class IfInst : public Inst {
 private:
-    std::vector<Value *> operands;
     CmpOperator cmpop;
     Inst *dest;
 
@@ -210,6 +422,8 @@ public:
 
     Inst *getDestInst() const { return dest; }
 
+    void setDestInst(Inst *inst) { dest = inst; }
+
     CmpOperator getCmpOperator() const { return cmpop; }
 
     virtual void dump(std::ostream &out) const override;
@@ -225,6 +439,8 @@ public:
 
     Inst *getDestInst() { return dest; }
 
+    void setDestInst(Inst *inst) { dest = inst; }
+
     virtual void dump(std::ostream &out) const override;
 };
 
@@ -236,25 +452,39 @@ public:
 };
 
 class Function {
+    friend class IRBuilder;
+    friend class IRCache;
+
 public:
-    std::string funcName;
-    std::unordered_map<size_t, Inst *> label2Inst;
+    SymbolId funcName;
 
 private:
     size_t beginLabel, endLabel;
     std::vector<Value *> args;
     Insts insts;
+    // the predecessor lists of insts, one after another
+    std::vector<Inst *> predecessors;
+    VarTable vars;
     bool isRootFunc;
     LabelInst *endFunctionLable;
+    // built by getControlFlow(), dropped when the instructions change
+    std::unique_ptr<ControlFlowInfo> controlFlow;
 
 public:
-    Function(std::string funcName, std::vector<Value *> args, Insts insts)
-        : funcName(funcName), args(args), insts(insts) {
-        isRootFunc = true;
-        endFunctionLable = new LabelInst();
-    }
+    Function(SymbolId funcName, std::vector<Value *> args, Insts insts,
+             VarTable vars);
 
-    ~Function() { delete endFunctionLable; }
+    ~Function();
+
+    Function(const Function &) = delete;
+    Function &operator=(const Function &) = delete;
+
+    /**
+     * @brief Derive every instruction's predecessors from the successors.
+     * An instruction's fall-through predecessor comes before the jumps to
+     * it, which come in instruction order.
+     */
+    void linkPredecessors();
 
     void dump(std::ostream &out) const;
 
@@ -267,26 +497,69 @@ public:
     }
     size_t getEndLabel() const { return endLabel; }
 
-    void setInsts(Insts instructions) { insts = instructions; }
+    void setInsts(Insts instructions);
     Insts &getInsts() { return insts; }
 
+    /**
+     * @brief The dominators, post-dominators and loops of the linked
+     * function, computed when first asked for. setInsts() and linking drop
+     * them, so references into them last only until then.
+     */
+    ControlFlowInfo &getControlFlow();
+
+    /**
+     * @brief The variables of the function, which its variable Values
+     * refer to by VarId
+     */
+    const VarTable &getVars() const { return vars; }
+
+    /**
+     * @brief Renumber the variables, once every instruction reads and
+     * writes Values numbered by `variables'. `arguments' are the old
+     * arguments in the new numbering.
+     */
+    void setVars(VarTable variables, std::vector<Value *> arguments) {
+        vars = std::move(variables);
+        args = std::move(arguments);
+    }
+
+    /**
+     * @brief Position in getInsts() of the instruction labelled `label'.
+     * link() labels a function's instructions consecutively, so this dense
+     * numbering from 0 needs no lookup table.
+     */
+    size_t getIndex(size_t label) const {
+        assert(beginLabel < label && label - beginLabel - 1 < insts.size());
+        return label - beginLabel - 1;
+    }
+
+    Inst *getInstByLabel(size_t label) const { return insts[getIndex(label)]; }
+
     void setRoot(bool isRoot) { isRootFunc = isRoot; }
     bool isRoot() { return isRootFunc; }
 
     bool isArg(Value *value);
-    std::vector<Value *> getArgs();
+    const std::vector<Value *> &getArgs() const { return args; }
 };
 
 using Functions = std::vector<Function *>;
 class CallInst : public Inst {
+    friend class SSAForm;
+
 private:
-    std::vector<Value *> args;
-    Function *callee;
-    std::string calleeName;
+    // stored next to the instruction by IRArena::copyValues
+    ValueRange args;
+    Function *callee = nullptr;
+    SymbolId calleeName;
+
+    void setArg(size_t i, Value *value) {
+        assert(i < args.size());
+        args.first[i] = value;
+    }
 
 public:
-    CallInst(std::string calleeName, std::vector<Value *> args)
-        : calleeName(calleeName), args(args) {
+    CallInst(SymbolId calleeName, ValueRange args)
+        : args(args), calleeName(calleeName) {
         type = InstType::CallInst;
     }
 
@@ -294,8 +567,34 @@ public:
 
     void setCallee(Function *calleeFunction);
     Function *getCallee();
-    std::string getCalleeName();
-    std::vector<Value *> getArgs();
+    SymbolId getCalleeName();
+    ValueRange getArgs() const { return args; }
+};
+
+// operand0 = phi(incoming...);
+// Made by SSAForm for the block starting at its label, with one incoming
+// value per predecessor of the block in BasicBlock::getPredecessors() order
+class PhiInst : public Inst {
+    friend class SSAForm;
+
+private:
+    // stored next to the instruction by IRArena::copyValues
+    ValueRange incoming;
+
+    void setIncoming(size_t i, Value *value) {
+        assert(i < incoming.size());
+        incoming.first[i] = value;
+    }
+
+public:
+    PhiInst(Value *operand0, ValueRange incoming)
+        : Inst({operand0}), incoming(incoming) {
+        type = InstType::PhiInst;
+    }
+
+    ValueRange getIncoming() const { return incoming; }
+
+    virtual void dump(std::ostream &out) const override;
 };
 
 } // namespace fdlang::IR
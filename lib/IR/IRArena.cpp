@@ -0,0 +1,83 @@
+#include "IRArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+void *IRArena::allocate(size_t size, size_t align) {
+    auto address = reinterpret_cast<uintptr_t>(cursor);
+    size_t padding = (align - address % align) % align;
+    if (!cursor || padding + size > size_t(limit - cursor)) {
+        // a new chunk at least as large as all before it, so the number of
+        // chunks grows with the logarithm of the IR size
+        size_t chunkSize = std::max(nextChunkSize, size + align);
+        nextChunkSize = chunkSize * 2;
+        chunks.emplace_back(new char[chunkSize]);
+        cursor = chunks.back().get();
+        limit = cursor + chunkSize;
+        address = reinterpret_cast<uintptr_t>(cursor);
+        padding = (align - address % align) % align;
+    }
+    void *ret = cursor + padding;
+    cursor += padding + size;
+    return ret;
+}
+
+Value *IRArena::newValue(const Token &token, VarId var) {
+    return new (allocate(sizeof(Value), alignof(Value))) Value(token, var);
+}
+
+Value *IRArena::addValue(const Value &value) {
+    return new (allocate(sizeof(Value), alignof(Value))) Value(value);
+}
+
+Value *IRArena::getValue(const Token &token) {
+    if (token.type == TokenType::IDENTIFIER) {
+        SymbolId symbol = token.getLiteralAsSymbol();
+        if (symbol >= variables.size())
+            variables.resize(symbol + 1, nullptr);
+        if (!variables[symbol])
+            variables[symbol] = newValue(token, vars.add(symbol));
+        return variables[symbol];
+    }
+    return getNumber(token.getLiteralAsNumber());
+}
+
+Value *IRArena::getNumber(long long number) {
+    Value *&value = numbers[number];
+    if (!value)
+        value = addValue(Value::ofNumber(number));
+    return value;
+}
+
+VarTable IRArena::takeVars() {
+    // forget only this function's variables, the next one starts afresh
+    for (VarId var = ZeroVar + 1; var < vars.size(); var++)
+        variables[vars.getSymbol(var)] = nullptr;
+    VarTable ret = std::move(vars);
+    vars = VarTable();
+    return ret;
+}
+
+ValueRange IRArena::copyValues(Value *const *values, size_t size) {
+    if (size == 0)
+        return ValueRange();
+    auto copy = static_cast<Value **>(
+        allocate(sizeof(Value *) * size, alignof(Value *)));
+    std::copy(values, values + size, copy);
+    return ValueRange(copy, size);
+}
+
+void IRArena::clear() {
+    for (Inst *inst : insts)
+        inst->~Inst();
+    insts.clear();
+    numbers.clear();
+    variables.clear();
+    vars = VarTable();
+    chunks.clear();
+    cursor = limit = nullptr;
+    nextChunkSize = FirstChunkSize;
+}
@@ -0,0 +1,113 @@
+#ifndef IR_IRARENA_H
+#define IR_IRARENA_H
+
+#include "IR.h"
+
+#include "fdlang/token.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * Owner of the instructions and values of lowered functions.
+ *
+ * Instructions are placed one after another in a few large chunks, which
+ * grow geometrically, so a function's instructions are contiguous in the
+ * order they were created. Values are interned: every occurrence of a
+ * number shares one Value, and so does every occurrence of a variable
+ * within a function, so a Value must never be changed once created.
+ * Everything lives until clear() or the arena's destruction.
+ *
+ * Functions are lowered one at a time. getValue() numbers the variables of
+ * the current function, and takeVars() hands their table over to the
+ * Function and starts the next one.
+ */
+class IRArena {
+private:
+    static constexpr size_t FirstChunkSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char *cursor = nullptr, *limit = nullptr;
+    size_t nextChunkSize = FirstChunkSize;
+    // destroyed by clear(), their edge lists own memory
+    std::vector<Inst *> insts;
+    std::unordered_map<long long, Value *> numbers;
+    // variables of the current function, indexed by SymbolId
+    std::vector<Value *> variables;
+    VarTable vars;
+
+    void *allocate(size_t size, size_t align);
+
+    Value *newValue(const Token &token, VarId var);
+
+public:
+    IRArena() = default;
+
+    IRArena(const IRArena &) = delete;
+    IRArena &operator=(const IRArena &) = delete;
+
+    ~IRArena() { clear(); }
+
+    /**
+     * @brief Construct an instruction of type T in the arena
+     */
+    template <typename T, typename... Args> T *create(Args &&...args) {
+        static_assert(std::is_base_of_v<Inst, T>);
+        T *inst = new (allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+        insts.push_back(inst);
+        return inst;
+    }
+
+    /**
+     * @brief The shared Value of an IDENTIFIER or NUMBER token, a variable
+     * is numbered in the current function on first use
+     */
+    Value *getValue(const Token &token);
+
+    /**
+     * @brief The shared Value of `number'
+     */
+    Value *getNumber(long long number);
+
+    /**
+     * @brief A copy of `value' that is not interned, such as an SSA name
+     */
+    Value *addValue(const Value &value);
+
+    /**
+     * @brief The variables numbered since the last call, for the Function
+     * just lowered. Later variables start a new table.
+     */
+    VarTable takeVars();
+
+    /**
+     * @brief Copy `values' into the arena, for the arguments of a CallInst
+     */
+    ValueRange copyValues(const std::vector<Value *> &values) {
+        return copyValues(values.data(), values.size());
+    }
+
+    ValueRange copyValues(Value *const *values, size_t size);
+
+    /**
+     * @brief Number of instructions created
+     */
+    size_t size() const { return insts.size(); }
+
+    /**
+     * @brief Destroy every instruction and value
+     */
+    void clear();
+};
+
+} // namespace fdlang::IR
+
+#endif
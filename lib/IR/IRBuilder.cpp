@@ -2,50 +2,70 @@
 #include "IR/IR.h"
 #include "fdlang/AST.h"
 #include "fdlang/token.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
 using namespace fdlang;
 using namespace fdlang::IR;
 
-static CmpOperator TokenOpType2CmpOp(TokenType type) {
-    switch (type) {
-    case TokenType::EQUAL_EQUAL:
-        return CmpOperator::EQ;
-    case TokenType::GREATER_EQUAL:
-        return CmpOperator::GEQ;
-    case TokenType::GREATER:
-        return CmpOperator::GT;
-    case TokenType::LESS_EQUAL:
-        return CmpOperator::LEQ;
-    case TokenType::LESS:
-        return CmpOperator::LT;
-    default:
-        assert(false && "Unknown Operator");
-    }
-    return CmpOperator::EQ;
-}
-
-void IRBuilder::addInst(Inst *inst) { IR.emplace_back(inst); }
+void IRBuilder::addInst(Inst *inst) { IR.push_back(inst); }
 void IRBuilder::addFunction(Function *function) {
     functions.emplace_back(function);
 }
 
 Inst *IRBuilder::lastInst() {
     assert(!IR.empty());
-    return IR.back().get();
+    return IR.back();
 }
 
 Functions IRBuilder::build() {
+    Functions ret = lower();
+    link(ret);
+    return ret;
+}
+
+Functions IRBuilder::lower() {
     functions.clear();
     IR.clear();
-    root->accept(this);
+    arena.clear();
+    if (flatRoot.ast)
+        walk(flatRoot);
+    else
+        walk(root);
+
+    Functions ret;
+    for (auto &function : functions)
+        ret.push_back(function.get());
+    return ret;
+}
+
+void IRBuilder::link(const Functions &functions) {
+    // drop any previous linking, so functions can be relinked after others
+    // were added or removed
+    for (Function *function : functions) {
+        function->setRoot(true);
+        for (Inst *inst : function->getInsts()) {
+            inst->clearEdges();
+            if (inst->type == InstType::CallInst)
+                ((CallInst *)inst)->setCallee(nullptr);
+        }
+    }
+
+    // calls resolve through an index by name to the last function of that
+    // name, and every function of a called name stops being a root
+    SymbolId numNames = 0;
+    for (Function *function : functions)
+        numNames = std::max<SymbolId>(numNames, function->funcName + 1);
+    std::vector<Function *> byName(numNames, nullptr);
+    std::vector<bool> called(numNames, false);
+    for (Function *function : functions)
+        byName[function->funcName] = function;
 
-    std::vector<Function *> ret;
     size_t instId = 0;
     for (size_t funcID = 0; funcID < functions.size(); funcID++) {
 
-        Function *function = functions[funcID].get();
+        Function *function = functions[funcID];
         function->setBeginLabel(instId);
         Insts &insts = function->getInsts();
         instId++;
@@ -55,10 +75,8 @@ Functions IRBuilder::build() {
             inst->setLabel(instId);
             if (i + 1 < insts.size() && inst->type != InstType::GotoInst) {
                 inst->addSuccessor(insts[i + 1]);
-                insts[i + 1]->addPredecessor(inst);
                 inst->setParent(function);
             }
-            function->label2Inst[instId] = inst;
             instId++;
         }
         function->setEndLabel(instId);
@@ -66,7 +84,7 @@ Functions IRBuilder::build() {
     }
 
     for (size_t funcID = 0; funcID < functions.size(); funcID++) {
-        Function *function = functions[funcID].get();
+        Function *function = functions[funcID];
         Insts &insts = function->getInsts();
 
         for (int i = 0; i < insts.size(); i++) {
@@ -74,165 +92,237 @@ Functions IRBuilder::build() {
             if (inst->type == InstType::GotoInst) {
                 GotoInst *gotoInst = (GotoInst *)inst;
                 gotoInst->addSuccessor(gotoInst->getDestInst());
-                gotoInst->getDestInst()->addPredecessor(inst);
             }
             if (inst->type == InstType::IfInst) {
                 IfInst *ifInst = (IfInst *)inst;
                 ifInst->addSuccessor(ifInst->getDestInst());
-                ifInst->getDestInst()->addPredecessor(inst);
             }
             if (inst->type == InstType::CallInst) {
                 CallInst *callInst = (CallInst *)inst;
-                for (auto &func : functions) {
-                    if (func->funcName == callInst->getCalleeName()) {
-                        func->setRoot(false);
-                        callInst->setCallee(func.get());
-                    }
+                SymbolId name = callInst->getCalleeName();
+                if (name < numNames && byName[name]) {
+                    callInst->setCallee(byName[name]);
+                    called[name] = true;
                 }
             }
         }
-        ret.push_back(function);
+        function->linkPredecessors();
     }
 
-    return ret;
+    for (Function *function : functions)
+        if (called[function->funcName])
+            function->setRoot(false);
 }
 
 void IRBuilder::visit(Stmts *node) {
     for (auto child : node->children) {
-        child->accept(this);
+        walk(child);
     }
 }
 
 void IRBuilder::visit(Cond *node) {}
 
 void IRBuilder::visit(UnaryAssignStmt *node) {
-    switch (node->operand.type) {
+    lowerUnaryAssign(node->variable, node->operand);
+}
+
+void IRBuilder::visit(BinaryAssignStmt *node) {
+    lowerBinaryAssign(node->variable, node->leftOperand, node->op,
+                      node->rightOperand);
+}
+
+void IRBuilder::visit(IfStmt *node) {
+    Cond *cond = (Cond *)node->cond;
+    lowerIf(cond->leftOperand, cond->op, cond->rightOperand, node->trueBody,
+            node->falseBody);
+}
+
+void IRBuilder::visit(WhileStmt *node) {
+    Cond *cond = (Cond *)node->cond;
+    lowerWhile(cond->leftOperand, cond->op, cond->rightOperand, node->body);
+}
+
+void IRBuilder::visit(CheckStmt *node) {
+    lowerCheck(node->check, node->params);
+}
+
+void IRBuilder::visit(NopStmt *node) {}
+
+void IRBuilder::visit(CallStmt *node) {
+    lowerCall(node->calleeName, node->args);
+}
+
+void IRBuilder::visit(FunctionNodes *node) {
+    for (auto child : node->children) {
+        walk(child);
+    }
+}
+
+void IRBuilder::visit(FunctionNode *node) {
+    lowerFunction(node->funcName, node->args, node->body);
+}
+
+void IRBuilder::visit(const flat::UnaryAssignStmt &node) {
+    lowerUnaryAssign(node.variable, node.operand);
+}
+
+void IRBuilder::visit(const flat::BinaryAssignStmt &node) {
+    lowerBinaryAssign(node.variable, node.leftOperand, node.op,
+                      node.rightOperand);
+}
+
+void IRBuilder::visit(const flat::IfStmt &node) {
+    flat::Cond cond = flat::Cond::of(node.cond);
+    lowerIf(cond.leftOperand, cond.op, cond.rightOperand, node.trueBody,
+            node.falseBody);
+}
+
+void IRBuilder::visit(const flat::WhileStmt &node) {
+    flat::Cond cond = flat::Cond::of(node.cond);
+    lowerWhile(cond.leftOperand, cond.op, cond.rightOperand, node.body);
+}
+
+void IRBuilder::visit(const flat::CheckStmt &node) {
+    lowerCheck(node.check, node.params);
+}
+
+void IRBuilder::visit(const flat::CallStmt &node) {
+    lowerCall(node.calleeName, node.args);
+}
+
+void IRBuilder::visit(const flat::FunctionNode &node) {
+    lowerFunction(node.funcName, node.args, node.body);
+}
+
+void IRBuilder::lowerUnaryAssign(const Token &variable, const Token &operand) {
+    // values in source order, which numbers the variables
+    Value *value = arena.getValue(variable);
+    switch (operand.type) {
     case TokenType::CALL_INPUT:
-        addInst(new InputInst(new Value(node->variable)));
+        addInst(arena.create<InputInst>(value));
         break;
     case TokenType::IDENTIFIER:
     case TokenType::NUMBER:
-        addInst(new AssignInst(new Value(node->variable),
-                               new Value(node->operand)));
+        addInst(arena.create<AssignInst>(value, arena.getValue(operand)));
         break;
     default:
         assert(false);
     }
 }
 
-void IRBuilder::visit(BinaryAssignStmt *node) {
-    switch (node->op.type) {
+void IRBuilder::lowerBinaryAssign(const Token &variable,
+                                  const Token &leftOperand, const Token &op,
+                                  const Token &rightOperand) {
+    // values in source order, which numbers the variables
+    Value *value = arena.getValue(variable);
+    Value *left = arena.getValue(leftOperand);
+    Value *right = arena.getValue(rightOperand);
+    switch (op.type) {
     case TokenType::PLUS:
-        addInst(new AddInst(new Value(node->variable),
-                            new Value(node->leftOperand),
-                            new Value(node->rightOperand)));
+        addInst(arena.create<AddInst>(value, left, right));
         break;
     case TokenType::MINUS:
-        addInst(new SubInst(new Value(node->variable),
-                            new Value(node->leftOperand),
-                            new Value(node->rightOperand)));
+        addInst(arena.create<SubInst>(value, left, right));
         break;
     default:
         assert(false);
     }
 }
 
-void IRBuilder::visit(IfStmt *node) {
-    Cond *cond = (Cond *)node->cond;
+template <typename Body>
+void IRBuilder::lowerIf(const Token &leftOperand, const Token &op,
+                        const Token &rightOperand, Body trueBody,
+                        Body falseBody) {
+    LabelInst *labelTrueBody = arena.create<LabelInst>();
+    LabelInst *labelFalseBody = arena.create<LabelInst>();
+    LabelInst *labelEnd = arena.create<LabelInst>();
 
-    LabelInst *labelTrueBody = new LabelInst();
-    LabelInst *labelFalseBody = new LabelInst();
-    LabelInst *labelEnd = new LabelInst();
+    IfInst *ifInst = arena.create<IfInst>(
+        arena.getValue(leftOperand), getCmpOperator(op.type),
+        arena.getValue(rightOperand), labelTrueBody);
 
-    IfInst *ifInst = new IfInst(new Value(cond->leftOperand),
-                                TokenOpType2CmpOp(cond->op.type),
-                                new Value(cond->rightOperand), labelTrueBody);
-
-    GotoInst *gotoFalseBody = new GotoInst(labelFalseBody);
-    GotoInst *gotoEnd = new GotoInst(labelEnd);
+    GotoInst *gotoFalseBody = arena.create<GotoInst>(labelFalseBody);
+    GotoInst *gotoEnd = arena.create<GotoInst>(labelEnd);
 
     addInst(ifInst);
     addInst(gotoFalseBody);
     addInst(labelTrueBody);
-    node->trueBody->accept(this);
+    walk(trueBody);
     addInst(gotoEnd);
     addInst(labelFalseBody);
-    node->falseBody->accept(this);
+    walk(falseBody);
     addInst(labelEnd);
 }
 
-void IRBuilder::visit(WhileStmt *node) {
-    Cond *cond = (Cond *)node->cond;
+template <typename Body>
+void IRBuilder::lowerWhile(const Token &leftOperand, const Token &op,
+                           const Token &rightOperand, Body body) {
+    LabelInst *labelStart = arena.create<LabelInst>();
+    LabelInst *labelBody = arena.create<LabelInst>();
+    LabelInst *labelEnd = arena.create<LabelInst>();
 
-    LabelInst *labelStart = new LabelInst();
-    LabelInst *labelBody = new LabelInst();
-    LabelInst *labelEnd = new LabelInst();
+    IfInst *ifInst = arena.create<IfInst>(
+        arena.getValue(leftOperand), getCmpOperator(op.type),
+        arena.getValue(rightOperand), labelBody);
 
-    IfInst *ifInst = new IfInst(new Value(cond->leftOperand),
-                                TokenOpType2CmpOp(cond->op.type),
-                                new Value(cond->rightOperand), labelBody);
-
-    GotoInst *gotoStart = new GotoInst(labelStart);
-    GotoInst *gotoEnd = new GotoInst(labelEnd);
+    GotoInst *gotoStart = arena.create<GotoInst>(labelStart);
+    GotoInst *gotoEnd = arena.create<GotoInst>(labelEnd);
 
     addInst(labelStart);
     addInst(ifInst);
     addInst(gotoEnd);
     addInst(labelBody);
-    node->body->accept(this);
+    walk(body);
     addInst(gotoStart);
     addInst(labelEnd);
 }
 
-void IRBuilder::visit(CheckStmt *node) {
-    CheckIntervalInst *checkIntervalInst = new CheckIntervalInst(
-        new Value(node->params[0]), new Value(node->params[1]),
-        new Value(node->params[2]));
-    checkIntervalInst->setLine(node->check.line);
+void IRBuilder::lowerCheck(const Token &check, TokenRange params) {
+    CheckIntervalInst *checkIntervalInst = arena.create<CheckIntervalInst>(
+        arena.getValue(params[0]), arena.getValue(params[1]),
+        arena.getValue(params[2]));
+    checkIntervalInst->setLine(check.line);
     addInst(checkIntervalInst);
 }
 
-void IRBuilder::visit(NopStmt *node) {}
-
-void IRBuilder::visit(CallStmt *node) {
+void IRBuilder::lowerCall(const Token &calleeName, TokenRange args) {
     std::vector<Value *> operands;
-    for (auto param : node->args) {
-        operands.push_back(new Value(param));
+    for (const Token &arg : args) {
+        operands.push_back(arena.getValue(arg));
     }
-    CallInst *callInst = new CallInst(node->calleeName.lexeme, operands);
+    CallInst *callInst = arena.create<CallInst>(
+        calleeName.getLiteralAsSymbol(), arena.copyValues(operands));
     addInst(callInst);
 }
 
-void IRBuilder::visit(FunctionNodes *node) {
-    for (auto child : node->children) {
-        child->accept(this);
-    }
-}
+template <typename Body>
+void IRBuilder::lowerFunction(const Token &funcName, TokenRange args,
+                              Body body) {
 
-void IRBuilder::visit(FunctionNode *node) {
-
-    std::vector<Value *> args;
-    for (auto arg : node->args) {
-        args.push_back(new Value(arg));
-    }
-
-    LabelInst *FunctionStart = new LabelInst();
-    LabelInst *labelBody = new LabelInst();
-    LabelInst *labelEnd = new LabelInst();
-    LabelInst *FunctionEnd = new LabelInst();
+    LabelInst *FunctionStart = arena.create<LabelInst>();
+    LabelInst *labelBody = arena.create<LabelInst>();
+    LabelInst *labelEnd = arena.create<LabelInst>();
+    LabelInst *FunctionEnd = arena.create<LabelInst>();
 
     //addInst(FunctionStart);
     size_t functionStartSize = IR.size();
     addInst(labelBody);
-    node->body->accept(this);
+    walk(body);
     addInst(labelEnd);
     size_t functionEndSize = IR.size();
 
     std::vector<Inst *> insts;
     for (size_t i = functionStartSize; i < functionEndSize; ++i) {
-        insts.push_back(IR[i].get());
+        insts.push_back(IR[i]);
+    }
+
+    // after the body, so variables are numbered as IRLoweringBuilder does
+    std::vector<Value *> argValues;
+    for (const Token &arg : args) {
+        argValues.push_back(arena.getValue(arg));
     }
 
-    Function *function = new Function(node->funcName.lexeme, args, insts);
+    Function *function = new Function(funcName.getLiteralAsSymbol(),
+                                       argValues, insts, arena.takeVars());
     addFunction(function);
-}
\ No newline at end of file
+}
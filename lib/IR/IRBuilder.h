@@ -2,40 +2,100 @@
 #define IR_IRBuilder_H
 
 #include "IR.h"
+#include "IRArena.h"
 
 #include "fdlang/AST.h"
-#include "fdlang/ASTVisitor.h"
+#include "fdlang/ASTWalker.h"
+#include "fdlang/flatAST.h"
+#include "fdlang/flatASTWalker.h"
 
 #include <memory>
 
 namespace fdlang::IR {
 
-class IRBuilder : public ASTVisitor {
+class IRBuilder : public ASTWalker<IRBuilder>,
+                  public FlatASTWalker<IRBuilder> {
 private:
-    ASTNode *root;
-    std::vector<std::unique_ptr<Inst>> IR;
+    friend class ASTWalker<IRBuilder>;
+    friend class FlatASTWalker<IRBuilder>;
+
+    ASTNode *root = nullptr;
+    FlatNodeRef flatRoot;
+    IRArena arena;
+    // the lowered instructions in order, owned by the arena
+    Insts IR;
     std::vector<std::unique_ptr<Function>> functions;
 
     void addInst(Inst *inst);
     void addFunction(Function *function);
     Inst *lastInst();
 
-    virtual void visit(Stmts *node) override;
-    virtual void visit(Cond *node) override;
-    virtual void visit(UnaryAssignStmt *node) override;
-    virtual void visit(BinaryAssignStmt *node) override;
-    virtual void visit(IfStmt *node) override;
-    virtual void visit(WhileStmt *node) override;
-    virtual void visit(CheckStmt *node) override;
-    virtual void visit(NopStmt *node) override;
-    virtual void visit(CallStmt *node) override;
-    virtual void visit(FunctionNodes *node) override;
-    virtual void visit(FunctionNode *node) override;
+    void visit(Stmts *node);
+    void visit(Cond *node);
+    void visit(UnaryAssignStmt *node);
+    void visit(BinaryAssignStmt *node);
+    void visit(IfStmt *node);
+    void visit(WhileStmt *node);
+    void visit(CheckStmt *node);
+    void visit(NopStmt *node);
+    void visit(CallStmt *node);
+    void visit(FunctionNodes *node);
+    void visit(FunctionNode *node);
+
+    using ASTWalker<IRBuilder>::walk;
+    using FlatASTWalker<IRBuilder>::walk;
+    // statement lists walk their children, conditions are lowered by their
+    // if or while
+    using FlatASTWalker<IRBuilder>::visit;
+    void visit(const flat::UnaryAssignStmt &node);
+    void visit(const flat::BinaryAssignStmt &node);
+    void visit(const flat::IfStmt &node);
+    void visit(const flat::WhileStmt &node);
+    void visit(const flat::CheckStmt &node);
+    void visit(const flat::CallStmt &node);
+    void visit(const flat::FunctionNode &node);
+
+    // the lowering shared by both kinds of AST, Body is what walk() takes
+    void lowerUnaryAssign(const Token &variable, const Token &operand);
+    void lowerBinaryAssign(const Token &variable, const Token &leftOperand,
+                           const Token &op, const Token &rightOperand);
+    template <typename Body>
+    void lowerIf(const Token &leftOperand, const Token &op,
+                 const Token &rightOperand, Body trueBody, Body falseBody);
+    template <typename Body>
+    void lowerWhile(const Token &leftOperand, const Token &op,
+                    const Token &rightOperand, Body body);
+    void lowerCheck(const Token &check, TokenRange params);
+    void lowerCall(const Token &calleeName, TokenRange args);
+    template <typename Body>
+    void lowerFunction(const Token &funcName, TokenRange args, Body body);
 
 public:
     IRBuilder(ASTNode *root) : root(root) {}
 
+    /**
+     * @brief Lower the FlatAST below `root' in place
+     */
+    IRBuilder(FlatNodeRef root) : flatRoot(root) {}
+
+    /**
+     * @brief Lower and link the whole program. The functions are owned by
+     * the builder.
+     */
     Functions build();
+
+    /**
+     * @brief Lower every function under the root without labelling or
+     * linking it, so that separately lowered parts can be linked together
+     */
+    Functions lower();
+
+    /**
+     * @brief Assign program-wide labels in order, add the control-flow
+     * edges and resolve callees among `functions', replacing whatever a
+     * previous link() set up
+     */
+    static void link(const Functions &functions);
 };
 
 } // namespace fdlang::IR
@@ -0,0 +1,474 @@
+#include "IRCache.h"
+
+#include "fdlang/symbol.h"
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+namespace {
+
+constexpr char Magic[8] = {'F', 'D', 'L', 'A', 'N', 'G', 'I', 'R'};
+constexpr uint32_t NoIndex = UINT32_MAX;
+constexpr size_t Alignment = 8;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t numSymbols;
+    uint32_t numChars;
+    uint32_t numValues;
+    uint32_t numFunctions;
+    uint32_t numInsts;
+    uint32_t numRefs;
+    uint32_t reserved;
+};
+
+// `length' characters of the name at `offset'
+struct SymbolRecord {
+    uint32_t offset, length;
+};
+
+struct ValueRecord {
+    // the number, or the index of the variable's symbol
+    int64_t payload;
+    uint32_t var;
+    uint32_t isVariable;
+};
+
+// lists are runs of the references
+struct FunctionRecord {
+    uint32_t name;
+    uint32_t firstInst, numInsts;
+    // value indices
+    uint32_t firstArg, numArgs;
+    // symbol indices of variables 1, 2, ...
+    uint32_t firstVar, numVars;
+    uint32_t beginLabel, endLabel;
+    uint32_t isRoot;
+};
+
+struct InstRecord {
+    uint8_t type;
+    uint8_t cmpop;
+    uint8_t numOperands;
+    uint8_t numSuccessors;
+    // value indices
+    uint32_t operands[Inst::MaxOperands];
+    // positions in the function, as Inst::getSuccessors() orders them
+    uint32_t successors[Inst::MaxSuccessors];
+    // CheckIntervalInst
+    uint32_t line;
+    // CallInst: the callee's name and position in the image or NoIndex,
+    // and the value indices of the arguments in the references
+    uint32_t calleeName, callee;
+    uint32_t firstArg, numArgs;
+};
+
+static_assert(std::is_trivially_copyable_v<InstRecord> &&
+              sizeof(Header) % Alignment == 0);
+
+template <typename T>
+void writeArray(std::ostream &out, const T *array, size_t size) {
+    static const char padding[Alignment] = {};
+    size_t bytes = sizeof(T) * size;
+    out.write(reinterpret_cast<const char *>(array), bytes);
+    out.write(padding, (Alignment - bytes % Alignment) % Alignment);
+}
+
+// Hands out the arrays of an image in place
+class Reader {
+private:
+    std::string_view image;
+    size_t offset = 0;
+
+public:
+    Reader(std::string_view image) : image(image) {}
+
+    template <typename T> bool take(const T *&array, size_t size) {
+        size_t bytes = sizeof(T) * size;
+        if (offset > image.size() || bytes > image.size() - offset)
+            return false;
+        array = reinterpret_cast<const T *>(image.data() + offset);
+        offset += (bytes + Alignment - 1) / Alignment * Alignment;
+        return true;
+    }
+};
+
+// whether `first' and `size' denote a run of an array of `total' elements
+bool inRange(uint32_t first, uint32_t size, uint32_t total) {
+    return uint64_t(first) + size <= total;
+}
+
+// operands of each instruction type as its constructor takes them
+size_t numOperandsOf(InstType type) {
+    switch (type) {
+    case InstType::AddInst:
+    case InstType::SubInst:
+    case InstType::CheckIntervalInst:
+        return 3;
+    case InstType::AssignInst:
+    case InstType::IfInst:
+        return 2;
+    case InstType::InputInst:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+enum class OperandKind { Variable, Number, Any };
+
+// what operand `k' of an instruction of `type' must be, as the analyses
+// read it
+OperandKind operandKindOf(InstType type, size_t k) {
+    switch (type) {
+    case InstType::AddInst:
+    case InstType::SubInst:
+    case InstType::AssignInst:
+    case InstType::InputInst:
+        return k == 0 ? OperandKind::Variable : OperandKind::Any;
+    case InstType::CheckIntervalInst:
+    case InstType::IfInst:
+        return k == 0 ? OperandKind::Variable : OperandKind::Number;
+    default:
+        return OperandKind::Any;
+    }
+}
+
+} // namespace
+
+void IRCache::write(const Functions &functions, std::ostream &out) {
+    std::vector<SymbolRecord> symbols;
+    std::string chars;
+    std::unordered_map<SymbolId, uint32_t> symbolIndex;
+    auto addSymbol = [&](SymbolId symbol) {
+        auto [it, inserted] = symbolIndex.try_emplace(symbol, symbols.size());
+        if (inserted) {
+            std::string_view name = symbolName(symbol);
+            symbols.push_back({uint32_t(chars.size()), uint32_t(name.size())});
+            chars += name;
+        }
+        return it->second;
+    };
+
+    std::vector<ValueRecord> values;
+    std::unordered_map<const Value *, uint32_t> valueIndex;
+    auto addValue = [&](const Value *value) {
+        auto [it, inserted] = valueIndex.try_emplace(value, values.size());
+        if (inserted) {
+            assert(!value->isVersioned() && "SSA names cannot be cached");
+            ValueRecord record = {};
+            if (value->isVariable()) {
+                record.payload = addSymbol(value->getAsVariable());
+                record.var = value->getVarId();
+                record.isVariable = 1;
+            } else {
+                record.payload = value->getAsNumber();
+            }
+            values.push_back(record);
+        }
+        return it->second;
+    };
+
+    std::unordered_map<const Function *, uint32_t> functionIndex;
+    for (Function *function : functions)
+        functionIndex.emplace(function, functionIndex.size());
+
+    std::vector<FunctionRecord> functionRecords;
+    std::vector<InstRecord> insts;
+    std::vector<uint32_t> refs;
+    for (Function *function : functions) {
+        FunctionRecord record = {};
+        record.name = addSymbol(function->funcName);
+        record.firstInst = insts.size();
+        record.numInsts = function->getInsts().size();
+        record.firstArg = refs.size();
+        record.numArgs = function->getArgs().size();
+        for (Value *arg : function->getArgs())
+            refs.push_back(addValue(arg));
+        const VarTable &vars = function->getVars();
+        record.firstVar = refs.size();
+        record.numVars = vars.size() - 1;
+        for (VarId var = ZeroVar + 1; var < vars.size(); var++)
+            refs.push_back(addSymbol(vars.getSymbol(var)));
+        record.beginLabel = function->getBeginLabel();
+        record.endLabel = function->getEndLabel();
+        record.isRoot = function->isRoot();
+        functionRecords.push_back(record);
+
+        for (Inst *inst : function->getInsts()) {
+            assert(inst->getInstType() != InstType::PhiInst &&
+                   "SSA form cannot be cached");
+            InstRecord record = {};
+            record.type = uint8_t(inst->getInstType());
+            record.numOperands = inst->getOperandSize();
+            for (size_t i = 0; i < inst->getOperandSize(); i++)
+                record.operands[i] = addValue(inst->getOperand(i));
+            InstRange successors = inst->getSuccessors();
+            record.numSuccessors = successors.size();
+            for (size_t i = 0; i < successors.size(); i++)
+                record.successors[i] =
+                    function->getIndex(successors[i]->getLabel());
+            record.callee = NoIndex;
+
+            if (inst->getInstType() == InstType::IfInst) {
+                record.cmpop =
+                    uint8_t(static_cast<IfInst *>(inst)->getCmpOperator());
+            } else if (inst->getInstType() == InstType::CheckIntervalInst) {
+                record.line = static_cast<CheckIntervalInst *>(inst)->getLine();
+            } else if (inst->getInstType() == InstType::CallInst) {
+                auto callInst = static_cast<CallInst *>(inst);
+                record.calleeName = addSymbol(callInst->getCalleeName());
+                if (callInst->getCallee())
+                    record.callee = functionIndex.at(callInst->getCallee());
+                record.firstArg = refs.size();
+                record.numArgs = callInst->getArgs().size();
+                for (Value *arg : callInst->getArgs())
+                    refs.push_back(addValue(arg));
+            }
+            insts.push_back(record);
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.numSymbols = symbols.size();
+    header.numChars = chars.size();
+    header.numValues = values.size();
+    header.numFunctions = functionRecords.size();
+    header.numInsts = insts.size();
+    header.numRefs = refs.size();
+    writeArray(out, &header, 1);
+    writeArray(out, symbols.data(), symbols.size());
+    writeArray(out, chars.data(), chars.size());
+    writeArray(out, values.data(), values.size());
+    writeArray(out, functionRecords.data(), functionRecords.size());
+    writeArray(out, insts.data(), insts.size());
+    writeArray(out, refs.data(), refs.size());
+}
+
+IRCache::IRCache(std::string_view image) {
+    hasError = !load(image);
+    if (hasError) {
+        functions.clear();
+        arena.clear();
+    }
+}
+
+bool IRCache::load(std::string_view image) {
+    if (reinterpret_cast<uintptr_t>(image.data()) % Alignment != 0)
+        return false;
+    Reader reader(image);
+    const Header *header;
+    if (!reader.take(header, 1) ||
+        std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 ||
+        header->version != Version)
+        return false;
+
+    const SymbolRecord *symbols;
+    const char *chars;
+    const ValueRecord *values;
+    const FunctionRecord *functionRecords;
+    const InstRecord *insts;
+    const uint32_t *refs;
+    if (!reader.take(symbols, header->numSymbols) ||
+        !reader.take(chars, header->numChars) ||
+        !reader.take(values, header->numValues) ||
+        !reader.take(functionRecords, header->numFunctions) ||
+        !reader.take(insts, header->numInsts) ||
+        !reader.take(refs, header->numRefs))
+        return false;
+
+    std::vector<SymbolId> symbolIds(header->numSymbols);
+    for (size_t i = 0; i < header->numSymbols; i++) {
+        if (!inRange(symbols[i].offset, symbols[i].length, header->numChars))
+            return false;
+        symbolIds[i] = SymbolTable::global().intern(
+            std::string_view(chars + symbols[i].offset, symbols[i].length));
+    }
+
+    std::vector<Value *> valueIds(header->numValues);
+    for (size_t i = 0; i < header->numValues; i++) {
+        const ValueRecord &record = values[i];
+        if (!record.isVariable) {
+            valueIds[i] = arena.addValue(Value::ofNumber(record.payload));
+            continue;
+        }
+        if (record.payload < 0 || record.payload >= header->numSymbols)
+            return false;
+        valueIds[i] = arena.addValue(
+            Value::ofVariable(symbolIds[record.payload], record.var));
+    }
+
+    // a value of a function with variables `vars', nullptr if invalid
+    auto valueOf = [&](uint32_t index, const VarTable &vars) -> Value * {
+        if (index >= header->numValues)
+            return nullptr;
+        Value *value = valueIds[index];
+        if (value->isVariable() &&
+            (value->getVarId() == ZeroVar ||
+             value->getVarId() >= vars.size() ||
+             vars.getSymbol(value->getVarId()) != value->getAsVariable()))
+            return nullptr;
+        return value;
+    };
+
+    // reused for every call
+    std::vector<Value *> callArgs;
+    for (size_t id = 0; id < header->numFunctions; id++) {
+        const FunctionRecord &record = functionRecords[id];
+        if (record.name >= header->numSymbols ||
+            !inRange(record.firstInst, record.numInsts, header->numInsts) ||
+            !inRange(record.firstArg, record.numArgs, header->numRefs) ||
+            !inRange(record.firstVar, record.numVars, header->numRefs) ||
+            uint64_t(record.beginLabel) + record.numInsts + 1 !=
+                record.endLabel)
+            return false;
+
+        VarTable vars;
+        for (size_t i = 0; i < record.numVars; i++) {
+            uint32_t symbol = refs[record.firstVar + i];
+            if (symbol >= header->numSymbols)
+                return false;
+            vars.add(symbolIds[symbol]);
+        }
+        std::vector<Value *> args;
+        for (size_t i = 0; i < record.numArgs; i++) {
+            args.push_back(valueOf(refs[record.firstArg + i], vars));
+            if (!args.back() || !args.back()->isVariable())
+                return false;
+        }
+
+        Insts functionInsts(record.numInsts);
+        for (size_t i = 0; i < record.numInsts; i++) {
+            const InstRecord &inst = insts[record.firstInst + i];
+            if (inst.type > uint8_t(InstType::CallInst) ||
+                inst.numOperands != numOperandsOf(InstType(inst.type)))
+                return false;
+            Value *ops[Inst::MaxOperands];
+            Inst *created = nullptr;
+            for (size_t k = 0; k < inst.numOperands; k++) {
+                if (!(ops[k] = valueOf(inst.operands[k], vars)))
+                    return false;
+                OperandKind kind = operandKindOf(InstType(inst.type), k);
+                if ((kind == OperandKind::Variable && !ops[k]->isVariable()) ||
+                    (kind == OperandKind::Number && !ops[k]->isNumber()))
+                    return false;
+            }
+
+            switch (InstType(inst.type)) {
+            case InstType::AddInst:
+                created = arena.create<AddInst>(ops[0], ops[1], ops[2]);
+                break;
+            case InstType::SubInst:
+                created = arena.create<SubInst>(ops[0], ops[1], ops[2]);
+                break;
+            case InstType::InputInst:
+                created = arena.create<InputInst>(ops[0]);
+                break;
+            case InstType::AssignInst:
+                created = arena.create<AssignInst>(ops[0], ops[1]);
+                break;
+            case InstType::CheckIntervalInst: {
+                auto checkInst =
+                    arena.create<CheckIntervalInst>(ops[0], ops[1], ops[2]);
+                checkInst->setLine(inst.line);
+                created = checkInst;
+                break;
+            }
+            case InstType::IfInst:
+                if (inst.cmpop > uint8_t(CmpOperator::LEQ))
+                    return false;
+                created = arena.create<IfInst>(
+                    ops[0], CmpOperator(inst.cmpop), ops[1], nullptr);
+                break;
+            case InstType::GotoInst:
+                created = arena.create<GotoInst>(nullptr);
+                break;
+            case InstType::LabelInst:
+                created = arena.create<LabelInst>();
+                break;
+            case InstType::CallInst: {
+                if (inst.calleeName >= header->numSymbols ||
+                    !inRange(inst.firstArg, inst.numArgs, header->numRefs))
+                    return false;
+                callArgs.clear();
+                for (size_t k = 0; k < inst.numArgs; k++) {
+                    callArgs.push_back(valueOf(refs[inst.firstArg + k], vars));
+                    if (!callArgs.back())
+                        return false;
+                }
+                created = arena.create<CallInst>(symbolIds[inst.calleeName],
+                                                 arena.copyValues(callArgs));
+                break;
+            }
+            default:
+                return false;
+            }
+            functionInsts[i] = created;
+        }
+
+        // the edges link() adds, which linkPredecessors() relies on
+        for (size_t i = 0; i < record.numInsts; i++) {
+            const InstRecord &inst = insts[record.firstInst + i];
+            Inst *functionInst = functionInsts[i];
+            bool jumps = inst.type == uint8_t(InstType::GotoInst) ||
+                         inst.type == uint8_t(InstType::IfInst);
+            bool fallsThrough = i + 1 < record.numInsts &&
+                                inst.type != uint8_t(InstType::GotoInst);
+            if (inst.numSuccessors != size_t(fallsThrough) + jumps ||
+                (fallsThrough && inst.successors[0] != i + 1))
+                return false;
+            for (size_t k = 0; k < inst.numSuccessors; k++) {
+                if (inst.successors[k] >= record.numInsts)
+                    return false;
+                functionInst->addSuccessor(functionInsts[inst.successors[k]]);
+            }
+            functionInst->setLabel(record.beginLabel + 1 + i);
+
+            Inst *dest = jumps ? functionInst->getSuccessors()[fallsThrough]
+                               : nullptr;
+            if (inst.type == uint8_t(InstType::IfInst))
+                static_cast<IfInst *>(functionInst)->setDestInst(dest);
+            else if (inst.type == uint8_t(InstType::GotoInst))
+                static_cast<GotoInst *>(functionInst)->setDestInst(dest);
+        }
+
+        functions.emplace_back(new Function(symbolIds[record.name], args,
+                                            std::move(functionInsts),
+                                            std::move(vars)));
+        Function *function = functions.back().get();
+        function->setBeginLabel(record.beginLabel);
+        function->setEndLabel(record.endLabel);
+        function->setRoot(record.isRoot);
+        function->linkPredecessors();
+    }
+
+    for (size_t id = 0; id < header->numFunctions; id++) {
+        const FunctionRecord &record = functionRecords[id];
+        for (size_t i = 0; i < record.numInsts; i++) {
+            const InstRecord &inst = insts[record.firstInst + i];
+            if (inst.type != uint8_t(InstType::CallInst) ||
+                inst.callee == NoIndex)
+                continue;
+            if (inst.callee >= header->numFunctions)
+                return false;
+            auto callInst = static_cast<CallInst *>(
+                functions[id]->getInsts()[i]);
+            callInst->setCallee(functions[inst.callee].get());
+        }
+    }
+    return true;
+}
+
+Functions IRCache::getFunctions() {
+    Functions ret;
+    for (auto &function : functions)
+        ret.push_back(function.get());
+    return ret;
+}
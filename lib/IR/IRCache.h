@@ -0,0 +1,70 @@
+#ifndef IR_IRCACHE_H
+#define IR_IRCACHE_H
+
+#include "IR.h"
+#include "IRArena.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * A binary image of linked functions, so that a program lowered once can
+ * be analysed again without running the frontend.
+ *
+ * The image is a header followed by flat arrays of fixed-size records:
+ * the symbol names, the values, the functions and their instructions, and
+ * the argument and variable lists the records refer to by index. Records
+ * are 8-byte aligned and read in place, so a memory-mapped image (see
+ * SourceBuffer) is loaded without parsing or copying it. Loading interns
+ * each symbol once and places every instruction and value in an IRArena,
+ * so it makes no allocation per instruction.
+ *
+ * The image holds the instructions with their operands, labels, control
+ * flow edges, callee links and check lines. It is only valid for the
+ * format version it was written with, and for the byte order of the
+ * machine that wrote it.
+ */
+class IRCache {
+public:
+    static constexpr uint32_t Version = 1;
+
+private:
+    IRArena arena;
+    std::vector<std::unique_ptr<Function>> functions;
+    bool hasError = false;
+
+    bool load(std::string_view image);
+
+public:
+    /**
+     * @brief Write the image of `functions', which must be linked and not
+     * in SSA form. Their callees must be among them.
+     */
+    static void write(const Functions &functions, std::ostream &out);
+
+    /**
+     * @brief Load the functions of `image', which need not outlive the
+     * cache. A truncated, corrupt or out-of-date image is an error.
+     */
+    IRCache(std::string_view image);
+
+    IRCache(const IRCache &) = delete;
+    IRCache &operator=(const IRCache &) = delete;
+
+    bool hadError() const { return hasError; }
+
+    /**
+     * @brief The loaded functions, linked as when the image was written and
+     * owned by the cache. Empty after an error.
+     */
+    Functions getFunctions();
+};
+
+} // namespace fdlang::IR
+
+#endif
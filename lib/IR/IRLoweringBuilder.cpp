@@ -0,0 +1,217 @@
+#include "IRLoweringBuilder.h"
+
+#include "fdlang/errorHandler.h"
+
+#include "IRBuilder.h"
+
+#include <algorithm>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+using Node = IRLoweringBuilder::Node;
+
+uint32_t IRLoweringBuilder::addInst(Inst *inst) {
+    IR.push_back(inst);
+    nextInst.push_back(NoInst);
+    return IR.size() - 1;
+}
+
+Node IRLoweringBuilder::newFragment() {
+    fragments.emplace_back();
+    return fragments.size() - 1;
+}
+
+void IRLoweringBuilder::append(Node fragment, uint32_t inst) {
+    Fragment &f = fragments[fragment];
+    if (f.head == NoInst)
+        f.head = inst;
+    else
+        nextInst[f.tail] = inst;
+    f.tail = inst;
+}
+
+void IRLoweringBuilder::splice(Node fragment, Node other) {
+    if (other == NoFragment || fragments[other].head == NoInst)
+        return;
+    Fragment &f = fragments[fragment];
+    if (f.head == NoInst)
+        f.head = fragments[other].head;
+    else
+        nextInst[f.tail] = fragments[other].head;
+    f.tail = fragments[other].tail;
+}
+
+void IRLoweringBuilder::finishFunctions(Node functions, bool complete) {
+    // like the AST pipeline, which never checks a program that failed to
+    // parse
+    if (!complete)
+        return;
+    for (const Sema::Report &report : reports)
+        error(report.line, report.msg);
+    reports.clear();
+    if (hadError())
+        return;
+    linked = true;
+    IRBuilder::link(getFunctions());
+}
+
+Node IRLoweringBuilder::cond(size_t label, const Token &leftOperand,
+                             const Token &op, const Token &rightOperand) {
+    if (!sema.checkCond(leftOperand, op, rightOperand))
+        return NoFragment;
+    // the destination is set by the enclosing if or while
+    auto ifInst = arena.create<IfInst>(arena.getValue(leftOperand),
+                                       getCmpOperator(op.type),
+                                       arena.getValue(rightOperand), nullptr);
+    Node fragment = newFragment();
+    append(fragment, addInst(ifInst));
+    return fragment;
+}
+
+Node IRLoweringBuilder::binaryAssign(size_t label, const Token &variable,
+                                     const Token &leftOperand,
+                                     const Token &op,
+                                     const Token &rightOperand) {
+    if (!sema.checkBinaryAssign(variable, leftOperand, op, rightOperand))
+        return NoFragment;
+    // values in source order, which numbers the variables
+    Value *values[] = {arena.getValue(variable), arena.getValue(leftOperand),
+                       arena.getValue(rightOperand)};
+    Inst *inst;
+    if (op.type == TokenType::PLUS)
+        inst = arena.create<AddInst>(values[0], values[1], values[2]);
+    else
+        inst = arena.create<SubInst>(values[0], values[1], values[2]);
+    Node fragment = newFragment();
+    append(fragment, addInst(inst));
+    return fragment;
+}
+
+Node IRLoweringBuilder::unaryAssign(size_t label, const Token &variable,
+                                    const Token &operand) {
+    if (!sema.checkUnaryAssign(variable, operand))
+        return NoFragment;
+    // values in source order, which numbers the variables
+    Value *value = arena.getValue(variable);
+    Inst *inst;
+    if (operand.type == TokenType::CALL_INPUT)
+        inst = arena.create<InputInst>(value);
+    else
+        inst = arena.create<AssignInst>(value, arena.getValue(operand));
+    Node fragment = newFragment();
+    append(fragment, addInst(inst));
+    return fragment;
+}
+
+Node IRLoweringBuilder::ifStmt(size_t label, Node cond, Node trueBody,
+                               Node falseBody) {
+    if (cond == NoFragment)
+        return NoFragment;
+
+    uint32_t labelTrueBody = addInst(arena.create<LabelInst>());
+    uint32_t labelFalseBody = addInst(arena.create<LabelInst>());
+    uint32_t labelEnd = addInst(arena.create<LabelInst>());
+    auto ifInst = static_cast<IfInst *>(IR[fragments[cond].head]);
+    ifInst->setDestInst(IR[labelTrueBody]);
+
+    // the cond fragment holds just the IfInst, continue from there
+    append(cond, addInst(arena.create<GotoInst>(IR[labelFalseBody])));
+    append(cond, labelTrueBody);
+    splice(cond, trueBody);
+    append(cond, addInst(arena.create<GotoInst>(IR[labelEnd])));
+    append(cond, labelFalseBody);
+    splice(cond, falseBody);
+    append(cond, labelEnd);
+    return cond;
+}
+
+Node IRLoweringBuilder::whileStmt(size_t label, Node cond, Node body) {
+    if (cond == NoFragment)
+        return NoFragment;
+
+    uint32_t labelStart = addInst(arena.create<LabelInst>());
+    uint32_t labelBody = addInst(arena.create<LabelInst>());
+    uint32_t labelEnd = addInst(arena.create<LabelInst>());
+    auto ifInst = static_cast<IfInst *>(IR[fragments[cond].head]);
+    ifInst->setDestInst(IR[labelBody]);
+
+    Node fragment = newFragment();
+    append(fragment, labelStart);
+    splice(fragment, cond);
+    append(fragment, addInst(arena.create<GotoInst>(IR[labelEnd])));
+    append(fragment, labelBody);
+    splice(fragment, body);
+    append(fragment, addInst(arena.create<GotoInst>(IR[labelStart])));
+    append(fragment, labelEnd);
+    return fragment;
+}
+
+Node IRLoweringBuilder::check(size_t label, const Token &check,
+                              const std::vector<Token> &params) {
+    if (!sema.checkCheck(check, params))
+        return NoFragment;
+    auto checkIntervalInst =
+        arena.create<CheckIntervalInst>(arena.getValue(params[0]),
+                                        arena.getValue(params[1]),
+                                        arena.getValue(params[2]));
+    checkIntervalInst->setLine(check.line);
+    Node fragment = newFragment();
+    append(fragment, addInst(checkIntervalInst));
+    return fragment;
+}
+
+Node IRLoweringBuilder::call(size_t label, const Token &calleeName,
+                             const std::vector<Token> &args) {
+    if (!sema.checkCall(calleeName, args))
+        return NoFragment;
+    std::vector<Value *> operands;
+    for (const Token &arg : args)
+        operands.push_back(arena.getValue(arg));
+    auto callInst = arena.create<CallInst>(calleeName.getLiteralAsSymbol(),
+                                           arena.copyValues(operands));
+    Node fragment = newFragment();
+    append(fragment, addInst(callInst));
+    return fragment;
+}
+
+Node IRLoweringBuilder::function(size_t label, const Token &funcName,
+                                 const std::vector<Token> &args, Node body) {
+    // Sema reports the header before the body
+    size_t bodyReports = reports.size();
+    sema.checkFunction(funcName, args);
+    std::rotate(reports.begin() + functionReports,
+                reports.begin() + bodyReports, reports.end());
+    functionReports = reports.size();
+
+    if (!hadError()) {
+        std::vector<Value *> values;
+        for (const Token &arg : args)
+            values.push_back(arena.getValue(arg));
+
+        Insts insts;
+        insts.push_back(IR[addInst(arena.create<LabelInst>())]);
+        if (body != NoFragment)
+            for (uint32_t inst = fragments[body].head; inst != NoInst;
+                 inst = nextInst[inst])
+                insts.push_back(IR[inst]);
+        insts.push_back(IR[addInst(arena.create<LabelInst>())]);
+
+        functions.emplace_back(new Function(funcName.getLiteralAsSymbol(),
+                                            values, insts, arena.takeVars()));
+    }
+
+    // nothing refers to this function's fragments or variables any more
+    fragments.clear();
+    arena.takeVars();
+    return NoFragment;
+}
+
+Functions IRLoweringBuilder::getFunctions() {
+    Functions ret;
+    if (!linked)
+        return ret;
+    for (auto &function : functions)
+        ret.push_back(function.get());
+    return ret;
+}
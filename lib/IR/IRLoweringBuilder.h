@@ -0,0 +1,136 @@
+#ifndef IR_IRLOWERINGBUILDER_H
+#define IR_IRLOWERINGBUILDER_H
+
+#include "IR.h"
+#include "IRArena.h"
+
+#include "fdlang/parser.h"
+#include "fdlang/sema.h"
+#include "fdlang/token.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * Builder policy for BasicParser that checks every node with Sema and
+ * lowers it to IR as soon as the parser completes it, without building an
+ * AST. The linked functions equal those of IRBuilder::build on the AST of
+ * the same program.
+ *
+ * The parser completes nodes bottom-up, so a node's instructions are kept
+ * as a fragment, a chain threaded through the instructions, that its parent
+ * splices between its own labels and jumps. A function's chain becomes its
+ * instruction list once the function is complete.
+ *
+ * Sema diagnostics are held back until the whole program parsed, and then
+ * reported in the order Sema::check would report them. After a parse or
+ * Sema error no functions are produced.
+ */
+class IRLoweringBuilder {
+public:
+    // index of a fragment, NoFragment for nodes without instructions
+    using Node = uint32_t;
+
+    static constexpr Node NoFragment = UINT32_MAX;
+
+private:
+    static constexpr uint32_t NoInst = UINT32_MAX;
+
+    // a chain of instructions, head and tail index into IR
+    struct Fragment {
+        uint32_t head = NoInst, tail = NoInst;
+    };
+
+    IRArena arena;
+    // every instruction created, owned by the arena
+    std::vector<Inst *> IR;
+    // the instruction following each one of IR in its fragment
+    std::vector<uint32_t> nextInst;
+    // fragments of the function being parsed
+    std::vector<Fragment> fragments;
+    std::vector<std::unique_ptr<Function>> functions;
+
+    Sema sema;
+    std::vector<Sema::Report> reports;
+    // reports of functions before the one being parsed
+    size_t functionReports = 0;
+    bool linked = false;
+
+    uint32_t addInst(Inst *inst);
+    Node newFragment();
+    void append(Node fragment, uint32_t inst);
+    void splice(Node fragment, Node other);
+
+public:
+    IRLoweringBuilder() { sema.deferReports(&reports); }
+
+    IRLoweringBuilder(const IRLoweringBuilder &) = delete;
+    IRLoweringBuilder &operator=(const IRLoweringBuilder &) = delete;
+
+    static Node none() { return NoFragment; }
+
+    Node beginStmts(size_t label) { return newFragment(); }
+
+    void addStmt(Node stmts, Node stmt) { splice(stmts, stmt); }
+
+    void finishStmts(Node stmts) {}
+
+    Node beginFunctions(size_t label) { return NoFragment; }
+
+    void addFunction(Node functions, Node function) {}
+
+    // reports held back diagnostics and links the functions
+    void finishFunctions(Node functions, bool complete);
+
+    Node cond(size_t label, const Token &leftOperand, const Token &op,
+              const Token &rightOperand);
+
+    Node binaryAssign(size_t label, const Token &variable,
+                      const Token &leftOperand, const Token &op,
+                      const Token &rightOperand);
+
+    Node unaryAssign(size_t label, const Token &variable,
+                     const Token &operand);
+
+    Node ifStmt(size_t label, Node cond, Node trueBody, Node falseBody);
+
+    Node whileStmt(size_t label, Node cond, Node body);
+
+    Node check(size_t label, const Token &check,
+               const std::vector<Token> &params);
+
+    Node nop(size_t label) { return NoFragment; }
+
+    Node call(size_t label, const Token &calleeName,
+              const std::vector<Token> &args);
+
+    Node function(size_t label, const Token &funcName,
+                  const std::vector<Token> &args, Node body);
+
+    /**
+     * @brief Sema found an error
+     */
+    bool hadError() { return sema.hadError(); }
+
+    /**
+     * @brief The linked functions once the whole program parsed without
+     * errors, owned by the builder
+     */
+    Functions getFunctions();
+};
+
+} // namespace fdlang::IR
+
+namespace fdlang {
+
+// Lowers to IR while parsing, results from getBuilder().getFunctions()
+using LoweringParser = BasicParser<IR::IRLoweringBuilder>;
+
+extern template class BasicParser<IR::IRLoweringBuilder>;
+
+} // namespace fdlang
+
+#endif
@@ -0,0 +1,266 @@
+#include "SSAForm.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace fdlang::IR;
+
+template <typename Visit>
+void SSAForm::rewriteUses(Inst *inst, Visit visit) {
+    if (inst->getInstType() == InstType::CallInst) {
+        auto callInst = static_cast<CallInst *>(inst);
+        ValueRange args = callInst->getArgs();
+        for (size_t i = 0; i < args.size(); i++)
+            if (args[i]->isVariable())
+                callInst->setArg(i, visit(args[i]));
+        return;
+    }
+    for (size_t i = inst->isDef() ? 1 : 0; i < inst->getOperandSize(); i++)
+        if (inst->getOperand(i)->isVariable())
+            inst->setOperand(i, visit(inst->getOperand(i)));
+}
+
+SSAForm::SSAForm(Function *function)
+    : function(function), blocks(function),
+      cfg(CSRGraph::fromBlocks(blocks)),
+      dominators(cfg, blocks.getEntry()->getId()),
+      originals(function->getVars().size(), nullptr) {
+    placePhis();
+    rename();
+    collectUses();
+}
+
+SSAForm::~SSAForm() {
+    auto original = [&](Value *value) {
+        return value->isVersioned() ? originals[value->getVarId()] : value;
+    };
+    for (Inst *inst : function->getInsts()) {
+        rewriteUses(inst, original);
+        if (inst->isDef())
+            inst->setOperand(0, original(inst->getOperand(0)));
+    }
+}
+
+void SSAForm::placePhis() {
+    size_t numVars = function->getVars().size();
+    const NodeId None = DominatorTree::NoNode;
+
+    // the blocks writing each variable, and whether some block reads it
+    // before writing it
+    std::vector<std::pair<VarId, NodeId>> defBlocks;
+    std::vector<bool> global(numVars, false);
+    std::vector<NodeId> writtenIn(numVars, None);
+    for (NodeId block : dominators.getReversePostOrder()) {
+        for (Inst *inst : blocks.getBlock(block)->getInsts()) {
+            rewriteUses(inst, [&](Value *value) {
+                originals[value->getVarId()] = value;
+                if (writtenIn[value->getVarId()] != block)
+                    global[value->getVarId()] = true;
+                return value;
+            });
+            if (!inst->isDef())
+                continue;
+            Value *value = inst->getOperand(0);
+            originals[value->getVarId()] = value;
+            if (writtenIn[value->getVarId()] != block)
+                defBlocks.emplace_back(value->getVarId(), block);
+            writtenIn[value->getVarId()] = block;
+        }
+    }
+    std::sort(defBlocks.begin(), defBlocks.end());
+
+    // iterated dominance frontiers, blocks are marked with the variable
+    // they were last handled for
+    CSRGraph frontiers = dominators.frontiers(cfg);
+    std::vector<std::pair<NodeId, VarId>> placed;
+    std::vector<VarId> hasPhi(cfg.size(), ZeroVar);
+    std::vector<VarId> queued(cfg.size(), ZeroVar);
+    std::vector<NodeId> worklist;
+    for (size_t i = 0; i < defBlocks.size();) {
+        VarId var = defBlocks[i].first;
+        for (; i < defBlocks.size() && defBlocks[i].first == var; i++) {
+            queued[defBlocks[i].second] = var;
+            worklist.push_back(defBlocks[i].second);
+        }
+        if (!global[var]) {
+            worklist.clear();
+            continue;
+        }
+        while (!worklist.empty()) {
+            NodeId block = worklist.back();
+            worklist.pop_back();
+            for (NodeId frontier : frontiers.successors(block)) {
+                if (hasPhi[frontier] == var)
+                    continue;
+                hasPhi[frontier] = var;
+                placed.emplace_back(frontier, var);
+                if (queued[frontier] != var) {
+                    queued[frontier] = var;
+                    worklist.push_back(frontier);
+                }
+            }
+        }
+    }
+    std::sort(placed.begin(), placed.end());
+
+    phiOffsets.assign(cfg.size() + 1, 0);
+    for (auto [block, var] : placed) {
+        phiOffsets[block + 1]++;
+        BasicBlock *target = blocks.getBlock(block);
+        assert(target->front()->getInstType() == InstType::LabelInst);
+        std::vector<Value *> incoming(target->getPredecessors().size(),
+                                      nullptr);
+        auto phi = arena.create<PhiInst>(originals[var],
+                                         arena.copyValues(incoming));
+        phi->setLabel(target->front()->getLabel());
+        phis.push_back(phi);
+    }
+    for (size_t i = 0; i < cfg.size(); i++)
+        phiOffsets[i + 1] += phiOffsets[i];
+}
+
+void SSAForm::rename() {
+    size_t numVars = function->getVars().size();
+    // the current name of every variable, and the names it replaced
+    std::vector<Value *> current(numVars, nullptr);
+    std::vector<Value *> entry(numVars, nullptr);
+    std::vector<std::pair<VarId, Value *>> replaced;
+
+    auto newVersion = [&](VarId var, Inst *def) {
+        Value *value = arena.addValue(
+            originals[var]->withVersion(versions.size()));
+        versions.push_back(value);
+        defs.push_back(def);
+        return value;
+    };
+    auto define = [&](VarId var, Value *value) {
+        replaced.emplace_back(var, current[var]);
+        current[var] = value;
+    };
+    auto read = [&](Value *value) {
+        VarId var = value->getVarId();
+        if (current[var])
+            return current[var];
+        if (!entry[var])
+            entry[var] = newVersion(var, nullptr);
+        return entry[var];
+    };
+
+    // walk the dominator tree without recursion, a frame is a block, the
+    // index of its next child and the size of `replaced' on entry
+    struct Frame {
+        NodeId block;
+        uint32_t nextChild;
+        size_t numReplaced;
+    };
+    std::vector<Frame> stack;
+    auto enter = [&](NodeId block) {
+        stack.push_back({block, 0, replaced.size()});
+        for (PhiInst *phi : getPhis(block)) {
+            VarId var = phi->getOperand(0)->getVarId();
+            Value *value = newVersion(var, phi);
+            phi->setOperand(0, value);
+            define(var, value);
+        }
+        for (Inst *inst : blocks.getBlock(block)->getInsts()) {
+            rewriteUses(inst, read);
+            if (inst->isDef()) {
+                VarId var = inst->getOperand(0)->getVarId();
+                Value *value = newVersion(var, inst);
+                inst->setOperand(0, value);
+                define(var, value);
+            }
+        }
+        for (NodeId successor : cfg.successors(block)) {
+            CSRGraph::NodeRange predecessors = cfg.predecessors(successor);
+            for (size_t i = 0; i < predecessors.size(); i++) {
+                if (predecessors[i] != block)
+                    continue;
+                for (PhiInst *phi : getPhis(successor))
+                    phi->setIncoming(i, read(phi->getOperand(0)));
+            }
+        }
+    };
+
+    enter(dominators.getRoot());
+    while (!stack.empty()) {
+        Frame &frame = stack.back();
+        CSRGraph::NodeRange children = dominators.getChildren(frame.block);
+        if (frame.nextChild < children.size()) {
+            enter(children[frame.nextChild++]);
+            continue;
+        }
+        for (size_t i = replaced.size(); i-- > frame.numReplaced;)
+            current[replaced[i].first] = replaced[i].second;
+        replaced.resize(frame.numReplaced);
+        stack.pop_back();
+    }
+
+    // edges from unreachable blocks carry the entry names
+    for (PhiInst *phi : phis) {
+        ValueRange incoming = phi->getIncoming();
+        for (size_t i = 0; i < incoming.size(); i++)
+            if (!incoming[i])
+                phi->setIncoming(i, read(phi->getOperand(0)));
+    }
+}
+
+void SSAForm::collectUses() {
+    // every reading instruction, reachable blocks first in instruction
+    // order and then the phis
+    std::vector<std::pair<uint32_t, Inst *>> reads;
+    auto record = [&](Inst *inst) {
+        return [&reads, inst](Value *value) {
+            if (value->isVersioned())
+                reads.emplace_back(value->getVersion(), inst);
+            return value;
+        };
+    };
+    for (NodeId block = 0; block < blocks.size(); block++) {
+        if (!dominators.isReachable(block))
+            continue;
+        for (Inst *inst : blocks.getBlock(block)->getInsts())
+            rewriteUses(inst, record(inst));
+    }
+    for (PhiInst *phi : phis)
+        for (Value *value : phi->getIncoming())
+            record(phi)(value);
+
+    std::stable_sort(reads.begin(), reads.end(),
+                     [](const auto &a, const auto &b) {
+                         return a.first < b.first;
+                     });
+    reads.erase(std::unique(reads.begin(), reads.end()), reads.end());
+    useOffsets.assign(versions.size() + 1, 0);
+    for (auto [version, inst] : reads) {
+        useOffsets[version + 1]++;
+        uses.push_back(inst);
+    }
+    for (size_t i = 0; i < versions.size(); i++)
+        useOffsets[i + 1] += useOffsets[i];
+}
+
+void SSAForm::dump(std::ostream &out) const {
+    out << "function " << symbolName(function->funcName) << "(";
+    const std::vector<Value *> &args = function->getArgs();
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i > 0)
+            out << ", ";
+        args[i]->dump(out);
+    }
+    out << ") {" << std::endl;
+    for (NodeId block = 0; block < blocks.size(); block++) {
+        const Insts &insts = blocks.getBlock(block)->getInsts();
+        for (size_t i = 0; i < insts.size(); i++) {
+            insts[i]->dump(out);
+            out << std::endl;
+            if (i > 0)
+                continue;
+            for (PhiInst *phi : getPhis(block)) {
+                phi->dump(out);
+                out << std::endl;
+            }
+        }
+    }
+    out << "}" << std::endl;
+}
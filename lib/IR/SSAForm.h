@@ -0,0 +1,143 @@
+#ifndef IR_SSAFORM_H
+#define IR_SSAFORM_H
+
+#include "CSRGraph.h"
+#include "IR.h"
+#include "IRArena.h"
+#include "basicBlock.h"
+#include "dominatorTree.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * Static single assignment form of a linked Function, for the lifetime of
+ * the SSAForm.
+ *
+ * Construction follows Cytron et al.: phis are placed on the iterated
+ * dominance frontiers of each variable's definitions, and names are given
+ * by a walk of the dominator tree. Phis are semi-pruned, only variables
+ * read in some block before being written there get them.
+ *
+ * The function's instructions are rewritten in place to read and write SSA
+ * names, versioned copies of their variables numbered densely from 0
+ * across the function. Phis are not instructions of the function, they sit
+ * at the entry of join blocks, which always start with a LabelInst, and
+ * carry that label. Every name records its defining instruction and its
+ * users, for analyses that propagate facts along def-use edges. A variable
+ * read before any write on some path reads its entry name, which has no
+ * definition. Instructions in blocks unreachable from the entry are left
+ * as they are.
+ *
+ * Destroying the SSAForm puts the original operands back. Versions keep the
+ * VarId of their variable, so this is exact as long as nothing moves
+ * definitions while the function is in SSA form.
+ */
+class SSAForm {
+public:
+    /**
+     * A slice of an array of instructions
+     */
+    template <typename T> class Range {
+    private:
+        T *const *first, *const *last;
+
+    public:
+        Range(T *const *first, T *const *last) : first(first), last(last) {}
+
+        T *const *begin() const { return first; }
+        T *const *end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        T *operator[](size_t i) const { return first[i]; }
+    };
+
+private:
+    Function *function;
+    BlockGraph blocks;
+    CSRGraph cfg;
+    DominatorTree dominators;
+    // the phis and SSA names
+    IRArena arena;
+
+    // the phis of block b are phis[phiOffsets[b], phiOffsets[b + 1]), in
+    // VarId order
+    std::vector<uint32_t> phiOffsets;
+    std::vector<PhiInst *> phis;
+
+    // indexed by version
+    std::vector<Value *> versions;
+    std::vector<Inst *> defs;
+    std::vector<uint32_t> useOffsets;
+    std::vector<Inst *> uses;
+
+    // the interned Value of every VarId, to leave SSA form
+    std::vector<Value *> originals;
+
+    // replace every variable `inst' reads by visit(variable)
+    template <typename Visit> static void rewriteUses(Inst *inst, Visit visit);
+
+    void placePhis();
+    void rename();
+    void collectUses();
+
+public:
+    SSAForm(Function *function);
+
+    SSAForm(const SSAForm &) = delete;
+    SSAForm &operator=(const SSAForm &) = delete;
+
+    ~SSAForm();
+
+    Function *getFunction() const { return function; }
+
+    const BlockGraph &getBlocks() const { return blocks; }
+
+    const CSRGraph &getCFG() const { return cfg; }
+
+    const DominatorTree &getDominators() const { return dominators; }
+
+    /**
+     * @brief The phis at the entry of block `block'
+     */
+    Range<PhiInst> getPhis(size_t block) const {
+        return Range<PhiInst>(phis.data() + phiOffsets[block],
+                              phis.data() + phiOffsets[block + 1]);
+    }
+
+    size_t numPhis() const { return phis.size(); }
+
+    /**
+     * @brief Number of SSA names, their versions are 0 .. numVersions() - 1
+     */
+    size_t numVersions() const { return versions.size(); }
+
+    Value *getVersion(uint32_t version) const { return versions[version]; }
+
+    /**
+     * @brief The instruction or phi defining SSA name `version', nullptr for
+     * the value a variable has on entry
+     */
+    Inst *getDef(uint32_t version) const { return defs[version]; }
+
+    /**
+     * @brief The instructions and phis reading SSA name `version'
+     */
+    Range<Inst> getUses(uint32_t version) const {
+        return Range<Inst>(uses.data() + useOffsets[version],
+                           uses.data() + useOffsets[version + 1]);
+    }
+
+    /**
+     * @brief Print the function with the phis after the label of their
+     * block
+     */
+    void dump(std::ostream &out) const;
+};
+
+} // namespace fdlang::IR
+
+#endif
@@ -0,0 +1,36 @@
+#include "basicBlock.h"
+
+using namespace fdlang::IR;
+
+// control can reach `next' only from `prev', and `prev' only falls through
+static bool fallsThroughOnly(Inst *prev, Inst *next) {
+    const auto &successors = prev->getSuccessors();
+    const auto &predecessors = next->getPredecessors();
+    return successors.size() == 1 && successors[0] == next &&
+           predecessors.size() == 1 && predecessors[0] == prev;
+}
+
+BlockGraph::BlockGraph(Function *function) {
+    Insts &insts = function->getInsts();
+    assert(!insts.empty());
+    firstLabel = insts.front()->getLabel();
+    label2Block.resize(insts.size());
+
+    for (size_t i = 0; i < insts.size(); i++) {
+        // link() labels a function's instructions consecutively
+        assert(insts[i]->getLabel() == firstLabel + i);
+        if (i == 0 || !fallsThroughOnly(insts[i - 1], insts[i]))
+            blocks.emplace_back(new BasicBlock(blocks.size()));
+        blocks.back()->insts.push_back(insts[i]);
+        label2Block[i] = blocks.back().get();
+    }
+
+    for (auto &block : blocks) {
+        for (Inst *successor : block->back()->getSuccessors()) {
+            BasicBlock *target = getBlockOf(successor->getLabel());
+            assert(target->front() == successor);
+            block->successors.push_back(target);
+            target->predecessors.push_back(block.get());
+        }
+    }
+}
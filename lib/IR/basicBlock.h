@@ -0,0 +1,88 @@
+#ifndef IR_BASICBLOCK_H
+#define IR_BASICBLOCK_H
+
+#include "IR.h"
+
+#include <memory>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * A maximal run of instructions that control enters only at the first and
+ * leaves only after the last
+ */
+class BasicBlock {
+    friend class BlockGraph;
+
+private:
+    size_t id;
+    Insts insts;
+    std::vector<BasicBlock *> successors, predecessors;
+
+    BasicBlock(size_t id) : id(id) {}
+
+public:
+    /**
+     * @brief Position of the block in its graph, blocks are numbered in
+     * instruction order from 0
+     */
+    size_t getId() const { return id; }
+
+    const Insts &getInsts() const { return insts; }
+
+    Inst *front() const { return insts.front(); }
+
+    Inst *back() const { return insts.back(); }
+
+    /**
+     * @brief Successors in the order of back()'s successors, so an IfInst
+     * block has the false branch first and the taken branch second
+     */
+    const std::vector<BasicBlock *> &getSuccessors() const {
+        return successors;
+    }
+
+    const std::vector<BasicBlock *> &getPredecessors() const {
+        return predecessors;
+    }
+};
+
+/**
+ * The basic blocks of a linked Function, with block-level edges and a map
+ * from every instruction label to its block
+ */
+class BlockGraph {
+private:
+    std::vector<std::unique_ptr<BasicBlock>> blocks;
+    // indexed by label - firstLabel
+    std::vector<BasicBlock *> label2Block;
+    size_t firstLabel = 0;
+
+public:
+    BlockGraph(Function *function);
+
+    BlockGraph(const BlockGraph &) = delete;
+    BlockGraph &operator=(const BlockGraph &) = delete;
+
+    size_t size() const { return blocks.size(); }
+
+    BasicBlock *getBlock(size_t id) const { return blocks[id].get(); }
+
+    /**
+     * @brief The block holding the function's first instruction
+     */
+    BasicBlock *getEntry() const { return blocks.front().get(); }
+
+    /**
+     * @brief The block holding the instruction labelled `label'
+     */
+    BasicBlock *getBlockOf(size_t label) const {
+        assert(label - firstLabel < label2Block.size());
+        return label2Block[label - firstLabel];
+    }
+};
+
+} // namespace fdlang::IR
+
+#endif
@@ -0,0 +1,107 @@
+#include "callGraph.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace fdlang::IR;
+
+CallGraph::CallGraph(const Functions &functions) : functions(functions) {
+    SymbolId numNames = 0;
+    for (Function *function : functions)
+        numNames = std::max<SymbolId>(numNames, function->funcName + 1);
+    byName.assign(numNames, NoFunction);
+    for (FunctionId id = 0; id < functions.size(); id++)
+        byName[functions[id]->funcName] = id;
+
+    CSRGraph::Builder builder(functions.size());
+    // the last caller each function got an edge from, to add each once
+    std::vector<FunctionId> lastCaller(functions.size(), NoFunction);
+    for (FunctionId caller = 0; caller < functions.size(); caller++) {
+        for (Inst *inst : functions[caller]->getInsts()) {
+            if (inst->getInstType() != InstType::CallInst)
+                continue;
+            Function *callee = static_cast<CallInst *>(inst)->getCallee();
+            if (!callee)
+                continue;
+            FunctionId id = lookup(callee->funcName);
+            if (id == NoFunction || functions[id] != callee)
+                continue;
+            if (lastCaller[id] != caller) {
+                lastCaller[id] = caller;
+                builder.addEdge(caller, id);
+            }
+        }
+    }
+    calls = builder.build();
+
+    for (FunctionId id = 0; id < functions.size(); id++)
+        if (calls.predecessors(id).empty())
+            roots.push_back(id);
+    findComponents();
+}
+
+void CallGraph::findComponents() {
+    const uint32_t Unvisited = UINT32_MAX;
+    size_t size = functions.size();
+    componentOf.assign(size, Unvisited);
+    memberOffsets = {0};
+    std::vector<uint32_t> index(size, Unvisited), lowLink(size);
+    std::vector<FunctionId> componentStack;
+    uint32_t counter = 0;
+    // function and the index of its next callee to visit, without
+    // recursion since call chains can be long
+    std::vector<std::pair<FunctionId, uint32_t>> stack;
+    auto visit = [&](FunctionId function) {
+        index[function] = lowLink[function] = counter++;
+        componentStack.push_back(function);
+        stack.emplace_back(function, 0);
+    };
+    for (FunctionId start = 0; start < size; start++) {
+        if (index[start] != Unvisited)
+            continue;
+        visit(start);
+        while (!stack.empty()) {
+            FunctionId function = stack.back().first;
+            CSRGraph::NodeRange callees = calls.successors(function);
+            if (stack.back().second < callees.size()) {
+                FunctionId callee = callees[stack.back().second++];
+                if (index[callee] == Unvisited)
+                    visit(callee);
+                else if (componentOf[callee] == Unvisited)
+                    lowLink[function] =
+                        std::min(lowLink[function], index[callee]);
+                continue;
+            }
+            stack.pop_back();
+            if (!stack.empty()) {
+                FunctionId caller = stack.back().first;
+                lowLink[caller] = std::min(lowLink[caller], lowLink[function]);
+            }
+            if (lowLink[function] != index[function])
+                continue;
+            uint32_t component = memberOffsets.size() - 1;
+            FunctionId member;
+            do {
+                member = componentStack.back();
+                componentStack.pop_back();
+                componentOf[member] = component;
+                members.push_back(member);
+            } while (member != function);
+            memberOffsets.push_back(members.size());
+        }
+    }
+
+    // components come out callees first
+    topologicalOrder.reserve(size);
+    for (uint32_t component = numComponents(); component-- > 0;)
+        for (FunctionId member : getMembers(component))
+            topologicalOrder.push_back(member);
+}
+
+bool CallGraph::isRecursive(FunctionId function) const {
+    if (getMembers(componentOf[function]).size() > 1)
+        return true;
+    CSRGraph::NodeRange callees = calls.successors(function);
+    return std::find(callees.begin(), callees.end(), function) !=
+           callees.end();
+}
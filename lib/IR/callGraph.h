@@ -0,0 +1,109 @@
+#ifndef IR_CALLGRAPH_H
+#define IR_CALLGRAPH_H
+
+#include "CSRGraph.h"
+#include "IR.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * The calls between linked functions. Function i is the i-th function of
+ * the list the graph was built from, and an edge from f to g means f has a
+ * CallInst whose callee is g; several calls make one edge, and calls to
+ * functions outside the list make none.
+ *
+ * The strongly connected components, the groups of mutually recursive
+ * functions, are found with Tarjan's algorithm and numbered bottom-up:
+ * every component calls only into itself and components numbered before
+ * it.
+ */
+class CallGraph {
+public:
+    using FunctionId = NodeId;
+
+    static constexpr FunctionId NoFunction = UINT32_MAX;
+
+private:
+    Functions functions;
+    CSRGraph calls;
+    // the last function of each name, indexed by SymbolId
+    std::vector<FunctionId> byName;
+    std::vector<FunctionId> roots;
+    std::vector<uint32_t> componentOf;
+    // the members of component c are
+    // members[memberOffsets[c], memberOffsets[c + 1])
+    std::vector<uint32_t> memberOffsets;
+    std::vector<FunctionId> members;
+    std::vector<FunctionId> topologicalOrder;
+
+    void findComponents();
+
+public:
+    CallGraph(const Functions &functions);
+
+    size_t size() const { return functions.size(); }
+
+    Function *getFunction(FunctionId function) const {
+        return functions[function];
+    }
+
+    /**
+     * @brief The function calls to `name' resolve to, NoFunction if none.
+     * Constant time.
+     */
+    FunctionId lookup(SymbolId name) const {
+        return name < byName.size() ? byName[name] : NoFunction;
+    }
+
+    /**
+     * @brief The functions `function' calls, in the order of their first
+     * call
+     */
+    CSRGraph::NodeRange getCallees(FunctionId function) const {
+        return calls.successors(function);
+    }
+
+    CSRGraph::NodeRange getCallers(FunctionId function) const {
+        return calls.predecessors(function);
+    }
+
+    /**
+     * @brief The functions nothing calls, in list order. Function::isRoot()
+     * agrees but for functions a later one of the same name hides.
+     */
+    const std::vector<FunctionId> &getRoots() const { return roots; }
+
+    size_t numComponents() const { return memberOffsets.size() - 1; }
+
+    uint32_t getComponent(FunctionId function) const {
+        return componentOf[function];
+    }
+
+    CSRGraph::NodeRange getMembers(uint32_t component) const {
+        return CSRGraph::NodeRange(
+            members.data() + memberOffsets[component],
+            members.data() + memberOffsets[component + 1]);
+    }
+
+    /**
+     * @brief Whether `function' may call itself, directly or through
+     * others
+     */
+    bool isRecursive(FunctionId function) const;
+
+    /**
+     * @brief Every function, callers before their callees but for calls
+     * within a component, whose members are adjacent. Reversed, it is the
+     * bottom-up order summary-based analyses want.
+     */
+    const std::vector<FunctionId> &getTopologicalOrder() const {
+        return topologicalOrder;
+    }
+};
+
+} // namespace fdlang::IR
+
+#endif
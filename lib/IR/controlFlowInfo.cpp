@@ -0,0 +1,47 @@
+#include "controlFlowInfo.h"
+
+using namespace fdlang::IR;
+
+const CSRGraph &ControlFlowInfo::getGraph() {
+    if (!graph)
+        graph = CSRGraph::fromInsts(function);
+    return *graph;
+}
+
+const DominatorTree &ControlFlowInfo::getDominators() {
+    assert(!function->getInsts().empty());
+    if (!dominators)
+        dominators.emplace(getGraph(), 0);
+    return *dominators;
+}
+
+const DominatorTree &ControlFlowInfo::getPostDominators() {
+    if (postDominators)
+        return *postDominators;
+    const CSRGraph &forward = getGraph();
+    NodeId exit = getExitNode();
+    CSRGraph::Builder builder(forward.size() + 1);
+    builder.reserve(forward.numEdges() + 1);
+    for (NodeId node = 0; node < forward.size(); node++) {
+        CSRGraph::NodeRange successors = forward.successors(node);
+        if (successors.empty())
+            builder.addEdge(exit, node);
+        for (NodeId successor : successors)
+            builder.addEdge(successor, node);
+    }
+    postDominators.emplace(builder.build(), exit);
+    return *postDominators;
+}
+
+const LoopForest &ControlFlowInfo::getLoops() {
+    assert(!function->getInsts().empty());
+    if (!loops)
+        loops.emplace(getGraph(), 0);
+    return *loops;
+}
+
+const WeakTopologicalOrder &ControlFlowInfo::getWeakTopologicalOrder() {
+    if (!wto)
+        wto.emplace(getGraph(), getLoops(), 0);
+    return *wto;
+}
@@ -0,0 +1,64 @@
+#ifndef IR_CONTROLFLOWINFO_H
+#define IR_CONTROLFLOWINFO_H
+
+#include "CSRGraph.h"
+#include "IR.h"
+#include "dominatorTree.h"
+#include "loopForest.h"
+#include "weakTopologicalOrder.h"
+
+#include <optional>
+
+namespace fdlang::IR {
+
+/**
+ * The control-flow structure of one linked function at instruction level,
+ * each part computed on first use: the CSRGraph of its instructions, where
+ * node i is getInsts()[i], the dominator and post-dominator trees, the
+ * loop-nesting forest and a weak topological order. Get it through
+ * Function::getControlFlow(), which keeps it until the function's
+ * instructions or edges change.
+ *
+ * Not thread-safe: threads sharing a function must not be the first to ask
+ * for the same part at once.
+ */
+class ControlFlowInfo {
+private:
+    Function *function;
+    std::optional<CSRGraph> graph;
+    std::optional<DominatorTree> dominators, postDominators;
+    std::optional<LoopForest> loops;
+    std::optional<WeakTopologicalOrder> wto;
+
+public:
+    ControlFlowInfo(Function *function) : function(function) {}
+
+    const CSRGraph &getGraph();
+
+    /**
+     * @brief Dominators of the instructions, rooted at the first one
+     */
+    const DominatorTree &getDominators();
+
+    /**
+     * @brief Post-dominators of the instructions. The tree is rooted at a
+     * virtual exit node, getExitNode(), that every instruction without a
+     * successor leads to; instructions that cannot reach one, such as
+     * those of an endless loop, are unreachable in the tree.
+     */
+    const DominatorTree &getPostDominators();
+
+    NodeId getExitNode() const { return function->getInsts().size(); }
+
+    const LoopForest &getLoops();
+
+    /**
+     * @brief The weak topological order of the instructions from the first
+     * one, whose components are the loops of getLoops()
+     */
+    const WeakTopologicalOrder &getWeakTopologicalOrder();
+};
+
+} // namespace fdlang::IR
+
+#endif
@@ -0,0 +1,118 @@
+#include "dominatorTree.h"
+
+#include <utility>
+
+using namespace fdlang::IR;
+
+// reachable nodes of `graph' from `root' in reverse postorder, without
+// recursion since function bodies can nest deeply
+static std::vector<NodeId> reversePostOrderOf(const CSRGraph &graph,
+                                              NodeId root) {
+    std::vector<NodeId> order;
+    std::vector<bool> visited(graph.size(), false);
+    // node and the index of its next successor to visit
+    std::vector<std::pair<NodeId, uint32_t>> stack = {{root, 0}};
+    visited[root] = true;
+    while (!stack.empty()) {
+        auto &[node, next] = stack.back();
+        CSRGraph::NodeRange successors = graph.successors(node);
+        if (next < successors.size()) {
+            NodeId successor = successors[next++];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+            continue;
+        }
+        order.push_back(node);
+        stack.pop_back();
+    }
+    return std::vector<NodeId>(order.rbegin(), order.rend());
+}
+
+DominatorTree::DominatorTree(const CSRGraph &graph, NodeId root)
+    : root(root), idoms(graph.size(), NoNode),
+      reversePostOrder(reversePostOrderOf(graph, root)) {
+    const uint32_t Unvisited = UINT32_MAX;
+    std::vector<uint32_t> order(graph.size(), Unvisited);
+    for (size_t i = 0; i < reversePostOrder.size(); i++)
+        order[reversePostOrder[i]] = i;
+
+    // the root is its own dominator while iterating
+    idoms[root] = root;
+    auto intersect = [&](NodeId a, NodeId b) {
+        while (a != b) {
+            while (order[a] > order[b])
+                a = idoms[a];
+            while (order[b] > order[a])
+                b = idoms[b];
+        }
+        return a;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 1; i < reversePostOrder.size(); i++) {
+            NodeId node = reversePostOrder[i];
+            NodeId idom = NoNode;
+            for (NodeId predecessor : graph.predecessors(node)) {
+                if (idoms[predecessor] == NoNode)
+                    continue;
+                idom = idom == NoNode ? predecessor
+                                      : intersect(predecessor, idom);
+            }
+            if (idoms[node] != idom) {
+                idoms[node] = idom;
+                changed = true;
+            }
+        }
+    }
+    idoms[root] = NoNode;
+
+    CSRGraph::Builder builder(graph.size());
+    for (NodeId node = 0; node < graph.size(); node++)
+        if (idoms[node] != NoNode)
+            builder.addEdge(idoms[node], node);
+    tree = builder.build();
+
+    // number the tree in preorder, iteratively as above
+    pre.assign(graph.size(), 0);
+    post.assign(graph.size(), 0);
+    uint32_t counter = 0;
+    std::vector<std::pair<NodeId, uint32_t>> stack = {{root, 0}};
+    pre[root] = counter++;
+    while (!stack.empty()) {
+        auto &[node, next] = stack.back();
+        CSRGraph::NodeRange children = tree.successors(node);
+        if (next < children.size()) {
+            NodeId child = children[next++];
+            pre[child] = counter++;
+            stack.emplace_back(child, 0);
+            continue;
+        }
+        post[node] = counter;
+        stack.pop_back();
+    }
+}
+
+CSRGraph DominatorTree::frontiers(const CSRGraph &graph) const {
+    CSRGraph::Builder builder(graph.size());
+    // the last node added to each frontier, to add every node once
+    std::vector<NodeId> lastAdded(graph.size(), NoNode);
+    for (NodeId node : reversePostOrder) {
+        CSRGraph::NodeRange predecessors = graph.predecessors(node);
+        if (predecessors.size() < 2)
+            continue;
+        for (NodeId predecessor : predecessors) {
+            if (!isReachable(predecessor))
+                continue;
+            for (NodeId runner = predecessor; runner != idoms[node];
+                 runner = idoms[runner]) {
+                if (lastAdded[runner] == node)
+                    break;
+                lastAdded[runner] = node;
+                builder.addEdge(runner, node);
+            }
+        }
+    }
+    return builder.build();
+}
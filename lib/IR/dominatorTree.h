@@ -0,0 +1,80 @@
+#ifndef IR_DOMINATORTREE_H
+#define IR_DOMINATORTREE_H
+
+#include "CSRGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * The dominator tree of the nodes of a CSRGraph reachable from a root,
+ * computed with the iterative algorithm of Cooper, Harvey and Kennedy over
+ * reverse postorder. Dominance queries compare preorder intervals of the
+ * tree and take constant time.
+ */
+class DominatorTree {
+public:
+    static constexpr NodeId NoNode = UINT32_MAX;
+
+private:
+    NodeId root;
+    // NoNode for the root and for unreachable nodes
+    std::vector<NodeId> idoms;
+    std::vector<NodeId> reversePostOrder;
+    CSRGraph tree;
+    // preorder interval [pre, post) of every node's subtree in the tree
+    std::vector<uint32_t> pre, post;
+
+public:
+    DominatorTree(const CSRGraph &graph, NodeId root);
+
+    NodeId getRoot() const { return root; }
+
+    size_t size() const { return idoms.size(); }
+
+    bool isReachable(NodeId node) const {
+        return node == root || idoms[node] != NoNode;
+    }
+
+    /**
+     * @brief The immediate dominator of `node', NoNode for the root and for
+     * unreachable nodes
+     */
+    NodeId getIDom(NodeId node) const { return idoms[node]; }
+
+    /**
+     * @brief The nodes `node' immediately dominates, in increasing order
+     */
+    CSRGraph::NodeRange getChildren(NodeId node) const {
+        return tree.successors(node);
+    }
+
+    /**
+     * @brief Whether every path from the root to `b' passes `a'. A node
+     * dominates itself, and unreachable nodes dominate nothing.
+     */
+    bool dominates(NodeId a, NodeId b) const {
+        if (!isReachable(a) || !isReachable(b))
+            return false;
+        return pre[a] <= pre[b] && post[b] <= post[a];
+    }
+
+    /**
+     * @brief The reachable nodes in reverse postorder, the root first
+     */
+    const std::vector<NodeId> &getReversePostOrder() const {
+        return reversePostOrder;
+    }
+
+    /**
+     * @brief The dominance frontier of every node of `graph', the frontier
+     * of node n being the successors of n in the result
+     */
+    CSRGraph frontiers(const CSRGraph &graph) const;
+};
+
+} // namespace fdlang::IR
+
+#endif
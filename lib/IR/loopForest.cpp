@@ -0,0 +1,178 @@
+#include "loopForest.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace fdlang::IR;
+
+LoopForest::LoopForest(const CSRGraph &graph, NodeId root)
+    : loopOf(graph.size(), NoLoop) {
+    // nodes are handled by their depth-first preorder number from here on,
+    // under which the descendants of w are w + 1 .. last[w]
+    const uint32_t None = UINT32_MAX;
+    std::vector<uint32_t> number(graph.size(), None), last(graph.size());
+    std::vector<NodeId> nodeAt = {root};
+    // node and the index of its next successor to visit, without recursion
+    // since loops can nest deeply
+    std::vector<std::pair<NodeId, uint32_t>> stack = {{root, 0}};
+    number[root] = 0;
+    while (!stack.empty()) {
+        NodeId node = stack.back().first;
+        CSRGraph::NodeRange successors = graph.successors(node);
+        if (stack.back().second < successors.size()) {
+            NodeId successor = successors[stack.back().second++];
+            if (number[successor] == None) {
+                number[successor] = nodeAt.size();
+                nodeAt.push_back(successor);
+                stack.emplace_back(successor, 0);
+            }
+            continue;
+        }
+        last[number[node]] = nodeAt.size() - 1;
+        stack.pop_back();
+    }
+    uint32_t size = nodeAt.size();
+    auto isAncestor = [&](uint32_t w, uint32_t v) {
+        return w <= v && v <= last[w];
+    };
+
+    // predecessors from descendants close a loop; the others enter it
+    std::vector<std::vector<uint32_t>> backPreds(size), otherPreds(size);
+    for (uint32_t w = 0; w < size; w++) {
+        for (NodeId predecessor : graph.predecessors(nodeAt[w])) {
+            uint32_t v = number[predecessor];
+            if (v == None)
+                continue;
+            if (isAncestor(w, v))
+                backPreds[w].push_back(v);
+            else
+                otherPreds[w].push_back(v);
+        }
+    }
+
+    // Havlak's algorithm, with Ramalingam's correction for irreducible
+    // loops: the loops are collapsed innermost first into their headers,
+    // found with union-find, so every node joins the body of one header.
+    std::vector<uint32_t> representative(size);
+    for (uint32_t w = 0; w < size; w++)
+        representative[w] = w;
+    auto find = [&](uint32_t v) {
+        uint32_t ret = v;
+        while (representative[ret] != ret)
+            ret = representative[ret];
+        while (representative[v] != ret)
+            v = std::exchange(representative[v], ret);
+        return ret;
+    };
+    // the innermost header whose loop each node is in
+    std::vector<uint32_t> headerOf(size, None);
+    std::vector<bool> isHeader(size, false), irreducible(size, false);
+    // the header whose body each node was last added to
+    std::vector<uint32_t> inBody(size, None);
+    std::vector<uint32_t> body, worklist;
+    for (uint32_t w = size; w-- > 0;) {
+        body.clear();
+        for (uint32_t v : backPreds[w]) {
+            if (v == w) {
+                isHeader[w] = true;
+                continue;
+            }
+            uint32_t x = find(v);
+            if (inBody[x] != w) {
+                inBody[x] = w;
+                body.push_back(x);
+            }
+        }
+        worklist = body;
+        while (!worklist.empty()) {
+            uint32_t x = worklist.back();
+            worklist.pop_back();
+            for (uint32_t y : otherPreds[x]) {
+                uint32_t z = find(y);
+                if (!isAncestor(w, z)) {
+                    // entered past the header, the outer loop is entered
+                    // there too
+                    irreducible[w] = true;
+                    otherPreds[w].push_back(z);
+                } else if (z != w && inBody[z] != w) {
+                    inBody[z] = w;
+                    body.push_back(z);
+                    worklist.push_back(z);
+                }
+            }
+        }
+        if (!body.empty())
+            isHeader[w] = true;
+        for (uint32_t x : body) {
+            headerOf[x] = w;
+            representative[x] = w;
+        }
+    }
+
+    // number the loops in preorder of the forest, so that the loops nested
+    // in loop l are l + 1 .. lastNested[l]
+    std::vector<std::vector<uint32_t>> nestedHeaders(size);
+    std::vector<uint32_t> outermost;
+    for (uint32_t w = 0; w < size; w++) {
+        if (!isHeader[w])
+            continue;
+        if (headerOf[w] == None)
+            outermost.push_back(w);
+        else
+            nestedHeaders[headerOf[w]].push_back(w);
+    }
+    std::vector<LoopId> loopAt(size, NoLoop);
+    std::vector<std::pair<uint32_t, LoopId>> headers;
+    for (auto it = outermost.rbegin(); it != outermost.rend(); ++it)
+        headers.emplace_back(*it, NoLoop);
+    while (!headers.empty()) {
+        auto [w, parent] = headers.back();
+        headers.pop_back();
+        LoopId id = loops.size();
+        loopAt[w] = id;
+        Loop loop;
+        loop.header = nodeAt[w];
+        loop.parent = parent;
+        loop.depth = parent == NoLoop ? 1 : loops[parent].depth + 1;
+        loop.reducible = !irreducible[w];
+        for (uint32_t v : backPreds[w])
+            loop.latches.push_back(nodeAt[v]);
+        std::sort(loop.latches.begin(), loop.latches.end());
+        if (parent != NoLoop)
+            loops[parent].children.push_back(id);
+        loops.push_back(std::move(loop));
+        for (auto it = nestedHeaders[w].rbegin();
+             it != nestedHeaders[w].rend(); ++it)
+            headers.emplace_back(*it, id);
+    }
+    lastNested.resize(loops.size());
+    for (LoopId id = loops.size(); id-- > 0;) {
+        lastNested[id] = std::max(lastNested[id], id);
+        if (loops[id].parent != NoLoop)
+            lastNested[loops[id].parent] =
+                std::max(lastNested[loops[id].parent], lastNested[id]);
+    }
+
+    for (uint32_t v = 0; v < size; v++) {
+        if (isHeader[v])
+            loopOf[nodeAt[v]] = loopAt[v];
+        else if (headerOf[v] != None)
+            loopOf[nodeAt[v]] = loopAt[headerOf[v]];
+    }
+
+    // an edge leaves the loops around its source up to the innermost one
+    // around its target
+    for (uint32_t v = 0; v < size; v++) {
+        NodeId node = nodeAt[v];
+        for (NodeId successor : graph.successors(node))
+            for (LoopId loop = loopOf[node];
+                 loop != NoLoop && !contains(loop, successor);
+                 loop = loops[loop].parent)
+                loops[loop].exits.push_back(successor);
+    }
+    for (Loop &loop : loops) {
+        std::sort(loop.exits.begin(), loop.exits.end());
+        loop.exits.erase(std::unique(loop.exits.begin(), loop.exits.end()),
+                         loop.exits.end());
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef IR_LOOPFOREST_H
+#define IR_LOOPFOREST_H
+
+#include "CSRGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * The loop-nesting forest of the nodes of a CSRGraph reachable from a
+ * root, built with Havlak's algorithm in Ramalingam's corrected form, in
+ * nearly linear time however deep the loops nest.
+ *
+ * A loop is headed by a node that a depth-first search from the root
+ * enters it through, and the loops nested in it are those of its body
+ * without the header. A loop entered only through its header, as every
+ * loop of structured fdlang code is, is reducible; its header then
+ * dominates the whole loop.
+ */
+class LoopForest {
+public:
+    using LoopId = uint32_t;
+
+    static constexpr LoopId NoLoop = UINT32_MAX;
+
+    struct Loop {
+        NodeId header;
+        // the loop this one is nested in, NoLoop for an outermost one
+        LoopId parent;
+        // 1 for an outermost loop
+        uint32_t depth;
+        // whether control enters the loop only through the header
+        bool reducible;
+        // the loops nested directly in this one
+        std::vector<LoopId> children;
+        // the nodes of the loop with an edge back to the header
+        std::vector<NodeId> latches;
+        // the nodes outside the loop with an edge from inside
+        std::vector<NodeId> exits;
+    };
+
+private:
+    // outer loops before the loops nested in them
+    std::vector<Loop> loops;
+    // the innermost loop of every node
+    std::vector<LoopId> loopOf;
+    // the loops nested in loop l are l + 1 .. lastNested[l]
+    std::vector<LoopId> lastNested;
+
+public:
+    LoopForest(const CSRGraph &graph, NodeId root);
+
+    /**
+     * @brief Number of loops, which are numbered from 0 in preorder of the
+     * forest, the loops nested in a loop right after it
+     */
+    size_t size() const { return loops.size(); }
+
+    const Loop &getLoop(LoopId loop) const { return loops[loop]; }
+
+    /**
+     * @brief The innermost loop `node' is in, NoLoop if none
+     */
+    LoopId getLoopFor(NodeId node) const { return loopOf[node]; }
+
+    /**
+     * @brief Number of loops `node' is in
+     */
+    uint32_t getDepth(NodeId node) const {
+        return loopOf[node] == NoLoop ? 0 : loops[loopOf[node]].depth;
+    }
+
+    bool isHeader(NodeId node) const {
+        return loopOf[node] != NoLoop && loops[loopOf[node]].header == node;
+    }
+
+    /**
+     * @brief Whether `node' is in `loop' or in a loop nested in it
+     */
+    bool contains(LoopId loop, NodeId node) const {
+        return loopOf[node] != NoLoop && loop <= loopOf[node] &&
+               loopOf[node] <= lastNested[loop];
+    }
+};
+
+} // namespace fdlang::IR
+
+#endif
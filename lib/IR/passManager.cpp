@@ -0,0 +1,65 @@
+#include "passManager.h"
+#include "IRBuilder.h"
+
+#include <iomanip>
+
+using namespace fdlang::IR;
+
+static size_t countInsts(const Functions &functions) {
+    size_t ret = 0;
+    for (Function *function : functions)
+        ret += function->getInsts().size();
+    return ret;
+}
+
+bool FunctionPass::run(Functions &functions, IRArena &arena) {
+    bool changed = false;
+    for (Function *function : functions)
+        changed |= runOnFunction(function, arena);
+    return changed;
+}
+
+void PassManager::addPass(std::unique_ptr<Pass> pass) {
+    Statistics entry;
+    entry.name = pass->getName();
+    statistics.push_back(entry);
+    passes.push_back(std::move(pass));
+}
+
+void PassManager::run(Functions &functions) {
+    instsBefore += countInsts(functions);
+    bool changed = true;
+    for (size_t round = 0; changed && round < MaxRounds; round++) {
+        changed = false;
+        rounds++;
+        for (size_t i = 0; i < passes.size(); i++) {
+            size_t insts = countInsts(functions);
+            size_t numFunctions = functions.size();
+            Statistics &entry = statistics[i];
+            entry.runs++;
+            if (!passes[i]->run(functions, arena))
+                continue;
+            IRBuilder::link(functions);
+            changed = true;
+            entry.changes++;
+            entry.removedInsts += insts - countInsts(functions);
+            entry.removedFunctions += numFunctions - functions.size();
+        }
+    }
+    instsAfter += countInsts(functions);
+}
+
+void PassManager::dumpStatistics(std::ostream &out) const {
+    out << std::left << std::setw(24) << "pass" << std::right
+        << std::setw(8) << "runs" << std::setw(10) << "changes"
+        << std::setw(10) << "insts" << std::setw(12) << "functions"
+        << std::endl;
+    for (const Statistics &entry : statistics) {
+        out << std::left << std::setw(24) << entry.name << std::right
+            << std::setw(8) << entry.runs << std::setw(10) << entry.changes
+            << std::setw(10) << entry.removedInsts << std::setw(12)
+            << entry.removedFunctions << std::endl;
+    }
+    out << "instructions " << instsBefore << " -> " << instsAfter << " in "
+        << rounds << " rounds" << std::endl;
+}
@@ -0,0 +1,97 @@
+#ifndef IR_PASSMANAGER_H
+#define IR_PASSMANAGER_H
+
+#include "IR.h"
+#include "IRArena.h"
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * A transformation of linked functions. A pass may replace, drop or reorder
+ * instructions and drop functions, but only through Function::setInsts()
+ * and the Functions it is given; the PassManager relinks the program after
+ * every pass that reports a change.
+ */
+class Pass {
+public:
+    virtual ~Pass() = default;
+
+    /**
+     * @brief A short name for statistics, such as "constant-folding"
+     */
+    virtual std::string_view getName() const = 0;
+
+    /**
+     * @brief Transform `functions', creating any new instruction or value in
+     * `arena'. Return whether anything changed.
+     */
+    virtual bool run(Functions &functions, IRArena &arena) = 0;
+};
+
+/**
+ * A Pass that transforms every function on its own
+ */
+class FunctionPass : public Pass {
+public:
+    bool run(Functions &functions, IRArena &arena) override;
+
+    virtual bool runOnFunction(Function *function, IRArena &arena) = 0;
+};
+
+/**
+ * Runs a pipeline of passes over the program until none of them changes
+ * it, and counts what each pass removed. Instructions and values the
+ * passes create belong to the manager, which must outlive the functions'
+ * use; instructions they drop stay with their builder.
+ */
+class PassManager {
+public:
+    struct Statistics {
+        std::string_view name;
+        // runs, and runs that changed the program
+        size_t runs = 0, changes = 0;
+        size_t removedInsts = 0, removedFunctions = 0;
+    };
+
+private:
+    // the pipeline is repeated at most this often, a bound on passes that
+    // keep undoing each other
+    static constexpr size_t MaxRounds = 16;
+
+    IRArena arena;
+    std::vector<std::unique_ptr<Pass>> passes;
+    std::vector<Statistics> statistics;
+    size_t rounds = 0;
+    size_t instsBefore = 0, instsAfter = 0;
+
+public:
+    PassManager() = default;
+
+    PassManager(const PassManager &) = delete;
+    PassManager &operator=(const PassManager &) = delete;
+
+    void addPass(std::unique_ptr<Pass> pass);
+
+    /**
+     * @brief Run the pipeline on the linked `functions' to a fixed point.
+     * Functions may be dropped from the list; the rest are linked again
+     * afterwards, keeping their order.
+     */
+    void run(Functions &functions);
+
+    /**
+     * @brief One entry per pass in pipeline order, summed over all runs
+     */
+    const std::vector<Statistics> &getStatistics() const { return statistics; }
+
+    void dumpStatistics(std::ostream &out) const;
+};
+
+} // namespace fdlang::IR
+
+#endif
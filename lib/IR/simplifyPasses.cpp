@@ -0,0 +1,332 @@
+#include "simplifyPasses.h"
+#include "callGraph.h"
+
+#include <algorithm>
+
+using namespace fdlang::IR;
+
+static bool isJump(const Inst *inst) {
+    return inst->getInstType() == InstType::GotoInst ||
+           inst->getInstType() == InstType::IfInst;
+}
+
+static Inst *getDest(Inst *inst) {
+    if (inst->getInstType() == InstType::GotoInst)
+        return static_cast<GotoInst *>(inst)->getDestInst();
+    return static_cast<IfInst *>(inst)->getDestInst();
+}
+
+static void setDest(Inst *inst, Inst *dest) {
+    if (inst->getInstType() == InstType::GotoInst)
+        static_cast<GotoInst *>(inst)->setDestInst(dest);
+    else
+        static_cast<IfInst *>(inst)->setDestInst(dest);
+}
+
+// the first instruction from `index' on that is not a label
+static size_t skipLabels(const Insts &insts, size_t index) {
+    while (index < insts.size() &&
+           insts[index]->getInstType() == InstType::LabelInst)
+        index++;
+    return index;
+}
+
+// keep the instructions of `function' that `keep' holds for
+template <typename Keep>
+static bool filterInsts(Function *function, Keep keep) {
+    const Insts &insts = function->getInsts();
+    Insts kept;
+    kept.reserve(insts.size());
+    for (size_t i = 0; i < insts.size(); i++)
+        if (keep(i))
+            kept.push_back(insts[i]);
+    if (kept.size() == insts.size())
+        return false;
+    function->setInsts(std::move(kept));
+    return true;
+}
+
+static bool compare(long long x, CmpOperator op, long long y) {
+    switch (op) {
+    case CmpOperator::EQ:
+        return x == y;
+    case CmpOperator::GT:
+        return x > y;
+    case CmpOperator::GEQ:
+        return x >= y;
+    case CmpOperator::LT:
+        return x < y;
+    case CmpOperator::LEQ:
+        return x <= y;
+    }
+    return false;
+}
+
+// 1 if the condition of `inst' always holds, 0 if it never does, -1 if
+// that depends on the variables
+static int evaluate(const IfInst *inst) {
+    Value *x = inst->getOperand(0), *y = inst->getOperand(1);
+    if (x->isNumber() && y->isNumber())
+        return compare(x->getAsNumber(), inst->getCmpOperator(),
+                       y->getAsNumber());
+    if (x->isVariable() && y->isVariable() && x->getVarId() == y->getVarId())
+        return compare(0, inst->getCmpOperator(), 0);
+    return -1;
+}
+
+// x + y or x - y as the program computes them, saturated to [0, 255]. Sema
+// keeps numbers in that range; clamping them first also keeps a number read
+// from an IR cache from overflowing.
+static long long fold(InstType type, long long x, long long y) {
+    x = std::clamp(x, 0ll, 255ll);
+    y = std::clamp(y, 0ll, 255ll);
+    if (type == InstType::AddInst)
+        return std::min(x + y, 255ll);
+    return std::max(x - y, 0ll);
+}
+
+bool ConstantFolding::runOnFunction(Function *function, IRArena &arena) {
+    Insts insts;
+    insts.reserve(function->getInsts().size());
+    bool changed = false;
+    for (Inst *inst : function->getInsts()) {
+        InstType type = inst->getInstType();
+        if (type == InstType::AddInst || type == InstType::SubInst) {
+            Value *x = inst->getOperand(1), *y = inst->getOperand(2);
+            if (x->isNumber() && y->isNumber()) {
+                long long result = fold(type, x->getAsNumber(),
+                                        y->getAsNumber());
+                insts.push_back(arena.create<AssignInst>(
+                    inst->getOperand(0), arena.getNumber(result)));
+                changed = true;
+                continue;
+            }
+        } else if (type == InstType::IfInst) {
+            auto ifInst = static_cast<IfInst *>(inst);
+            int holds = evaluate(ifInst);
+            if (holds == 1)
+                insts.push_back(
+                    arena.create<GotoInst>(ifInst->getDestInst()));
+            if (holds != -1) {
+                changed = true;
+                continue;
+            }
+        }
+        insts.push_back(inst);
+    }
+    if (changed)
+        function->setInsts(std::move(insts));
+    return changed;
+}
+
+bool UnreachableCodeElimination::runOnFunction(Function *function,
+                                               IRArena &arena) {
+    const Insts &insts = function->getInsts();
+    if (insts.empty())
+        return false;
+    std::vector<bool> reached(insts.size(), false);
+    std::vector<size_t> worklist = {0};
+    reached[0] = true;
+    while (!worklist.empty()) {
+        size_t index = worklist.back();
+        worklist.pop_back();
+        for (Inst *successor : insts[index]->getSuccessors()) {
+            size_t next = function->getIndex(successor->getLabel());
+            if (!reached[next]) {
+                reached[next] = true;
+                worklist.push_back(next);
+            }
+        }
+    }
+    return filterInsts(function, [&](size_t i) {
+        return reached[i] ||
+               insts[i]->getInstType() == InstType::CheckIntervalInst;
+    });
+}
+
+// the comparison that holds exactly when `op' does not, if there is one
+static bool invert(CmpOperator op, CmpOperator &inverse) {
+    switch (op) {
+    case CmpOperator::GT:
+        inverse = CmpOperator::LEQ;
+        return true;
+    case CmpOperator::GEQ:
+        inverse = CmpOperator::LT;
+        return true;
+    case CmpOperator::LT:
+        inverse = CmpOperator::GEQ;
+        return true;
+    case CmpOperator::LEQ:
+        inverse = CmpOperator::GT;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool JumpThreading::runOnFunction(Function *function, IRArena &arena) {
+    Insts &insts = function->getInsts();
+    size_t size = insts.size();
+    auto indexOf = [&](Inst *inst) {
+        return function->getIndex(inst->getLabel());
+    };
+
+    // where a jump to each label may go instead, found once per label. A
+    // chain of gotos that loops stops where it starts looping.
+    std::vector<Inst *> threaded(size, nullptr);
+    std::vector<bool> onChain(size, false);
+    std::vector<size_t> chain;
+    auto thread = [&](size_t label) {
+        Inst *ret = nullptr;
+        for (size_t index = label; !ret;) {
+            if (threaded[index]) {
+                ret = threaded[index];
+                break;
+            }
+            if (onChain[index]) {
+                ret = insts[index];
+                break;
+            }
+            onChain[index] = true;
+            chain.push_back(index);
+            size_t next = skipLabels(insts, index);
+            if (next == size ||
+                insts[next]->getInstType() != InstType::GotoInst)
+                ret = insts[index];
+            else
+                index = indexOf(getDest(insts[next]));
+        }
+        for (size_t index : chain) {
+            threaded[index] = ret;
+            onChain[index] = false;
+        }
+        chain.clear();
+        return ret;
+    };
+
+    bool changed = false;
+    for (Inst *inst : insts) {
+        if (!isJump(inst))
+            continue;
+        Inst *dest = thread(indexOf(getDest(inst)));
+        if (dest != getDest(inst)) {
+            setDest(inst, dest);
+            changed = true;
+        }
+    }
+
+    // whether control reaches the instruction at `to' from the one before
+    // `from' without executing anything
+    auto fallsTo = [&](size_t from, size_t to) {
+        return from <= to && skipLabels(insts, from) >= to;
+    };
+    std::vector<bool> dropped(size, false);
+    for (size_t i = 0; i < size; i++) {
+        Inst *inst = insts[i];
+        if (!isJump(inst))
+            continue;
+        size_t dest = indexOf(getDest(inst));
+        if (fallsTo(i + 1, dest)) {
+            dropped[i] = true;
+            continue;
+        }
+        CmpOperator inverse;
+        if (inst->getInstType() != InstType::IfInst || i + 1 == size ||
+            insts[i + 1]->getInstType() != InstType::GotoInst ||
+            !fallsTo(i + 2, dest) ||
+            !invert(static_cast<IfInst *>(inst)->getCmpOperator(), inverse))
+            continue;
+        insts[i] = arena.create<IfInst>(inst->getOperand(0), inverse,
+                                        inst->getOperand(1),
+                                        getDest(insts[i + 1]));
+        dropped[i + 1] = true;
+        i++;
+    }
+    return filterInsts(function, [&](size_t i) { return !dropped[i]; }) ||
+           changed;
+}
+
+bool LabelCoalescing::runOnFunction(Function *function, IRArena &arena) {
+    const Insts &insts = function->getInsts();
+    // the first label of the run of labels each one is in
+    std::vector<Inst *> leader(insts.size(), nullptr);
+    for (size_t i = 0; i < insts.size(); i++) {
+        if (insts[i]->getInstType() != InstType::LabelInst)
+            continue;
+        bool follows = i > 0 && leader[i - 1];
+        leader[i] = follows ? leader[i - 1] : insts[i];
+    }
+
+    bool changed = false;
+    std::vector<bool> targeted(insts.size(), false);
+    for (Inst *inst : insts) {
+        if (!isJump(inst))
+            continue;
+        size_t dest = function->getIndex(getDest(inst)->getLabel());
+        if (leader[dest] && leader[dest] != insts[dest]) {
+            setDest(inst, leader[dest]);
+            dest = function->getIndex(leader[dest]->getLabel());
+            changed = true;
+        }
+        targeted[dest] = true;
+    }
+
+    // labels nothing jumps to, but one instruction stays
+    bool keepFirst = true;
+    for (size_t i = 0; i < insts.size(); i++)
+        if (insts[i]->getInstType() != InstType::LabelInst || targeted[i])
+            keepFirst = false;
+    return filterInsts(function,
+                       [&](size_t i) {
+                           return insts[i]->getInstType() !=
+                                      InstType::LabelInst ||
+                                  targeted[i] || (keepFirst && i == 0);
+                       }) ||
+           changed;
+}
+
+static bool hasCheck(Function *function) {
+    for (Inst *inst : function->getInsts())
+        if (inst->getInstType() == InstType::CheckIntervalInst)
+            return true;
+    return false;
+}
+
+bool DeadFunctionElimination::run(Functions &functions, IRArena &arena) {
+    CallGraph graph(functions);
+    std::vector<bool> reached(functions.size(), false);
+    std::vector<CallGraph::FunctionId> worklist;
+    for (CallGraph::FunctionId id = 0; id < functions.size(); id++) {
+        if (id == 0 || functions[id]->isRoot()) {
+            reached[id] = true;
+            worklist.push_back(id);
+        }
+    }
+    while (!worklist.empty()) {
+        CallGraph::FunctionId id = worklist.back();
+        worklist.pop_back();
+        for (CallGraph::FunctionId callee : graph.getCallees(id)) {
+            if (!reached[callee]) {
+                reached[callee] = true;
+                worklist.push_back(callee);
+            }
+        }
+    }
+
+    Functions kept;
+    for (CallGraph::FunctionId id = 0; id < functions.size(); id++)
+        if (reached[id] || hasCheck(functions[id]))
+            kept.push_back(functions[id]);
+    if (kept.size() == functions.size())
+        return false;
+    functions = std::move(kept);
+    return true;
+}
+
+void fdlang::IR::addSimplifyPasses(PassManager &manager) {
+    manager.addPass(std::make_unique<ConstantFolding>());
+    manager.addPass(std::make_unique<UnreachableCodeElimination>());
+    manager.addPass(std::make_unique<JumpThreading>());
+    manager.addPass(std::make_unique<LabelCoalescing>());
+    manager.addPass(std::make_unique<DeadFunctionElimination>());
+}
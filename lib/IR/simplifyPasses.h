@@ -0,0 +1,82 @@
+#ifndef IR_SIMPLIFYPASSES_H
+#define IR_SIMPLIFYPASSES_H
+
+#include "IR.h"
+#include "IRArena.h"
+#include "passManager.h"
+
+namespace fdlang::IR {
+
+// The passes keep every jump targeting a LabelInst, as the builders emit
+// them, so join blocks still start with a label. None of them drops a
+// check_interval: one in unreachable code stays, unreachable, so that
+// analyses still report it.
+
+/**
+ * Folds arithmetic on two numbers into an assignment, saturating at 255
+ * and 0 as the program's `+' and `-' do, and conditions that always hold
+ * or never do into a goto or nothing.
+ */
+class ConstantFolding : public FunctionPass {
+public:
+    std::string_view getName() const override { return "constant-folding"; }
+
+    bool runOnFunction(Function *function, IRArena &arena) override;
+};
+
+/**
+ * Drops the instructions control cannot reach from the function's entry,
+ * but for checks
+ */
+class UnreachableCodeElimination : public FunctionPass {
+public:
+    std::string_view getName() const override { return "unreachable-code"; }
+
+    bool runOnFunction(Function *function, IRArena &arena) override;
+};
+
+/**
+ * Retargets jumps to a label followed by a goto at that goto's target,
+ * drops jumps to where control falls through anyway, and turns
+ * `if c then goto L1; goto L2; L1:` into `if !c then goto L2; L1:` when
+ * the comparison has an inverse
+ */
+class JumpThreading : public FunctionPass {
+public:
+    std::string_view getName() const override { return "jump-threading"; }
+
+    bool runOnFunction(Function *function, IRArena &arena) override;
+};
+
+/**
+ * Merges runs of labels into their first one and drops labels nothing
+ * jumps to. A function is never left empty.
+ */
+class LabelCoalescing : public FunctionPass {
+public:
+    std::string_view getName() const override { return "label-coalescing"; }
+
+    bool runOnFunction(Function *function, IRArena &arena) override;
+};
+
+/**
+ * Drops the functions no call chain from a root reaches, such as mutually
+ * recursive ones nothing else calls. The first function, which the
+ * intraprocedural analyses start from, and functions with checks are kept.
+ */
+class DeadFunctionElimination : public Pass {
+public:
+    std::string_view getName() const override { return "dead-functions"; }
+
+    bool run(Functions &functions, IRArena &arena) override;
+};
+
+/**
+ * @brief Add the simplification pipeline to `manager', in the order it
+ * works best
+ */
+void addSimplifyPasses(PassManager &manager);
+
+} // namespace fdlang::IR
+
+#endif
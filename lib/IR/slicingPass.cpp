@@ -0,0 +1,263 @@
+#include "slicingPass.h"
+#include "SSAForm.h"
+#include "controlFlowInfo.h"
+
+using namespace fdlang::IR;
+
+// call `visit' on every value `inst' reads
+template <typename Visit> static void forEachUse(Inst *inst, Visit visit) {
+    if (inst->getInstType() == InstType::CallInst) {
+        for (Value *arg : static_cast<CallInst *>(inst)->getArgs())
+            visit(arg);
+        return;
+    }
+    for (size_t i = inst->isDef() ? 1 : 0; i < inst->getOperandSize(); i++)
+        visit(inst->getOperand(i));
+}
+
+// a copy of `inst' with every value replaced by rename(value), a jump going
+// to `dest'
+template <typename Rename>
+static Inst *copyInst(Inst *inst, IRArena &arena, Rename rename,
+                      Inst *dest) {
+    auto operand = [&](size_t i) { return rename(inst->getOperand(i)); };
+    switch (inst->getInstType()) {
+    case InstType::AddInst:
+        return arena.create<AddInst>(operand(0), operand(1), operand(2));
+    case InstType::SubInst:
+        return arena.create<SubInst>(operand(0), operand(1), operand(2));
+    case InstType::AssignInst:
+        return arena.create<AssignInst>(operand(0), operand(1));
+    case InstType::InputInst:
+        return arena.create<InputInst>(operand(0));
+    case InstType::CheckIntervalInst: {
+        auto check = arena.create<CheckIntervalInst>(operand(0), operand(1),
+                                                     operand(2));
+        check->setLine(static_cast<CheckIntervalInst *>(inst)->getLine());
+        return check;
+    }
+    case InstType::IfInst:
+        return arena.create<IfInst>(
+            operand(0), static_cast<IfInst *>(inst)->getCmpOperator(),
+            operand(1), dest);
+    case InstType::CallInst: {
+        auto call = static_cast<CallInst *>(inst);
+        std::vector<Value *> args;
+        for (Value *arg : call->getArgs())
+            args.push_back(rename(arg));
+        return arena.create<CallInst>(call->getCalleeName(),
+                                      arena.copyValues(args));
+    }
+    default:
+        assert(false && "labels and gotos are not copied");
+        return nullptr;
+    }
+}
+
+bool BackwardSlicing::runOnFunction(Function *function, IRArena &arena) {
+    const Insts &insts = function->getInsts();
+    NodeId size = insts.size();
+    ControlFlowInfo &info = function->getControlFlow();
+    const DominatorTree &postDominators = info.getPostDominators();
+    NodeId exit = info.getExitNode();
+    for (NodeId node = 0; node < size; node++)
+        if (!postDominators.isReachable(node))
+            return false;
+    auto indexOf = [&](Inst *inst) {
+        return NodeId(function->getIndex(inst->getLabel()));
+    };
+
+    // the branches each instruction is control dependent on: those from
+    // which it lies on the post-dominator chain of one successor but not
+    // on that of the branch itself
+    const CSRGraph &graph = info.getGraph();
+    CSRGraph::Builder builder(size);
+    for (NodeId branch = 0; branch < size; branch++) {
+        if (insts[branch]->getInstType() != InstType::IfInst)
+            continue;
+        NodeId join = postDominators.getIDom(branch);
+        for (NodeId successor : graph.successors(branch))
+            for (NodeId node = successor; node != join;
+                 node = postDominators.getIDom(node))
+                builder.addEdge(node, branch);
+    }
+    CSRGraph controlDependences = builder.build();
+
+    std::vector<bool> relevant(size, false);
+    std::vector<NodeId> worklist;
+    auto mark = [&](NodeId node) {
+        if (!relevant[node]) {
+            relevant[node] = true;
+            worklist.push_back(node);
+        }
+    };
+    for (NodeId node = 0; node < size; node++)
+        if (insts[node]->getInstType() == InstType::CheckIntervalInst ||
+            insts[node]->getInstType() == InstType::CallInst)
+            mark(node);
+
+    // bridging a loop that never exits would let control reach the code
+    // after it, so a branch leaving a loop is kept, with the values it
+    // tests, if a check or call can follow it
+    std::vector<bool> leadsToSeed(size, false);
+    std::vector<NodeId> upward = worklist;
+    for (NodeId node : upward)
+        leadsToSeed[node] = true;
+    while (!upward.empty()) {
+        NodeId node = upward.back();
+        upward.pop_back();
+        for (NodeId predecessor : graph.predecessors(node))
+            if (!leadsToSeed[predecessor]) {
+                leadsToSeed[predecessor] = true;
+                upward.push_back(predecessor);
+            }
+    }
+    for (NodeId branch = 0; branch < size; branch++) {
+        if (insts[branch]->getInstType() != InstType::IfInst ||
+            !leadsToSeed[branch])
+            continue;
+        const LoopForest &loops = info.getLoops();
+        LoopForest::LoopId loop = loops.getLoopFor(branch);
+        for (NodeId successor : graph.successors(branch))
+            if (loop != LoopForest::NoLoop && !loops.contains(loop, successor))
+                mark(branch);
+    }
+
+    {
+        // a phi stands for the definitions reaching it, which are followed
+        // through it
+        SSAForm ssa(function);
+        std::vector<bool> seen(ssa.numVersions(), false);
+        std::vector<uint32_t> versions;
+        auto use = [&](Value *value) {
+            if (!value->isVariable() || !value->isVersioned() ||
+                seen[value->getVersion()])
+                return;
+            seen[value->getVersion()] = true;
+            versions.push_back(value->getVersion());
+        };
+        while (!worklist.empty() || !versions.empty()) {
+            if (!versions.empty()) {
+                Inst *def = ssa.getDef(versions.back());
+                versions.pop_back();
+                if (!def)
+                    continue;
+                if (def->getInstType() == InstType::PhiInst) {
+                    for (Value *value :
+                         static_cast<PhiInst *>(def)->getIncoming())
+                        use(value);
+                } else {
+                    mark(indexOf(def));
+                }
+                continue;
+            }
+            NodeId node = worklist.back();
+            worklist.pop_back();
+            forEachUse(insts[node], use);
+            for (NodeId branch : controlDependences.successors(node))
+                mark(branch);
+        }
+    }
+
+    std::vector<NodeId> order;
+    size_t candidates = 0;
+    for (NodeId node = 0; node < size; node++) {
+        InstType type = insts[node]->getInstType();
+        if (type != InstType::LabelInst && type != InstType::GotoInst)
+            candidates++;
+        if (relevant[node])
+            order.push_back(node);
+    }
+    if (order.size() == candidates)
+        return false;
+
+    // where control goes instead of each instruction: the instruction
+    // itself if it is in the slice, else its nearest post-dominator that
+    // is, or the exit
+    std::vector<NodeId> nearest(size + 1, exit);
+    std::vector<NodeId> stack = {exit};
+    while (!stack.empty()) {
+        NodeId node = stack.back();
+        stack.pop_back();
+        for (NodeId child : postDominators.getChildren(node)) {
+            nearest[child] = relevant[child] ? child : nearest[node];
+            stack.push_back(child);
+        }
+    }
+    auto fallThrough = [&](NodeId node) {
+        return node + 1 < size ? nearest[node + 1] : exit;
+    };
+
+    // the jumps of the slice: an if's target, then where control goes on
+    // after each instruction when that is not the next one in the slice
+    std::vector<NodeId> jumps(order.size(), exit), gotos(order.size(), exit);
+    std::vector<bool> targeted(size + 1, false), needsGoto(order.size());
+    NodeId entry = nearest[0];
+    bool entryGoto = entry != (order.empty() ? exit : order[0]);
+    targeted[entry] = entryGoto;
+    for (size_t i = 0; i < order.size(); i++) {
+        Inst *inst = insts[order[i]];
+        NodeId next = i + 1 < order.size() ? order[i + 1] : exit;
+        if (inst->getInstType() == InstType::IfInst) {
+            jumps[i] = nearest[indexOf(static_cast<IfInst *>(inst)
+                                           ->getDestInst())];
+            targeted[jumps[i]] = true;
+        }
+        gotos[i] = fallThrough(order[i]);
+        needsGoto[i] = gotos[i] != next;
+        if (needsGoto[i])
+            targeted[gotos[i]] = true;
+    }
+
+    const VarTable &vars = function->getVars();
+    std::vector<bool> used(vars.size(), false);
+    auto markUsed = [&](Value *value) {
+        if (value->isVariable())
+            used[value->getVarId()] = true;
+    };
+    for (Value *arg : function->getArgs())
+        markUsed(arg);
+    for (NodeId node : order) {
+        Inst *inst = insts[node];
+        if (inst->isDef())
+            markUsed(inst->getOperand(0));
+        forEachUse(inst, markUsed);
+    }
+    VarTable slicedVars;
+    std::vector<Value *> renamed(vars.size(), nullptr);
+    for (VarId var = ZeroVar + 1; var < vars.size(); var++) {
+        if (!used[var])
+            continue;
+        SymbolId symbol = vars.getSymbol(var);
+        renamed[var] =
+            arena.addValue(Value::ofVariable(symbol, slicedVars.add(symbol)));
+    }
+    auto rename = [&](Value *value) {
+        return value->isVariable() ? renamed[value->getVarId()] : value;
+    };
+    std::vector<Value *> args;
+    for (Value *arg : function->getArgs())
+        args.push_back(rename(arg));
+
+    std::vector<LabelInst *> labels(size + 1, nullptr);
+    for (NodeId node = 0; node <= size; node++)
+        if (targeted[node])
+            labels[node] = arena.create<LabelInst>();
+    Insts sliced;
+    if (entryGoto)
+        sliced.push_back(arena.create<GotoInst>(labels[entry]));
+    for (size_t i = 0; i < order.size(); i++) {
+        if (labels[order[i]])
+            sliced.push_back(labels[order[i]]);
+        sliced.push_back(
+            copyInst(insts[order[i]], arena, rename, labels[jumps[i]]));
+        if (needsGoto[i])
+            sliced.push_back(arena.create<GotoInst>(labels[gotos[i]]));
+    }
+    if (labels[exit] || sliced.empty())
+        sliced.push_back(labels[exit] ? labels[exit]
+                                      : arena.create<LabelInst>());
+    function->setInsts(std::move(sliced));
+    function->setVars(std::move(slicedVars), std::move(args));
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef IR_SLICINGPASS_H
+#define IR_SLICINGPASS_H
+
+#include "IR.h"
+#include "IRArena.h"
+#include "passManager.h"
+
+namespace fdlang::IR {
+
+/**
+ * Reduces every function to the backward slice of its checks: the
+ * instructions the checked values depend on through data, found along the
+ * def-use edges of SSA form, or through control, found on the
+ * post-dominator tree. Calls are kept with their arguments.
+ *
+ * The dropped instructions are bridged as in Ball and Horwitz's slicing of
+ * programs with arbitrary control flow: an edge to a dropped instruction
+ * goes to its nearest post-dominator in the slice instead. A loop that
+ * might never exit must not be bridged over, or the code after it would
+ * become reachable, so every branch leaving a loop that a check or call
+ * can follow is kept too, with the values it tests. Of a loop that only
+ * computes unchecked values, just that skeleton is left. The variables
+ * are renumbered to those the slice still mentions, arguments included,
+ * which shrinks the states of the analyses that index them by VarId.
+ *
+ * A function where control cannot reach its end from some instruction is
+ * left alone, as its post-dominator tree does not cover it.
+ */
+class BackwardSlicing : public FunctionPass {
+public:
+    std::string_view getName() const override { return "backward-slicing"; }
+
+    bool runOnFunction(Function *function, IRArena &arena) override;
+};
+
+} // namespace fdlang::IR
+
+#endif
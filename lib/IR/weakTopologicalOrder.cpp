@@ -0,0 +1,86 @@
+#include "weakTopologicalOrder.h"
+
+#include <utility>
+
+using namespace fdlang::IR;
+
+WeakTopologicalOrder::WeakTopologicalOrder(const CSRGraph &graph,
+                                           const LoopForest &loops,
+                                           NodeId root)
+    : position(graph.size(), NoPosition) {
+    // the depth-first search LoopForest runs, for its postorder
+    std::vector<bool> visited(graph.size(), false);
+    std::vector<NodeId> postOrder;
+    std::vector<std::pair<NodeId, uint32_t>> stack = {{root, 0}};
+    visited[root] = true;
+    while (!stack.empty()) {
+        NodeId node = stack.back().first;
+        CSRGraph::NodeRange successors = graph.successors(node);
+        if (stack.back().second < successors.size()) {
+            NodeId successor = successors[stack.back().second++];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+            continue;
+        }
+        postOrder.push_back(node);
+        stack.pop_back();
+    }
+
+    // loop l + 1 -> the nodes and nested loops' headers directly in loop l,
+    // its header aside, in reverse postorder; 0 -> those in no loop
+    std::vector<std::vector<NodeId>> members(loops.size() + 1);
+    auto level = [&](LoopForest::LoopId loop) {
+        return loop == LoopForest::NoLoop ? 0 : loop + 1;
+    };
+    for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it) {
+        LoopForest::LoopId loop = loops.getLoopFor(*it);
+        if (loops.isHeader(*it))
+            loop = loops.getLoop(loop).parent;
+        members[level(loop)].push_back(*it);
+    }
+
+    // a header is followed by the members of its loop, without recursion
+    // since loops can nest deeply
+    order.reserve(postOrder.size());
+    componentEnd.reserve(postOrder.size());
+    heads.reserve(postOrder.size());
+    std::vector<std::pair<uint32_t, uint32_t>> levels = {{0, 0}};
+    while (!levels.empty()) {
+        auto [at, next] = levels.back();
+        if (next == members[at].size()) {
+            if (at != 0)
+                componentEnd[position[loops.getLoop(at - 1).header]] =
+                    order.size();
+            levels.pop_back();
+            continue;
+        }
+        levels.back().second++;
+        NodeId node = members[at][next];
+        position[node] = order.size();
+        order.push_back(node);
+        componentEnd.push_back(order.size());
+        heads.push_back(loops.isHeader(node));
+        if (loops.isHeader(node))
+            levels.emplace_back(level(loops.getLoopFor(node)), 0);
+    }
+}
+
+void WeakTopologicalOrder::dump(std::ostream &out) const {
+    // the ends of the components open at each index
+    std::vector<uint32_t> ends;
+    for (uint32_t i = 0; i < order.size(); i++) {
+        if (i > 0)
+            out << ' ';
+        if (heads[i]) {
+            out << '(';
+            ends.push_back(componentEnd[i]);
+        }
+        out << order[i];
+        while (!ends.empty() && ends.back() == i + 1) {
+            out << ')';
+            ends.pop_back();
+        }
+    }
+}
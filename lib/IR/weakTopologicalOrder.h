@@ -0,0 +1,100 @@
+#ifndef IR_WEAKTOPOLOGICALORDER_H
+#define IR_WEAKTOPOLOGICALORDER_H
+
+#include "CSRGraph.h"
+#include "loopForest.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace fdlang::IR {
+
+/**
+ * A weak topological order, in Bourdoncle's sense, of the nodes of a
+ * CSRGraph reachable from a root: a total order in which the nodes of every
+ * loop form a contiguous component led by its head, and every edge either
+ * goes forward or goes back to the head of a component around its source.
+ * Iterating a component until its head is stable, inner components first,
+ * reaches a fixed point with widening needed only at the heads.
+ *
+ * The components are the loops of the graph's LoopForest. Within each loop,
+ * and at the outermost level, its nodes and the loops nested directly in it
+ * go in reverse postorder of their headers under the search that built the
+ * forest, which every edge not closing a loop follows; so the order takes
+ * linear time to build and no recursion however deep the loops nest.
+ */
+class WeakTopologicalOrder {
+public:
+    static constexpr uint32_t NoPosition = UINT32_MAX;
+
+private:
+    // the reachable nodes, each head right before the rest of its component
+    std::vector<NodeId> order;
+    // node -> its index in order, NoPosition if unreachable
+    std::vector<uint32_t> position;
+    // index in order -> one past the last index of the component the node
+    // there heads, or the index itself plus one if it heads none
+    std::vector<uint32_t> componentEnd;
+    // index in order -> whether the node there heads a component, which
+    // may hold only itself if it has an edge to itself
+    std::vector<bool> heads;
+
+public:
+    /**
+     * @brief Order the nodes of `graph' reachable from `root', where `loops'
+     * is the forest of `graph' from `root'
+     */
+    WeakTopologicalOrder(const CSRGraph &graph, const LoopForest &loops,
+                         NodeId root);
+
+    const std::vector<NodeId> &getOrder() const { return order; }
+
+    size_t size() const { return order.size(); }
+
+    uint32_t getPosition(NodeId node) const { return position[node]; }
+
+    bool isHead(NodeId node) const {
+        return position[node] != NoPosition && heads[position[node]];
+    }
+
+    /**
+     * @brief One past the last index in getOrder() of the component whose
+     * head is at index `i', or i + 1 if no component's head is there
+     */
+    uint32_t getComponentEnd(uint32_t i) const { return componentEnd[i]; }
+
+    /**
+     * @brief Bourdoncle's recursive iteration strategy: call visit(node) on
+     * the nodes in order, and once past a component, on the whole of it
+     * again until isStable(head) holds, so inner components are stable
+     * before the rest of an outer one is visited again
+     */
+    template <typename Visit, typename IsStable>
+    void iterate(Visit visit, IsStable isStable) const {
+        // the indices of the heads of the components being stabilised
+        std::vector<uint32_t> open;
+        for (uint32_t i = 0; i < order.size();) {
+            if (heads[i] && (open.empty() || open.back() != i))
+                open.push_back(i);
+            visit(order[i++]);
+            while (!open.empty() && componentEnd[open.back()] == i) {
+                if (!isStable(order[open.back()])) {
+                    i = open.back();
+                    break;
+                }
+                open.pop_back();
+            }
+        }
+    }
+
+    /**
+     * @brief Print the order in Bourdoncle's notation, a component in
+     * parentheses, e.g. "0 (1 2 (3 4)) 5"
+     */
+    void dump(std::ostream &out) const;
+};
+
+} // namespace fdlang::IR
+
+#endif
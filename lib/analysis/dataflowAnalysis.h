@@ -5,16 +5,36 @@
 
 namespace fdlang::analysis {
 
+/**
+ * @brief The order a worklist analysis visits the nodes of a function in
+ */
+enum class IterationStrategy {
+    // first in first out, each node queued at most once
+    FIFO,
+    // Bourdoncle's recursive strategy over the weak topological order:
+    // each loop is stabilised, inner loops first, before the code after it
+    WTO
+};
+
 class DataflowAnalysis {
 protected:
     IR::Insts insts;
     IR::Functions funcs;
+    IterationStrategy strategy = IterationStrategy::FIFO;
+    size_t iterations = 0;
 
 public:
     DataflowAnalysis(const IR::Functions &funcs) : funcs(funcs) {
         insts = funcs[0]->getInsts();
     }
 
+    void setIterationStrategy(IterationStrategy s) { strategy = s; }
+
+    /**
+     * @brief The number of transfers the last run computed
+     */
+    size_t getIterations() const { return iterations; }
+
     virtual void run() = 0;
 
     virtual void dumpResult(std::ostream &out) = 0;
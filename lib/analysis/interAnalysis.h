@@ -9,10 +9,12 @@
 
 namespace fdlang::analysis {
 
-inline void dumpStates(std::ostream &out, States &states) {
+inline void dumpStates(std::ostream &out, const IR::VarTable &vars,
+                       States &states) {
     {
-        for (auto &[var, interval] : states) {
-            out << " " << var << " = ";
+        for (IR::VarId var = IR::ZeroVar + 1; var < states.size(); var++) {
+            const Interval &interval = states[var];
+            out << " " << vars.getName(var) << " = ";
             if (interval.isBottom) {
                 out << "Bottom;";
             } else {
@@ -34,11 +36,14 @@ public:
                 States inputStates)
         : caller(caller), callee(callsite->getCallee()), callsite(callsite) {
 
+        // both states are indexed by the VarIds of their own function
+        params.resize(callee->getVars().size());
+        inputStates.resize(caller->getVars().size());
         for (int i = 0; i < callsite->getArgs().size(); i++) {
             auto callsiteArg = callsite->getArgs()[i];
             auto calleeArg = callee->getArgs()[i];
-            params[calleeArg->getAsVariable()] =
-                inputStates[callsiteArg->getAsVariable()];
+            params[calleeArg->getVarId()] =
+                inputStates[callsiteArg->getVarId()];
         }
     }
 };
@@ -1,25 +1,79 @@
 #include "intervalAnalysis.h"
-#include <queue>
+
+#include "IR/controlFlowInfo.h"
+
+#include <utility>
 
 using namespace fdlang;
 using namespace fdlang::analysis;
 
-void IntervalAnalysis::fixedPoint() {
-    // ini States and worklist
-    inputStates[0] = iniStates();
-    worklist.push(0);
-
-    // worklist Iteration here
-    while (!worklist.empty()) {
-        auto label = worklist.front();
-        worklist.pop();
-        auto inst = insts[label];
-        States &inputState = inputStates[label];
-        States outputState;
-        // transfer Inst
-        outputState = transfer(inst, inputState);
-        // add Successors
-        addSuccessors(label, outputState);
+void IntervalAnalysis::prepare() {
+    collectThresholds();
+    const IR::LoopForest &loops = funcs[0]->getControlFlow().getLoops();
+    isLoopHead.assign(insts.size(), false);
+    for (size_t i = 0; i < insts.size(); i++)
+        isLoopHead[i] = loops.isHeader(i);
+    headJoins.assign(insts.size(), 0);
+}
+
+void IntervalAnalysis::collectThresholds() {
+    std::vector<bool> seen(256, false);
+    auto add = [&](long long c) {
+        if (0 <= c && c <= 255)
+            seen[c] = true;
+    };
+    add(0);
+    add(255);
+    for (IR::Inst *inst : insts) {
+        if (inst->getInstType() == IR::InstType::IfInst) {
+            // the bounds either branch may restrict to
+            long long c = inst->getOperand(1)->getAsNumber();
+            add(c - 1);
+            add(c);
+            add(c + 1);
+        } else if (inst->getInstType() == IR::InstType::CheckIntervalInst) {
+            add(inst->getOperand(1)->getAsNumber());
+            add(inst->getOperand(2)->getAsNumber());
+        }
+    }
+    thresholds.clear();
+    for (int c = 0; c < 256; c++)
+        if (seen[c])
+            thresholds.push_back(c);
+}
+
+void IntervalAnalysis::narrow() {
+    size_t numVars = funcs[0]->getVars().size();
+    for (size_t step = 0; step < narrowingSteps; step++) {
+        std::vector<States> next(insts.size(), States(numVars, false));
+        next[0] = iniStates();
+        // back edges carry the states of the last round, the others those
+        // of this one, as instructions are visited in order
+        for (size_t now = 0; now < insts.size(); now++) {
+            IR::InstRange successors = insts[now]->getSuccessors();
+            for (size_t k = 0; k < successors.size(); k++) {
+                size_t to = funcs[0]->getIndex(successors[k]->getLabel());
+                if (to > now)
+                    continue;
+                States outputState = transfer(insts[now], inputStates[now]);
+                propagate(insts[now], k, outputState, next[to], false);
+            }
+        }
+        for (size_t now = 0; now < insts.size(); now++) {
+            next[now] = next[now].meet(inputStates[now]);
+            States outputState = transfer(insts[now], next[now]);
+            iterations++;
+            IR::InstRange successors = insts[now]->getSuccessors();
+            for (size_t k = 0; k < successors.size(); k++) {
+                size_t to = funcs[0]->getIndex(successors[k]->getLabel());
+                if (to > now)
+                    propagate(insts[now], k, outputState, next[to], false);
+            }
+        }
+        bool changed = next != inputStates;
+        inputStates = std::move(next);
+        if (!changed)
+            break;
     }
 }
 
@@ -27,36 +81,96 @@ void IntervalAnalysis::fixedPoint() {
 ********************* Your code starts here *********************
 *****************************************************************/
 
-void IntervalAnalysis::checkInstsStates() {
+IntervalAnalysis::ResultType IntervalAnalysis::check(const States &state,
+                                                    IR::VarId x, long long l,
+                                                    long long r) {
     // You can modify this function arbitrarily
-    for (auto inst : insts) {
-        if (inst->getInstType() != IR::InstType::CheckIntervalInst)
-            continue;
-
-        IR::CheckIntervalInst *checkInst = (IR::CheckIntervalInst *)inst;
-        std::string variable = checkInst->getOperand(0)->getAsVariable();
-        long long l = checkInst->getOperand(1)->getAsNumber();
-        long long r = checkInst->getOperand(2)->getAsNumber();
-
-        results[checkInst] = ResultType::UNREACHABLE;
-    }
+    Interval interval = state.get(x);
+    if (interval.isBottom)
+        return ResultType::UNREACHABLE;
+    if (l <= interval.l && interval.r <= r)
+        return ResultType::YES;
+    return ResultType::NO;
 }
 
-States IntervalAnalysis::iniStates() {
+IntervalAnalysis::States IntervalAnalysis::iniStates() {
     // You can modify this function arbitrarily
-    return States();
+    IR::Function *function = funcs[0];
+    States ret(function->getVars().size(), true);
+    if (!function->isRoot())
+        for (IR::Value *arg : function->getArgs())
+            ret.set(arg->getVarId(), {0, 255, false});
+    return ret;
 }
 
-States IntervalAnalysis::transfer(IR::Inst *inst, States &input) {
+IntervalAnalysis::States IntervalAnalysis::transfer(IR::Inst *inst,
+                                                    const States &input) {
     // You can modify this function arbitrarily
-    return States();
-}
+    if (input.isBottom())
+        return input;
+    auto value = [&](IR::Value *operand) -> Interval {
+        if (operand->isNumber())
+            return {operand->getAsNumber(), operand->getAsNumber(), false};
+        return input.get(operand->getVarId());
+    };
 
-bool IntervalAnalysis::joinInto(const States &x, States &y) {
-    // You can modify this function arbitrarily
-    return true;
+    States output = input;
+    switch (inst->getInstType()) {
+    case IR::InstType::AddInst:
+        output.set(inst->getOperand(0)->getVarId(),
+                   saturatingAdd(value(inst->getOperand(1)),
+                                 value(inst->getOperand(2))));
+        break;
+    case IR::InstType::SubInst:
+        output.set(inst->getOperand(0)->getVarId(),
+                   saturatingSub(value(inst->getOperand(1)),
+                                 value(inst->getOperand(2))));
+        break;
+    case IR::InstType::AssignInst:
+        output.set(inst->getOperand(0)->getVarId(),
+                   value(inst->getOperand(1)));
+        break;
+    case IR::InstType::InputInst:
+        output.set(inst->getOperand(0)->getVarId(), {0, 255, false});
+        break;
+    default:
+        // arguments are passed by value, so calls change nothing here
+        break;
+    }
+    return output;
 }
 
-void IntervalAnalysis::addSuccessors(size_t nowLabel, States outputState) {
-    // You can modify this function arbitrarily
-}
\ No newline at end of file
+IntervalAnalysis::States IntervalAnalysis::filter(const IR::IfInst *inst,
+                                                  const States &input,
+                                                  bool branch) {
+    IR::VarId x = inst->getOperand(0)->getVarId();
+    long long c = inst->getOperand(1)->getAsNumber();
+    States ret = input;
+    switch (inst->getCmpOperator()) {
+    case IR::CmpOperator::EQ:
+        if (branch) {
+            ret.restrict(x, c, c);
+        } else {
+            // x != c only shrinks an interval that ends at c
+            Interval interval = ret.get(x);
+            if (!interval.isBottom && interval.l == c)
+                ret.restrict(x, c + 1, 255);
+            else if (!interval.isBottom && interval.r == c)
+                ret.restrict(x, 0, c - 1);
+        }
+        break;
+    case IR::CmpOperator::GT:
+        branch ? ret.restrict(x, c + 1, 255) : ret.restrict(x, 0, c);
+        break;
+    case IR::CmpOperator::GEQ:
+        branch ? ret.restrict(x, c, 255) : ret.restrict(x, 0, c - 1);
+        break;
+    case IR::CmpOperator::LT:
+        branch ? ret.restrict(x, 0, c - 1) : ret.restrict(x, c, 255);
+        break;
+    case IR::CmpOperator::LEQ:
+        branch ? ret.restrict(x, 0, c) : ret.restrict(x, c + 1, 255);
+        break;
+    }
+    return ret;
+}
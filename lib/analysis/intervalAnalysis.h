@@ -2,95 +2,89 @@
 #define ANALYSIS_INTERVALANALYSIS_H
 
 #include "IR/IR.h"
-#include "dataflowAnalysis.h"
+#include "nonRelationalAnalysis.h"
+#include "packedIntervals.h"
 
-#include <algorithm>
-#include <map>
-#include <queue>
 #include <vector>
 
 namespace fdlang::analysis {
-struct Interval {
-    long long l = 0, r = 0;
-    bool isBottom = true;
-    bool operator==(const Interval &o) const {
-        if (isBottom != o.isBottom)
-            return false;
-        if (isBottom == true)
-            return true;
-        return l == o.l && r == o.r;
-    }
-};
-// variable -> value
-using States = std::map<std::string, Interval>;
-
-class IntervalAnalysis : public DataflowAnalysis {
+// variable -> value, indexed by the IR::VarId of the analysed function
+using States = std::vector<Interval>;
+
+/**
+ * The interval domain over NonRelationalAnalysis. Intervals have infinite
+ * ascending chains, so the states of loop heads are widened with the
+ * constants of the program as thresholds and narrowed once stable.
+ */
+class IntervalAnalysis : public NonRelationalAnalysis<PackedIntervals> {
 public:
-    enum class ResultType { YES, NO, UNREACHABLE };
+    // the packed form of States, whose lattice operations run as SIMD
+    using States = PackedIntervals;
 
 private:
-    std::map<IR::CheckIntervalInst *, ResultType> results;
+    // constants the program compares against, with 0 and 255, sorted
+    std::vector<uint8_t> thresholds;
+    // index of a loop head -> times its states grew by a plain join
+    std::vector<size_t> headJoins;
+    std::vector<bool> isLoopHead;
+    size_t wideningDelay = 1;
+    size_t narrowingSteps = 2;
 
-    // label -> states
-    // label is regarded as the index of inst in insts
-    std::map<size_t, States> inputStates;
+public:
+    IntervalAnalysis(const IR::Functions &funcs)
+        : NonRelationalAnalysis(funcs) {}
 
-    std::queue<size_t> worklist;
+    /**
+     * @brief Let the states of a loop head grow `delay' times by plain joins
+     * before widening them
+     */
+    void setWideningDelay(size_t delay) { wideningDelay = delay; }
 
-public:
-    IntervalAnalysis(const IR::Functions &funcs) : DataflowAnalysis(funcs) {}
-
-    // DO NOT MODIFY THIS FUNCTION
-    void dumpResult(std::ostream &out) override {
-        using Location = std::pair<size_t, size_t>;
-
-        std::vector<std::pair<Location, ResultType>> ans;
-        for (auto [checkInst, result] : results) {
-            ans.emplace_back(
-                (Location){checkInst->getLine(), checkInst->getLabel()},
-                result);
-        }
-        std::sort(ans.begin(), ans.end());
-
-        for (auto [loc, result] : ans) {
-            auto [line, label] = loc;
-            out << "Line " << line << ": ";
-            if (result == ResultType::UNREACHABLE) {
-                out << "Unreachable" << std::endl;
-                continue;
-            }
-            out << (result == ResultType::YES ? "YES" : " NO") << std::endl;
-        }
-    }
+    /**
+     * @brief Run at most `steps' rounds of narrowing after the widened
+     * fixed point
+     */
+    void setNarrowingSteps(size_t steps) { narrowingSteps = steps; }
+
+private:
+    void collectThresholds();
+
+    /**
+     * @brief collect the thresholds and the loop heads
+     */
+    void prepare() override;
 
-    void run() override {
+    bool widensAt(size_t to) override {
+        return isLoopHead[to] && headJoins[to] >= wideningDelay;
+    }
 
-        fixedPoint();
+    bool widen(const States &state, States &input) override {
+        return input.widenWith(state, thresholds);
+    }
 
-        checkInstsStates();
-    };
+    void joined(size_t to) override {
+        if (isLoopHead[to])
+            headJoins[to]++;
+    }
 
     /**
-     * @brief compute Fix Point
-     * 
+     * @brief Recompute every state from its predecessors a bounded number of
+     * times, each round meeting with the last
      */
-    void fixedPoint();
+    void narrow() override;
+
+    ResultType check(const States &state, IR::VarId x, long long l,
+                     long long r) override;
 
     /****************************************************************
     ********************* Your code starts here *********************
     *****************************************************************/
 public:
     /**
-     * @brief check insts states
-     * 
+     * @brief the states on entry to the function: every variable is zero
+     * and, unless the function is a root, the arguments are unknown
      */
-    void checkInstsStates();
-
-    /**
-     * @brief collect all variables and set their value to bottom
-     * 
-     */
-    States iniStates();
+    States iniStates() override;
 
     /**
      * @brief transfer function
@@ -99,28 +93,13 @@ public:
      * @param input 
      * @return States 
      */
-    States transfer(IR::Inst *inst, States &input);
+    States transfer(IR::Inst *inst, const States &input) override;
 
     /**
-     * @brief check if sucInputStates == sucInputStates ⊔ outputState  or not
-     * @param outputState 
-     * @param sucInputStates 
-     * @return true 
-     * @return false 
-     */
-    bool joinInto(const States &outputState, States &sucInputStates);
-
-    /**
-     * @brief check if now inst outputState change will influence its successors inputState change
-     * and add its influenced successors to worklist
-     * 
-     * @param nowLabel 
-     * @param outputState 
-     * @see inst label:  inst->getLabel()  
-     * inst Successor: inst->getSuccessors()
-     * 
+     * @brief the states of the `branch' successor of `inst'
      */
-    void addSuccessors(size_t nowLabel, States outputState);
+    States filter(const IR::IfInst *inst, const States &input,
+                  bool branch) override;
 };
 
 } // namespace fdlang::analysis
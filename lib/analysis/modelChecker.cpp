@@ -48,7 +48,7 @@ void NaiveModelChecker::evaluate(Stmts *node, Envs &envs) {
 }
 
 bool NaiveModelChecker::evaluate(Cond *node, Env &env) {
-    std::string variable = node->leftOperand.lexeme;
+    SymbolId variable = node->leftOperand.getLiteralAsSymbol();
     long long x = env[variable];
     long long y = node->rightOperand.getLiteralAsNumber();
     switch (node->op.type) {
@@ -72,7 +72,7 @@ bool NaiveModelChecker::evaluate(Cond *node, Env &env) {
 
 void NaiveModelChecker::evaluate(UnaryAssignStmt *node, Envs &envs) {
     Envs newEnvs;
-    std::string variable = node->variable.lexeme;
+    SymbolId variable = node->variable.getLiteralAsSymbol();
     for (auto &env : envs) {
         switch (node->operand.type) {
         case TokenType::CALL_INPUT: {
@@ -92,7 +92,7 @@ void NaiveModelChecker::evaluate(UnaryAssignStmt *node, Envs &envs) {
         }
         case TokenType::IDENTIFIER: {
             Env newEnv = env;
-            long long x = newEnv[node->operand.lexeme];
+            long long x = newEnv[node->operand.getLiteralAsSymbol()];
             newEnv[variable] = x;
             newEnvs.insert(newEnv);
             break;
@@ -108,16 +108,16 @@ void NaiveModelChecker::evaluate(UnaryAssignStmt *node, Envs &envs) {
 
 void NaiveModelChecker::evaluate(BinaryAssignStmt *node, Envs &envs) {
     Envs newEnvs;
-    std::string variable = node->variable.lexeme;
+    SymbolId variable = node->variable.getLiteralAsSymbol();
     for (auto &env : envs) {
         Env newEnv = env;
         long long x, y;
         if (node->leftOperand.type == TokenType::IDENTIFIER)
-            x = newEnv[node->leftOperand.lexeme];
+            x = newEnv[node->leftOperand.getLiteralAsSymbol()];
         else
             x = node->leftOperand.getLiteralAsNumber();
         if (node->rightOperand.type == TokenType::IDENTIFIER)
-            y = newEnv[node->rightOperand.lexeme];
+            y = newEnv[node->rightOperand.getLiteralAsSymbol()];
         else
             y = node->rightOperand.getLiteralAsNumber();
         switch (node->op.type) {
@@ -178,9 +178,9 @@ void NaiveModelChecker::evaluate(WhileStmt *node, Envs &envs) {
 }
 
 void NaiveModelChecker::evaluate(CheckStmt *node, Envs &envs) {
-    std::string variable = node->params[0].lexeme;
+    SymbolId variable = node->params[0].getLiteralAsSymbol();
     for (auto &env : envs) {
-        long long v = env.count(variable) ? env.at(variable) : 0ll;
+        long long v = env[variable];
         reachableValue[node->label].set(v, 1);
     }
 }
@@ -188,11 +188,16 @@ void NaiveModelChecker::evaluate(CheckStmt *node, Envs &envs) {
 void NaiveModelChecker::evaluate(NopStmt *node, Envs &envs) {}
 
 void NaiveModelChecker::evaluate(CallStmt *node, Envs &envs) {
+    // pass arguments by position, the callee binds them to its parameters
     Envs newEnvs;
-    for (auto env : envs) {
-        Env newEnv;
+    for (auto &env : envs) {
+        Env newEnv(node->args.size());
         for (int i = 0; i < node->args.size(); i++) {
-            newEnv[std::to_string(i)] = env[node->args[i].lexeme];
+            const Token &arg = node->args[i];
+            if (arg.type == TokenType::NUMBER)
+                newEnv[i] = arg.getLiteralAsNumber();
+            else
+                newEnv[i] = env[arg.getLiteralAsSymbol()];
         }
         newEnvs.insert(newEnv);
     }
@@ -201,9 +206,9 @@ void NaiveModelChecker::evaluate(CallStmt *node, Envs &envs) {
 
 void NaiveModelChecker::evaluate(FunctionNodes *node, Envs &envs) {
     for (auto child : node->children) {
-        auto function = dynamic_cast<FunctionNode *>(child);
+        auto function = static_cast<FunctionNode *>(child);
         if (function->isRoot())
-            evaluate((FunctionNode *)child, envs);
+            evaluate(function, envs);
     }
 }
 
@@ -212,10 +217,10 @@ void NaiveModelChecker::evaluate(FunctionNode *node, Envs &envs) {
         evaluate((Stmts *)node->body, envs);
     } else {
         Envs newEnvs;
-        for (auto env : envs) {
-            Env newEnv;
+        for (auto &env : envs) {
+            Env newEnv(numSymbols, 0);
             for (int i = 0; i < node->args.size(); i++) {
-                newEnv[node->args[i].lexeme] = env[std::to_string(i)];
+                newEnv[node->args[i].getLiteralAsSymbol()] = env[i];
             }
             newEnvs.insert(newEnv);
         }
@@ -224,8 +229,9 @@ void NaiveModelChecker::evaluate(FunctionNode *node, Envs &envs) {
 }
 
 void NaiveModelChecker::run() {
-    root->accept(&info);
-    Env initEnv;
+    info.walk(root);
+    numSymbols = SymbolTable::global().size();
+    Env initEnv(numSymbols, 0);
     Envs initEnvs = {initEnv};
     evaluate((FunctionNodes *)root, initEnvs);
 }
@@ -233,7 +239,7 @@ void NaiveModelChecker::run() {
 void NaiveModelChecker::dumpResult(std::ostream &out) {
     for (auto &checkStmt : info.checks) {
         size_t id = checkStmt->label;
-        std::string variable = checkStmt->params[0].lexeme;
+        std::string_view variable = checkStmt->params[0].lexeme;
         long long l = checkStmt->params[1].getLiteralAsNumber();
         long long r = checkStmt->params[2].getLiteralAsNumber();
         out << "Line " << checkStmt->check.line << ": ";
@@ -2,7 +2,7 @@
 #define ANALYSIS_MODELCHECKER_H
 
 #include "fdlang/AST.h"
-#include "fdlang/ASTVisitor.h"
+#include "fdlang/ASTWalker.h"
 
 #include <bitset>
 #include <map>
@@ -14,39 +14,24 @@
 
 namespace fdlang::analysis {
 
-class InfoCollector : public ASTVisitor {
+class InfoCollector : public ASTWalker<InfoCollector> {
 public:
-    void visit(Stmts *node) override {
-        for (ASTNode *child : node->children) {
-            child->accept(this);
-        }
-    }
-    void visit(Cond *node) override {}
-    void visit(UnaryAssignStmt *node) override {}
-    void visit(BinaryAssignStmt *node) override {}
-    void visit(IfStmt *node) override {
-        node->trueBody->accept(this);
-        node->falseBody->accept(this);
-    }
-    void visit(WhileStmt *node) override { node->body->accept(this); }
-    void visit(CheckStmt *node) override { checks.push_back(node); }
-    void visit(NopStmt *node) override {}
     std::vector<CheckStmt *> checks;
-    void visit(CallStmt *node) override {}
-    void visit(FunctionNodes *node) override {
-        for (ASTNode *child : node->children) {
-            child->accept(this);
-        }
-    }
-    void visit(FunctionNode *node) override { node->body->accept(this); }
+
+    using ASTWalker<InfoCollector>::visit;
+    void visit(CheckStmt *node) { checks.push_back(node); }
 };
 
 class NaiveModelChecker {
 private:
     ASTNode *root;
 
-    using Env = std::map<std::string, long long>;
-    using Envs = std::set<Env>; // list of list of (identifier, value)
+    // SymbolId -> value, variables that were never assigned read as 0
+    using Env = std::vector<long long>;
+    using Envs = std::set<Env>;
+
+    // size of every Env, i.e. the number of interned symbols
+    size_t numSymbols = 0;
 
     // label -> valueSet
     std::unordered_map<size_t, std::bitset<256>> reachableValue;
@@ -0,0 +1,99 @@
+#include "nonRelationalAnalysis.h"
+
+#include "IR/controlFlowInfo.h"
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+template <typename States>
+void NonRelationalAnalysis<States>::fixedPoint() {
+    size_t numVars = funcs[0]->getVars().size();
+    inputStates.assign(insts.size(), States(numVars, false));
+    pending.assign(insts.size(), false);
+    iterations = 0;
+    if (insts.empty())
+        return;
+    prepare();
+    inputStates[0] = iniStates();
+    pending[0] = true;
+
+    if (strategy == IterationStrategy::WTO) {
+        // the heads of the components are the loop heads widened at
+        funcs[0]->getControlFlow().getWeakTopologicalOrder().iterate(
+            [&](IR::NodeId now) { visit(now); },
+            [&](IR::NodeId head) { return !pending[head]; });
+    } else {
+        worklist.push(0);
+        while (!worklist.empty()) {
+            auto now = worklist.front();
+            worklist.pop();
+            visit(now);
+        }
+    }
+
+    narrow();
+}
+
+template <typename States>
+void NonRelationalAnalysis<States>::visit(size_t now) {
+    if (!pending[now])
+        return;
+    pending[now] = false;
+    States outputState = transfer(insts[now], inputStates[now]);
+    iterations++;
+    addSuccessors(now, outputState);
+}
+
+template <typename States>
+void NonRelationalAnalysis<States>::addSuccessors(size_t now,
+                                                  const States &outputState) {
+    IR::Inst *inst = insts[now];
+    IR::InstRange successors = inst->getSuccessors();
+    for (size_t k = 0; k < successors.size(); k++) {
+        size_t next = funcs[0]->getIndex(successors[k]->getLabel());
+        bool widening = widensAt(next);
+        if (!propagate(inst, k, outputState, inputStates[next], widening))
+            continue;
+        if (!widening)
+            joined(next);
+        if (!pending[next]) {
+            pending[next] = true;
+            // the weak topological order visits it in its turn
+            if (strategy == IterationStrategy::FIFO)
+                worklist.push(next);
+        }
+    }
+}
+
+template <typename States>
+bool NonRelationalAnalysis<States>::propagate(IR::Inst *inst, size_t k,
+                                              const States &outputState,
+                                              States &input, bool widening) {
+    // the fall-through successor of an IfInst, if any, is its false branch
+    if (inst->getInstType() == IR::InstType::IfInst) {
+        bool branch = k + 1 == inst->getSuccessors().size();
+        States state =
+            filter(static_cast<IR::IfInst *>(inst), outputState, branch);
+        return widening ? widen(state, input) : joinInto(state, input);
+    }
+    return widening ? widen(outputState, input)
+                    : joinInto(outputState, input);
+}
+
+template <typename States>
+void NonRelationalAnalysis<States>::checkInstsStates() {
+    for (size_t i = 0; i < insts.size(); i++) {
+        IR::Inst *inst = insts[i];
+        if (inst->getInstType() != IR::InstType::CheckIntervalInst)
+            continue;
+
+        IR::CheckIntervalInst *checkInst = (IR::CheckIntervalInst *)inst;
+        IR::VarId variable = checkInst->getOperand(0)->getVarId();
+        long long l = checkInst->getOperand(1)->getAsNumber();
+        long long r = checkInst->getOperand(2)->getAsNumber();
+        results[checkInst] = check(inputStates[i], variable, l, r);
+    }
+}
+
+template class fdlang::analysis::NonRelationalAnalysis<PackedIntervals>;
+template class fdlang::analysis::NonRelationalAnalysis<ValueSets>;
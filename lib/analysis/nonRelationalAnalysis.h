@@ -0,0 +1,171 @@
+#ifndef ANALYSIS_NONRELATIONALANALYSIS_H
+#define ANALYSIS_NONRELATIONALANALYSIS_H
+
+#include "IR/IR.h"
+#include "dataflowAnalysis.h"
+#include "packedIntervals.h"
+#include "valueSets.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace fdlang::analysis {
+
+/**
+ * The worklist engine of an analysis keeping one abstract value per
+ * variable on entry to every instruction of funcs[0], templated on the
+ * state type. `States' has a constructor taking the number of variables
+ * and whether the state is the initial one or bottom, isBottom() and
+ * joinWith().
+ *
+ * A domain supplies the initial states, the transfer of an instruction,
+ * the filter of a branch and the answer to a check. One with infinite
+ * ascending chains also overrides the widening hooks, widensAt() and
+ * widen(), and may recover precision in narrow() once the iteration is
+ * stable.
+ */
+template <typename StatesT>
+class NonRelationalAnalysis : public DataflowAnalysis {
+public:
+    enum class ResultType { YES, NO, UNREACHABLE };
+
+    using States = StatesT;
+
+protected:
+    std::map<IR::CheckIntervalInst *, ResultType> results;
+
+    // index of inst in insts -> states on entry to the inst
+    std::vector<States> inputStates;
+
+    std::queue<size_t> worklist;
+    // index of inst -> whether its states changed since it was last visited
+    std::vector<bool> pending;
+
+public:
+    NonRelationalAnalysis(const IR::Functions &funcs)
+        : DataflowAnalysis(funcs) {}
+
+    // DO NOT MODIFY THIS FUNCTION
+    void dumpResult(std::ostream &out) override {
+        using Location = std::pair<size_t, size_t>;
+
+        std::vector<std::pair<Location, ResultType>> ans;
+        for (auto [checkInst, result] : results) {
+            ans.emplace_back(
+                (Location){checkInst->getLine(), checkInst->getLabel()},
+                result);
+        }
+        std::sort(ans.begin(), ans.end());
+
+        for (auto [loc, result] : ans) {
+            auto [line, label] = loc;
+            out << "Line " << line << ": ";
+            if (result == ResultType::UNREACHABLE) {
+                out << "Unreachable" << std::endl;
+                continue;
+            }
+            out << (result == ResultType::YES ? "YES" : " NO") << std::endl;
+        }
+    }
+
+    void run() override {
+        fixedPoint();
+        checkInstsStates();
+    }
+
+    /**
+     * @brief compute the fixed point, widening where the domain asks to,
+     * and then narrow it
+     */
+    void fixedPoint();
+
+    /**
+     * @brief answer every check from the states on entry to it
+     */
+    void checkInstsStates();
+
+    /**
+     * @brief the states on entry to the function
+     */
+    virtual States iniStates() = 0;
+
+    virtual States transfer(IR::Inst *inst, const States &input) = 0;
+
+    /**
+     * @brief the states of the `branch' successor of `inst'
+     */
+    virtual States filter(const IR::IfInst *inst, const States &input,
+                          bool branch) = 0;
+
+    /**
+     * @brief sucInputStates = sucInputStates ⊔ outputState
+     * @return true if sucInputStates changed
+     */
+    bool joinInto(const States &outputState, States &sucInputStates) {
+        return sucInputStates.joinWith(outputState);
+    }
+
+    /**
+     * @brief join the output states of the inst at `now' into its
+     * successors and queue those that changed
+     */
+    void addSuccessors(size_t now, const States &outputState);
+
+protected:
+    /**
+     * @brief whether every value of `x' in `state' is in [l, r]
+     */
+    virtual ResultType check(const States &state, IR::VarId x, long long l,
+                             long long r) = 0;
+
+    /**
+     * @brief set up the domain before the iteration starts
+     */
+    virtual void prepare() {}
+
+    /**
+     * @brief whether the states flowing into the inst at `to' are widened
+     * rather than joined
+     */
+    virtual bool widensAt(size_t to) { return false; }
+
+    /**
+     * @brief input = input ∇ state
+     * @return true if input changed
+     */
+    virtual bool widen(const States &state, States &input) {
+        return joinInto(state, input);
+    }
+
+    /**
+     * @brief called when a plain join changed the states of the inst at
+     * `to'
+     */
+    virtual void joined(size_t to) {}
+
+    /**
+     * @brief improve the stable states, after the iteration
+     */
+    virtual void narrow() {}
+
+    /**
+     * @brief transfer the states of a pending inst to its successors
+     */
+    void visit(size_t now);
+
+    /**
+     * @brief join or widen the states `inst' passes to its `k'-th successor
+     * into `input'
+     * @return true if input changed
+     */
+    bool propagate(IR::Inst *inst, size_t k, const States &outputState,
+                   States &input, bool widening);
+};
+
+extern template class NonRelationalAnalysis<PackedIntervals>;
+extern template class NonRelationalAnalysis<ValueSets>;
+
+} // namespace fdlang::analysis
+#endif
@@ -0,0 +1,337 @@
+#include "packedIntervals.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FDLANG_SIMD_INTERVALS 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FDLANG_SIMD_INTERVALS 1
+#endif
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+namespace {
+
+#ifdef FDLANG_SIMD_INTERVALS
+#if defined(__AVX2__)
+using Block = __m256i;
+const size_t Width = 32;
+
+inline Block load(const uint8_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline void store(uint8_t *p, Block x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x);
+}
+inline Block min(Block a, Block b) { return _mm256_min_epu8(a, b); }
+inline Block max(Block a, Block b) { return _mm256_max_epu8(a, b); }
+inline Block eq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+inline Block flip(Block a) {
+    return _mm256_xor_si256(a, _mm256_set1_epi8(-1));
+}
+inline uint32_t mask(Block a) { return (uint32_t)_mm256_movemask_epi8(a); }
+#else
+using Block = __m128i;
+const size_t Width = 16;
+
+inline Block load(const uint8_t *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void store(uint8_t *p, Block x) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+}
+inline Block min(Block a, Block b) { return _mm_min_epu8(a, b); }
+inline Block max(Block a, Block b) { return _mm_max_epu8(a, b); }
+inline Block eq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+inline Block flip(Block a) { return _mm_xor_si128(a, _mm_set1_epi8(-1)); }
+inline uint32_t mask(Block a) { return (uint32_t)_mm_movemask_epi8(a); }
+#endif
+const uint32_t FullMask = Width == 32 ? 0xffffffffu : 0xffffu;
+#endif
+
+// The kernels run over the 2 * BlockSize bounds of a block.
+const size_t BlockBytes = 2 * PackedIntervals::BlockSize;
+
+// out = min(a, b), or max(a, b), and whether out equals a and b
+void combine(const uint8_t *a, const uint8_t *b, uint8_t *out, bool takeMin,
+             bool &isA, bool &isB) {
+#ifdef FDLANG_SIMD_INTERVALS
+    uint32_t sameA = FullMask, sameB = FullMask;
+    for (size_t i = 0; i < BlockBytes; i += Width) {
+        Block x = load(a + i), y = load(b + i);
+        Block m = takeMin ? min(x, y) : max(x, y);
+        sameA &= mask(eq(m, x));
+        sameB &= mask(eq(m, y));
+        store(out + i, m);
+    }
+    isA = sameA == FullMask;
+    isB = sameB == FullMask;
+#else
+    isA = isB = true;
+    for (size_t i = 0; i < BlockBytes; i++) {
+        out[i] = takeMin ? std::min(a[i], b[i]) : std::max(a[i], b[i]);
+        isA &= out[i] == a[i];
+        isB &= out[i] == b[i];
+    }
+#endif
+}
+
+// a >= b byte-wise
+bool greaterEqual(const uint8_t *a, const uint8_t *b) {
+#ifdef FDLANG_SIMD_INTERVALS
+    for (size_t i = 0; i < BlockBytes; i += Width) {
+        Block x = load(a + i);
+        if (mask(eq(max(x, load(b + i)), x)) != FullMask)
+            return false;
+    }
+    return true;
+#else
+    for (size_t i = 0; i < BlockBytes; i++)
+        if (a[i] < b[i])
+            return false;
+    return true;
+#endif
+}
+
+// bit i set if variable i of the block is empty, l > r
+uint32_t emptyMask(const uint8_t *bounds) {
+    const uint8_t *lower = bounds;
+    const uint8_t *upper = bounds + PackedIntervals::BlockSize;
+    uint32_t ret = 0;
+#ifdef FDLANG_SIMD_INTERVALS
+    for (size_t i = 0; i < PackedIntervals::BlockSize; i += Width) {
+        Block r = flip(load(upper + i));
+        ret |= (~mask(eq(max(load(lower + i), r), r)) & FullMask) << i;
+    }
+#else
+    for (size_t i = 0; i < PackedIntervals::BlockSize; i++)
+        ret |= (uint32_t)(lower[i] > (uint8_t)~upper[i]) << i;
+#endif
+    return ret;
+}
+
+} // namespace
+
+PackedIntervals::PackedIntervals(size_t numVars, bool isInitialization)
+    : numVars(numVars) {
+    if (isInitialization)
+        assign(0, 0);
+    else
+        setBottom();
+}
+
+PackedIntervals::Block &PackedIntervals::mutableBlock(size_t i) {
+    if (blocks.use_count() > 1)
+        blocks = std::make_shared<Blocks>(*blocks);
+    std::shared_ptr<Block> &block = (*blocks)[i];
+    if (block.use_count() > 1)
+        block = std::make_shared<Block>(*block);
+    return *block;
+}
+
+void PackedIntervals::assign(uint8_t l, uint8_t r) {
+    // full blocks are all alike, only the last has padding
+    auto makeBlock = [&](size_t count) {
+        auto block = std::make_shared<Block>();
+        std::fill(std::begin(block->bounds), std::end(block->bounds), 0);
+        std::fill(block->bounds, block->bounds + count, l);
+        std::fill(block->bounds + BlockSize, block->bounds + BlockSize + count,
+                  255 - r);
+        uint32_t all = count == BlockSize ? 0xffffffffu : (1u << count) - 1;
+        block->bottom = l > r ? all : 0;
+        return block;
+    };
+    blocks = std::make_shared<Blocks>(numVars / BlockSize,
+                                      makeBlock(BlockSize));
+    if (size_t rest = numVars % BlockSize)
+        blocks->push_back(makeBlock(rest));
+}
+
+void PackedIntervals::setBottom() { assign(255, 0); }
+
+void PackedIntervals::reduce() {
+    for (size_t i = 0; i < numBlocks(); i++) {
+        if (emptyMask(getBlock(i).bounds) != 0) {
+            setBottom();
+            return;
+        }
+    }
+}
+
+void PackedIntervals::set(IR::VarId x, const Interval &value) {
+    assert(x < numVars);
+    if (isBottom())
+        return;
+    if (value.isBottom) {
+        setBottom();
+        return;
+    }
+    long long l = std::clamp(value.l, 0ll, 255ll);
+    long long r = std::clamp(value.r, 0ll, 255ll);
+    if (l > r) {
+        setBottom();
+        return;
+    }
+    size_t i = x % BlockSize;
+    const Block &block = getBlock(x / BlockSize);
+    if (block.bounds[i] == l && block.bounds[BlockSize + i] == 255 - r)
+        return;
+    Block &written = mutableBlock(x / BlockSize);
+    written.bounds[i] = l;
+    written.bounds[BlockSize + i] = 255 - r;
+}
+
+void PackedIntervals::restrict(IR::VarId x, long long l, long long r) {
+    Interval old = get(x);
+    if (old.isBottom)
+        return;
+    set(x, {std::max(old.l, l), std::min(old.r, r), false});
+}
+
+bool PackedIntervals::joinWith(const PackedIntervals &o) {
+    assert(numVars == o.numVars);
+    if (blocks == o.blocks || o.isBottom())
+        return false;
+    if (isBottom()) {
+        blocks = o.blocks;
+        return true;
+    }
+    bool changed = false;
+    Block joined;
+    for (size_t i = 0; i < numBlocks(); i++) {
+        const std::shared_ptr<Block> &other = (*o.blocks)[i];
+        if ((*blocks)[i] == other)
+            continue;
+        bool isThis, isOther;
+        combine(getBlock(i).bounds, other->bounds, joined.bounds, true,
+                isThis, isOther);
+        if (isThis)
+            continue;
+        changed = true;
+        // a side with a bottom variable was bottom as a whole
+        joined.bottom = getBlock(i).bottom & other->bottom;
+        if (isOther) {
+            if (blocks.use_count() > 1)
+                blocks = std::make_shared<Blocks>(*blocks);
+            (*blocks)[i] = other;
+        } else {
+            mutableBlock(i) = joined;
+        }
+    }
+    // a join that took every block of `o' can take its list too
+    if (changed && shares(o))
+        blocks = o.blocks;
+    return changed;
+}
+
+bool PackedIntervals::widenWith(const PackedIntervals &o,
+                                const std::vector<uint8_t> &thresholds) {
+    assert(numVars == o.numVars);
+    if (isBottom())
+        return joinWith(o);
+    if (o.isBottom() || blocks == o.blocks)
+        return false;
+    // only loop heads widen, so a scalar pass will do
+    auto first = thresholds.begin(), last = thresholds.end();
+    bool changed = false;
+    for (IR::VarId x = 0; x < numVars; x++) {
+        size_t i = x % BlockSize;
+        const Block &block = getBlock(x / BlockSize);
+        const Block &other = o.getBlock(x / BlockSize);
+        if (&block == &other)
+            continue;
+        uint8_t l = block.bounds[i], u = block.bounds[BlockSize + i];
+        if (other.bounds[i] < l)
+            l = *(std::upper_bound(first, last, other.bounds[i]) - 1);
+        if (other.bounds[BlockSize + i] < u) {
+            uint8_t r = 255 - other.bounds[BlockSize + i];
+            u = 255 - *std::lower_bound(first, last, r);
+        }
+        if (l == block.bounds[i] && u == block.bounds[BlockSize + i])
+            continue;
+        Block &written = mutableBlock(x / BlockSize);
+        written.bounds[i] = l;
+        written.bounds[BlockSize + i] = u;
+        changed = true;
+    }
+    return changed;
+}
+
+PackedIntervals PackedIntervals::meet(const PackedIntervals &o) const {
+    assert(numVars == o.numVars);
+    PackedIntervals ret = *this;
+    if (blocks == o.blocks)
+        return ret;
+    Block met;
+    for (size_t i = 0; i < numBlocks(); i++) {
+        const std::shared_ptr<Block> &other = (*o.blocks)[i];
+        if ((*blocks)[i] == other)
+            continue;
+        bool isThis, isOther;
+        combine(getBlock(i).bounds, other->bounds, met.bounds, false, isThis,
+                isOther);
+        if (isThis)
+            continue;
+        met.bottom = getBlock(i).bottom | other->bottom;
+        if (isOther) {
+            if (ret.blocks.use_count() > 1)
+                ret.blocks = std::make_shared<Blocks>(*ret.blocks);
+            (*ret.blocks)[i] = other;
+        } else {
+            ret.mutableBlock(i) = met;
+        }
+    }
+    ret.reduce();
+    return ret;
+}
+
+bool PackedIntervals::leq(const PackedIntervals &o) const {
+    assert(numVars == o.numVars);
+    // bytes grow as intervals shrink, up to bottom which is all ones
+    for (size_t i = 0; i < numBlocks(); i++)
+        if ((*blocks)[i] != (*o.blocks)[i] &&
+            !greaterEqual(getBlock(i).bounds, o.getBlock(i).bounds))
+            return false;
+    return true;
+}
+
+bool PackedIntervals::shares(const PackedIntervals &o) const {
+    if (blocks == o.blocks)
+        return true;
+    if (numVars != o.numVars)
+        return false;
+    for (size_t i = 0; i < numBlocks(); i++)
+        if ((*blocks)[i] != (*o.blocks)[i])
+            return false;
+    return true;
+}
+
+bool PackedIntervals::operator==(const PackedIntervals &o) const {
+    if (numVars != o.numVars)
+        return false;
+    for (size_t i = 0; i < numBlocks(); i++) {
+        const Block &a = getBlock(i), &b = o.getBlock(i);
+        if (&a != &b && (a.bottom != b.bottom ||
+                         !std::equal(std::begin(a.bounds), std::end(a.bounds),
+                                     std::begin(b.bounds))))
+            return false;
+    }
+    return true;
+}
+
+void PackedIntervals::dump(std::ostream &out,
+                           const IR::VarTable &vars) const {
+    if (isBottom()) {
+        out << "; Unreachable" << std::endl;
+        return;
+    }
+    for (IR::VarId x = 1; x < numVars; x++) {
+        Interval value = get(x);
+        out << "; " << vars.getName(x) << " = [" << value.l << ", "
+            << value.r << "]" << std::endl;
+    }
+}
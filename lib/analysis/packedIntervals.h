@@ -0,0 +1,174 @@
+#ifndef ANALYSIS_PACKEDINTERVALS_H
+#define ANALYSIS_PACKEDINTERVALS_H
+
+#include "IR/IR.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace fdlang::analysis {
+
+struct Interval {
+    long long l = 0, r = 0;
+    bool isBottom = true;
+    bool operator==(const Interval &o) const {
+        if (isBottom != o.isBottom)
+            return false;
+        if (isBottom == true)
+            return true;
+        return l == o.l && r == o.r;
+    }
+};
+
+/**
+ * @brief [a.l + b.l, a.r + b.r], saturated at 255 as the program's `+' is
+ */
+inline Interval saturatingAdd(const Interval &a, const Interval &b) {
+    if (a.isBottom || b.isBottom)
+        return Interval();
+    return {std::min(255ll, a.l + b.l), std::min(255ll, a.r + b.r), false};
+}
+
+/**
+ * @brief [a.l - b.r, a.r - b.l], saturated at 0 as the program's `-' is
+ */
+inline Interval saturatingSub(const Interval &a, const Interval &b) {
+    if (a.isBottom || b.isBottom)
+        return Interval();
+    return {std::max(0ll, a.l - b.r), std::max(0ll, a.r - b.l), false};
+}
+
+/**
+ * An interval for every variable of a function. All values a program can
+ * compute are in [0, 255], so a bound fits a byte. Variables are grouped in
+ * blocks of 32, each holding their lower bounds and their complemented upper
+ * bounds, 255 - r. Join is then a byte-wise minimum and meet a byte-wise
+ * maximum, 32 variables per instruction with AVX2 (16 with SSE2).
+ *
+ * A bottom variable is stored as [255, 0], which both operations absorb,
+ * and flagged in the bit mask of its block. No environment satisfies a
+ * state with a bottom variable, so whenever one appears the whole state
+ * becomes bottom.
+ *
+ * States are copy-on-write at two levels: copies share the list of blocks
+ * and the blocks themselves until one of them writes. Setting a variable
+ * copies one block and the list of pointers to blocks, and lattice
+ * operations skip blocks both sides share, or share the other side's block
+ * when the result equals it.
+ */
+class PackedIntervals {
+public:
+    static constexpr size_t BlockSize = 32;
+
+private:
+    struct Block {
+        // lower bounds at [0, BlockSize), complemented upper bounds at
+        // [BlockSize, 2 * BlockSize); padding is [0, 255] so it never
+        // reads as bottom
+        alignas(32) uint8_t bounds[2 * BlockSize];
+        uint32_t bottom;
+    };
+    using Blocks = std::vector<std::shared_ptr<Block>>;
+
+    size_t numVars = 0;
+    // shared with copies; a shared list or block is never written
+    std::shared_ptr<Blocks> blocks;
+
+    size_t numBlocks() const {
+        return (numVars + BlockSize - 1) / BlockSize;
+    }
+
+    const Block &getBlock(size_t i) const { return *(*blocks)[i]; }
+
+    // the block, copied first if another state shares it
+    Block &mutableBlock(size_t i);
+
+    // set every variable to [l, r], or bottom if l > r
+    void assign(uint8_t l, uint8_t r);
+
+    // make the state bottom if any variable is
+    void reduce();
+
+public:
+    PackedIntervals() = default;
+
+    /**
+     * @brief Construct a state over `numVars' variables
+     *
+     * @param isInitialization true for initialization (all zero) and false
+     * for bottom
+     */
+    PackedIntervals(size_t numVars, bool isInitialization);
+
+    size_t size() const { return numVars; }
+
+    bool isBottom() const {
+        // a bottom variable makes every block bottom
+        return numVars > 0 && getBlock(0).bottom != 0;
+    }
+
+    void setBottom();
+
+    Interval get(IR::VarId x) const {
+        if (isBottom())
+            return Interval();
+        const Block &block = getBlock(x / BlockSize);
+        size_t i = x % BlockSize;
+        return {block.bounds[i], 255 - block.bounds[BlockSize + i], false};
+    }
+
+    /**
+     * @brief Set `x' to `value' clamped to [0, 255], leaving a bottom state
+     * bottom
+     */
+    void set(IR::VarId x, const Interval &value);
+
+    /**
+     * @brief Intersect `x' with [l, r]
+     */
+    void restrict(IR::VarId x, long long l, long long r);
+
+    /**
+     * @brief Join `o' into `*this'
+     *
+     * @return whether `*this' changed
+     */
+    bool joinWith(const PackedIntervals &o);
+
+    /**
+     * @brief Join `o' into `*this', moving every bound that grows out to the
+     * nearest of `thresholds', which are sorted and hold 0 and 255
+     *
+     * @return whether `*this' changed
+     */
+    bool widenWith(const PackedIntervals &o,
+                   const std::vector<uint8_t> &thresholds);
+
+    /**
+     * @brief Get the greatest lower bound of `*this' and `o'
+     */
+    PackedIntervals meet(const PackedIntervals &o) const;
+
+    /**
+     * @brief Test if `*this' is less or equal than `o' in partial order <=
+     */
+    bool leq(const PackedIntervals &o) const;
+
+    /**
+     * @brief Whether `*this' and `o' share all their blocks
+     */
+    bool shares(const PackedIntervals &o) const;
+
+    bool operator==(const PackedIntervals &o) const;
+
+    bool operator!=(const PackedIntervals &o) const { return !(*this == o); }
+
+    void dump(std::ostream &out, const IR::VarTable &vars) const;
+};
+
+} // namespace fdlang::analysis
+
+#endif
@@ -1,12 +1,15 @@
 #include "relationalNumericalAnalysis.h"
 
 #include "IR/IR.h"
+#include "IR/CSRGraph.h"
+#include "IR/basicBlock.h"
+#include "IR/loopForest.h"
+#include "IR/weakTopologicalOrder.h"
 
 #include <algorithm>
 #include <array>
 #include <memory>
 #include <queue>
-#include <unordered_set>
 #include <vector>
 
 using namespace fdlang;
@@ -35,134 +38,134 @@ RelationalNumericalAnalysis::transferIdentity(const IR::Inst *inst,
     return input;
 }
 
-bool RelationalNumericalAnalysis::joinInto(const States &x, States &y) {
-    States before = y;
-
-    y = x.lub(y);
+RelationalNumericalAnalysis::States
+RelationalNumericalAnalysis::transfer(const IR::Inst *inst, States &input) {
+    switch (inst->getInstType()) {
+    case IR::InstType::AddInst:
+    case IR::InstType::SubInst:
+    case IR::InstType::AssignInst:
+    case IR::InstType::InputInst:
+        return transferAssignment(inst, input);
+    case IR::InstType::CheckIntervalInst:
+    case IR::InstType::LabelInst:
+    case IR::InstType::GotoInst:
+        return transferIdentity(inst, input);
+    default:
+        assert(false);
+    }
+    return input;
+}
 
-    return !before.eq(y);
+bool RelationalNumericalAnalysis::joinInto(const States &x, States &y) {
+    return y.joinWith(x);
 }
 
 void RelationalNumericalAnalysis::run() {
 
-    // 1. 收集变量名
-    std::unordered_set<std::string> varsSet;
-    for (auto inst : insts) {
-        for (int i = 0; i < inst->getOperandSize(); i++) {
-            if (!inst->getOperand(i)->isVariable())
-                continue;
-            varsSet.insert(inst->getOperand(i)->getAsVariable());
-        }
-    }
-    std::vector<std::string> vars(varsSet.begin(), varsSet.end());
-
-    // 2. 为所有 label 建立映射，并找到 entryLabel / maxLabel
-    std::map<size_t, IR::Inst*> label2Inst;
-    size_t maxLabel = 0;
-    size_t entryLabel = (size_t)-1;
-
-    for (auto inst : insts) {
-        size_t label = inst->getLabel();
-        label2Inst[label] = inst;
-        maxLabel = std::max(maxLabel, label);
-        entryLabel = std::min(entryLabel, label);
-    }
+    // 1. 划分基本块，状态只保存在基本块入口；worklist 只读 CSR 形式的边
+    IR::BlockGraph graph(funcs[0]);
+    IR::CSRGraph cfg = IR::CSRGraph::fromBlocks(graph);
 
-    // 3. 初始化各个程序点的状态
+    // 2. 初始化各个基本块的入口状态，变量编号取自函数的变量表
+    const IR::VarTable &vars = funcs[0]->getVars();
     States initState(vars, true), bottomState(vars, false);
-    for (auto inst : insts) {
-        size_t label = inst->getLabel();
-        if (label == entryLabel)
-            inputStates[label] = initState;
-        else
-            inputStates[label] = bottomState;
-    }
+    inputStates.assign(graph.size(), bottomState);
+    inputStates[graph.getEntry()->getId()] = initState;
 
-    // 4. Worklist 算法
-    std::vector<bool> inQueue(maxLabel + 1, false); 
+    // 3. Worklist 算法；pending 标记入口状态自上次访问后变化过的基本块
+    IR::NodeId entry = graph.getEntry()->getId();
+    std::vector<bool> pending(graph.size(), false);
     std::queue<size_t> q;
-    q.push(entryLabel);
-    inQueue[entryLabel] = true;
-
-    auto tryToEnqueue = [&](const States &outputState, const size_t succLabel) {
-        if (joinInto(outputState, inputStates[succLabel]) && !inQueue[succLabel]) {
-            inQueue[succLabel] = true;
-            q.push(succLabel);
+    pending[entry] = true;
+    iterations = 0;
+
+    auto tryToEnqueue = [&](const States &outputState, IR::NodeId id) {
+        if (joinInto(outputState, inputStates[id]) && !pending[id]) {
+            pending[id] = true;
+            // 按弱拓扑序迭代时不用队列，轮到它时再访问
+            if (strategy == IterationStrategy::FIFO)
+                q.push(id);
         }
     };
 
-    while (!q.empty()) {
-        size_t nowLabel = q.front();
-        q.pop();
-        inQueue[nowLabel] = false;
+    auto visit = [&](size_t nowBlock) {
+        if (!pending[nowBlock])
+            return;
+        pending[nowBlock] = false;
+        iterations++;
 
-        // 用 label 查 Inst，而不是 insts[nowLabel]
-        IR::Inst *inst = label2Inst[nowLabel];
-        States &inputState = inputStates[nowLabel];
-        States outputState;
+        IR::BasicBlock *block = graph.getBlock(nowBlock);
+        IR::CSRGraph::NodeRange successors = cfg.successors(nowBlock);
+        States outputState = inputStates[nowBlock];
+        const IR::Insts &blockInsts = block->getInsts();
 
-        if (inst->getInstType() == IR::InstType::IfInst) {
-            IR::IfInst *ifInst = (IR::IfInst *)inst;
-            size_t succ;
+        // 只有最后一条指令可能是分支
+        IR::Inst *last = block->back();
+        for (size_t i = 0; i + 1 < blockInsts.size(); i++)
+            outputState = transfer(blockInsts[i], outputState);
+
+        if (last->getInstType() == IR::InstType::IfInst) {
+            IR::IfInst *ifInst = (IR::IfInst *)last;
+            States branchState;
 
             // false branch
-            outputState = transferIfStmt(ifInst, inputState, false);
-            succ = ifInst->getSuccessors()[0]->getLabel();
-            if (!outputState.isEmpty())
-                tryToEnqueue(outputState, succ);
+            branchState = transferIfStmt(ifInst, outputState, false);
+            if (!branchState.isEmpty())
+                tryToEnqueue(branchState, successors[0]);
 
             // true branch
-            outputState = transferIfStmt(ifInst, inputState, true);
-            succ = ifInst->getSuccessors()[1]->getLabel();
-            if (!outputState.isEmpty())
-                tryToEnqueue(outputState, succ);
+            branchState = transferIfStmt(ifInst, outputState, true);
+            if (!branchState.isEmpty())
+                tryToEnqueue(branchState, successors[1]);
 
-            continue;
+            return;
         }
 
-        switch (inst->getInstType()) {
-        case IR::InstType::AddInst:
-        case IR::InstType::SubInst:
-        case IR::InstType::AssignInst:
-        case IR::InstType::InputInst:
-            outputState = transferAssignment(inst, inputState);
-            break;
-        case IR::InstType::CheckIntervalInst:
-        case IR::InstType::LabelInst:
-        case IR::InstType::GotoInst:
-            outputState = transferIdentity(inst, inputState);
-            break;
-        default:
-            assert(false);
-        }
+        outputState = transfer(last, outputState);
+        if (!successors.empty())
+            tryToEnqueue(outputState, successors[0]);
+    };
 
-        if (!inst->getSuccessors().empty()) {
-            size_t succ = inst->getSuccessors()[0]->getLabel();
-            tryToEnqueue(outputState, succ);
+    if (strategy == IterationStrategy::WTO) {
+        // 先让内层循环稳定，再回到外层循环头
+        IR::LoopForest loops(cfg, entry);
+        IR::WeakTopologicalOrder wto(cfg, loops, entry);
+        wto.iterate(visit, [&](IR::NodeId head) { return !pending[head]; });
+    } else {
+        q.push(entry);
+        while (!q.empty()) {
+            size_t nowBlock = q.front();
+            q.pop();
+            visit(nowBlock);
         }
     }
 
-    // 5. 回答 CheckIntervalInst 查询
-    for (auto inst : insts) {
-        if (inst->getInstType() != IR::InstType::CheckIntervalInst)
-            continue;
-        IR::CheckIntervalInst *checkInst = (IR::CheckIntervalInst *)inst;
-        std::string variable = checkInst->getOperand(0)->getAsVariable();
-        long long l = checkInst->getOperand(1)->getAsNumber();
-        long long r = checkInst->getOperand(2)->getAsNumber();
-
-        size_t label = checkInst->getLabel();
+    // 4. 回答 CheckIntervalInst 查询，从基本块入口重放到查询处
+    for (size_t id = 0; id < graph.size(); id++) {
+        IR::BasicBlock *block = graph.getBlock(id);
+        States state = inputStates[id];
+        for (IR::Inst *inst : block->getInsts()) {
+            if (inst->getInstType() == IR::InstType::IfInst)
+                break;
+            if (inst->getInstType() != IR::InstType::CheckIntervalInst) {
+                state = transfer(inst, state);
+                continue;
+            }
+            IR::CheckIntervalInst *checkInst = (IR::CheckIntervalInst *)inst;
+            IR::VarId variable = checkInst->getOperand(0)->getVarId();
+            long long l = checkInst->getOperand(1)->getAsNumber();
+            long long r = checkInst->getOperand(2)->getAsNumber();
+
+            if (state.isEmpty()) {
+                results[checkInst] = ResultType::UNREACHABLE;
+                continue;
+            }
 
-        if (inputStates[label].isEmpty()) {
-            results[checkInst] = ResultType::UNREACHABLE;
-            continue;
+            IntervalDomain interval = state.projection(variable);
+            if (l <= interval.l && interval.r <= r)
+                results[checkInst] = ResultType::YES;
+            else
+                results[checkInst] = ResultType::NO;
         }
-
-        IntervalDomain interval =
-            inputStates[label].projection(variable);
-        if (l <= interval.l && interval.r <= r)
-            results[checkInst] = ResultType::YES;
-        else
-            results[checkInst] = ResultType::NO;
     }
 }
@@ -49,12 +49,14 @@ public:
 private:
     using States = ZoneDomain;
 
-    // label -> states
-    std::map<size_t, States> inputStates;
+    // block id -> states on entry to the block
+    std::vector<States> inputStates;
 
     States transferAssignment(const IR::Inst *inst, States &input);
     States transferIdentity(const IR::Inst *inst, States &input);
     States transferIfStmt(const IR::IfInst *inst, States &input, bool branch);
+    // any instruction but IfInst
+    States transfer(const IR::Inst *inst, States &input);
 
     // x join into y
     bool joinInto(const States &x, States &y);
@@ -0,0 +1,108 @@
+#include "valueSetAnalysis.h"
+
+#include <algorithm>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+ValueSetAnalysis::ResultType ValueSetAnalysis::check(const States &state,
+                                                    IR::VarId x, long long l,
+                                                    long long r) {
+    ValueSet values = state.get(x);
+    if (values.empty())
+        return ResultType::UNREACHABLE;
+    if (values.subsetOf(ValueSet::range(l, r)))
+        return ResultType::YES;
+    return ResultType::NO;
+}
+
+ValueSetAnalysis::States ValueSetAnalysis::iniStates() {
+    IR::Function *function = funcs[0];
+    States ret(function->getVars().size(), true);
+    if (!function->isRoot())
+        for (IR::Value *arg : function->getArgs())
+            ret.set(arg->getVarId(), ValueSet::range(0, 255));
+    return ret;
+}
+
+ValueSetAnalysis::States ValueSetAnalysis::transfer(IR::Inst *inst,
+                                                    const States &input) {
+    if (input.isBottom())
+        return input;
+    auto value = [&](IR::Value *operand) -> ValueSet {
+        // a constant is clamped as an interval's bounds are
+        if (operand->isNumber())
+            return ValueSet::single(
+                std::clamp(operand->getAsNumber(), 0ll, 255ll));
+        return input.get(operand->getVarId());
+    };
+
+    States output = input;
+    switch (inst->getInstType()) {
+    case IR::InstType::AddInst: {
+        ValueSet x = value(inst->getOperand(1));
+        ValueSet y = value(inst->getOperand(2));
+        // x + c is a single shift
+        ValueSet sum = inst->getOperand(2)->isNumber()
+                           ? x.shiftUp(y.min())
+                           : saturatingAdd(x, y);
+        output.set(inst->getOperand(0)->getVarId(), sum);
+        break;
+    }
+    case IR::InstType::SubInst: {
+        ValueSet x = value(inst->getOperand(1));
+        ValueSet y = value(inst->getOperand(2));
+        ValueSet difference = inst->getOperand(2)->isNumber()
+                                  ? x.shiftDown(y.min())
+                                  : saturatingSub(x, y);
+        output.set(inst->getOperand(0)->getVarId(), difference);
+        break;
+    }
+    case IR::InstType::AssignInst:
+        output.set(inst->getOperand(0)->getVarId(),
+                   value(inst->getOperand(1)));
+        break;
+    case IR::InstType::InputInst:
+        output.set(inst->getOperand(0)->getVarId(), ValueSet::range(0, 255));
+        break;
+    default:
+        // arguments are passed by value, so calls change nothing here
+        break;
+    }
+    return output;
+}
+
+ValueSetAnalysis::States ValueSetAnalysis::filter(const IR::IfInst *inst,
+                                                  const States &input,
+                                                  bool branch) {
+    IR::VarId x = inst->getOperand(0)->getVarId();
+    long long c = inst->getOperand(1)->getAsNumber();
+    ValueSet mask;
+    switch (inst->getCmpOperator()) {
+    case IR::CmpOperator::EQ:
+        if (branch) {
+            mask = ValueSet::single(c);
+        } else {
+            // the hole an interval cannot keep
+            mask = ValueSet::range(0, 255);
+            if (0 <= c && c <= 255)
+                mask.erase(c);
+        }
+        break;
+    case IR::CmpOperator::GT:
+        mask = branch ? ValueSet::range(c + 1, 255) : ValueSet::range(0, c);
+        break;
+    case IR::CmpOperator::GEQ:
+        mask = branch ? ValueSet::range(c, 255) : ValueSet::range(0, c - 1);
+        break;
+    case IR::CmpOperator::LT:
+        mask = branch ? ValueSet::range(0, c - 1) : ValueSet::range(c, 255);
+        break;
+    case IR::CmpOperator::LEQ:
+        mask = branch ? ValueSet::range(0, c) : ValueSet::range(c + 1, 255);
+        break;
+    }
+    States ret = input;
+    ret.restrict(x, mask);
+    return ret;
+}
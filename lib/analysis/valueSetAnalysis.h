@@ -0,0 +1,40 @@
+#ifndef ANALYSIS_VALUESETANALYSIS_H
+#define ANALYSIS_VALUESETANALYSIS_H
+
+#include "IR/IR.h"
+#include "nonRelationalAnalysis.h"
+#include "valueSets.h"
+
+namespace fdlang::analysis {
+
+/**
+ * The non-relational analysis of IntervalAnalysis with a set of values per
+ * variable in place of an interval. The lattice is finite, so the analysis
+ * iterates to the least fixed point with neither widening nor narrowing.
+ */
+class ValueSetAnalysis : public NonRelationalAnalysis<ValueSets> {
+public:
+    ValueSetAnalysis(const IR::Functions &funcs)
+        : NonRelationalAnalysis(funcs) {}
+
+    /**
+     * @brief the states on entry to the function: every variable is zero
+     * and, unless the function is a root, the arguments are unknown
+     */
+    States iniStates() override;
+
+    States transfer(IR::Inst *inst, const States &input) override;
+
+    /**
+     * @brief the states of the `branch' successor of `inst'
+     */
+    States filter(const IR::IfInst *inst, const States &input,
+                  bool branch) override;
+
+private:
+    ResultType check(const States &state, IR::VarId x, long long l,
+                     long long r) override;
+};
+
+} // namespace fdlang::analysis
+#endif
@@ -0,0 +1,305 @@
+#include "valueSets.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FDLANG_SIMD_VALUESETS 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FDLANG_SIMD_VALUESETS 1
+#endif
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+namespace {
+
+#ifdef FDLANG_SIMD_VALUESETS
+#if defined(__AVX2__)
+using Lane = __m256i;
+// words of a set per register
+const size_t LaneWords = 4;
+
+inline Lane load(const uint64_t *p) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline void store(uint64_t *p, Lane x) {
+    _mm256_store_si256(reinterpret_cast<__m256i *>(p), x);
+}
+inline Lane either(Lane a, Lane b) { return _mm256_or_si256(a, b); }
+inline Lane both(Lane a, Lane b) { return _mm256_and_si256(a, b); }
+// a has no bit outside b
+inline bool within(Lane a, Lane b) { return _mm256_testc_si256(b, a); }
+inline bool same(Lane a, Lane b) {
+    Lane x = _mm256_xor_si256(a, b);
+    return _mm256_testz_si256(x, x);
+}
+#else
+using Lane = __m128i;
+const size_t LaneWords = 2;
+
+inline Lane load(const uint64_t *p) {
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void store(uint64_t *p, Lane x) {
+    _mm_store_si128(reinterpret_cast<__m128i *>(p), x);
+}
+inline Lane either(Lane a, Lane b) { return _mm_or_si128(a, b); }
+inline Lane both(Lane a, Lane b) { return _mm_and_si128(a, b); }
+inline bool same(Lane a, Lane b) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xffff;
+}
+inline bool within(Lane a, Lane b) { return same(either(a, b), b); }
+#endif
+#endif
+
+// dst |= src, and whether dst changed
+inline bool orInto(ValueSet &dst, const ValueSet &src) {
+    bool changed = false;
+#ifdef FDLANG_SIMD_VALUESETS
+    for (size_t i = 0; i < 4; i += LaneWords) {
+        Lane x = load(dst.words + i), y = load(src.words + i);
+        if (!within(y, x)) {
+            changed = true;
+            store(dst.words + i, either(x, y));
+        }
+    }
+#else
+    for (size_t i = 0; i < 4; i++) {
+        changed |= (src.words[i] & ~dst.words[i]) != 0;
+        dst.words[i] |= src.words[i];
+    }
+#endif
+    return changed;
+}
+
+// calls f(v) for every value v of `set', in increasing order
+template <typename F> void forEach(const ValueSet &set, F f) {
+    for (unsigned i = 0; i < 4; i++)
+        for (uint64_t word = set.words[i]; word != 0; word &= word - 1)
+            f(64 * i + __builtin_ctzll(word));
+}
+
+} // namespace
+
+ValueSet ValueSet::range(long long l, long long r) {
+    ValueSet ret;
+    l = std::max(l, 0ll);
+    r = std::min(r, 255ll);
+    for (long long i = 0; i < 4; i++) {
+        long long lo = std::max(l, 64 * i), hi = std::min(r, 64 * i + 63);
+        if (lo > hi)
+            continue;
+        uint64_t bits = hi - lo == 63 ? ~0ull : (1ull << (hi - lo + 1)) - 1;
+        ret.words[i] = bits << (lo - 64 * i);
+    }
+    return ret;
+}
+
+size_t ValueSet::count() const {
+    size_t ret = 0;
+    for (uint64_t word : words)
+        ret += __builtin_popcountll(word);
+    return ret;
+}
+
+unsigned ValueSet::min() const {
+    assert(!empty());
+    unsigned i = 0;
+    while (words[i] == 0)
+        i++;
+    return 64 * i + __builtin_ctzll(words[i]);
+}
+
+unsigned ValueSet::max() const {
+    assert(!empty());
+    unsigned i = 3;
+    while (words[i] == 0)
+        i--;
+    return 64 * i + 63 - __builtin_clzll(words[i]);
+}
+
+ValueSet ValueSet::shiftUp(unsigned c) const {
+    if (c == 0 || empty())
+        return *this;
+    if (c >= 255)
+        return single(255);
+    // the values that saturate
+    bool overflows = !(*this & range(256 - c, 255)).empty();
+    ValueSet ret;
+    unsigned q = c / 64, r = c % 64;
+    for (unsigned i = q; i < 4; i++) {
+        ret.words[i] = words[i - q] << r;
+        if (r != 0 && i > q)
+            ret.words[i] |= words[i - q - 1] >> (64 - r);
+    }
+    if (overflows)
+        ret.insert(255);
+    return ret;
+}
+
+ValueSet ValueSet::shiftDown(unsigned c) const {
+    if (c == 0 || empty())
+        return *this;
+    if (c >= 255)
+        return single(0);
+    bool underflows = !(*this & range(0, c)).empty();
+    ValueSet ret;
+    unsigned q = c / 64, r = c % 64;
+    for (unsigned i = 0; i + q < 4; i++) {
+        ret.words[i] = words[i + q] >> r;
+        if (r != 0 && i + q + 1 < 4)
+            ret.words[i] |= words[i + q + 1] << (64 - r);
+    }
+    if (underflows)
+        ret.insert(0);
+    return ret;
+}
+
+ValueSet ValueSet::operator|(const ValueSet &o) const {
+    ValueSet ret;
+#ifdef FDLANG_SIMD_VALUESETS
+    for (size_t i = 0; i < 4; i += LaneWords)
+        store(ret.words + i, either(load(words + i), load(o.words + i)));
+#else
+    for (size_t i = 0; i < 4; i++)
+        ret.words[i] = words[i] | o.words[i];
+#endif
+    return ret;
+}
+
+ValueSet ValueSet::operator&(const ValueSet &o) const {
+    ValueSet ret;
+#ifdef FDLANG_SIMD_VALUESETS
+    for (size_t i = 0; i < 4; i += LaneWords)
+        store(ret.words + i, both(load(words + i), load(o.words + i)));
+#else
+    for (size_t i = 0; i < 4; i++)
+        ret.words[i] = words[i] & o.words[i];
+#endif
+    return ret;
+}
+
+bool ValueSet::subsetOf(const ValueSet &o) const {
+#ifdef FDLANG_SIMD_VALUESETS
+    for (size_t i = 0; i < 4; i += LaneWords)
+        if (!within(load(words + i), load(o.words + i)))
+            return false;
+    return true;
+#else
+    for (size_t i = 0; i < 4; i++)
+        if ((words[i] & ~o.words[i]) != 0)
+            return false;
+    return true;
+#endif
+}
+
+bool ValueSet::operator==(const ValueSet &o) const {
+#ifdef FDLANG_SIMD_VALUESETS
+    for (size_t i = 0; i < 4; i += LaneWords)
+        if (!same(load(words + i), load(o.words + i)))
+            return false;
+    return true;
+#else
+    return std::equal(std::begin(words), std::end(words),
+                      std::begin(o.words));
+#endif
+}
+
+ValueSet fdlang::analysis::saturatingAdd(const ValueSet &x,
+                                         const ValueSet &y) {
+    // shift the larger side by each value of the smaller one
+    const ValueSet &shifted = x.count() >= y.count() ? x : y;
+    const ValueSet &by = &shifted == &x ? y : x;
+    ValueSet ret;
+    forEach(by, [&](unsigned b) { orInto(ret, shifted.shiftUp(b)); });
+    return ret;
+}
+
+ValueSet fdlang::analysis::saturatingSub(const ValueSet &x,
+                                         const ValueSet &y) {
+    ValueSet ret;
+    forEach(y, [&](unsigned b) { orInto(ret, x.shiftDown(b)); });
+    return ret;
+}
+
+ValueSets::ValueSets(size_t numVars, bool isInitialization)
+    : sets(numVars, isInitialization ? ValueSet::single(0) : ValueSet()),
+      bottom(!isInitialization) {}
+
+void ValueSets::set(IR::VarId x, const ValueSet &value) {
+    assert(x < sets.size());
+    if (bottom)
+        return;
+    if (value.empty())
+        bottom = true;
+    else
+        sets[x] = value;
+}
+
+void ValueSets::restrict(IR::VarId x, const ValueSet &mask) {
+    if (!bottom)
+        set(x, sets[x] & mask);
+}
+
+bool ValueSets::joinWith(const ValueSets &o) {
+    assert(sets.size() == o.sets.size());
+    if (o.bottom)
+        return false;
+    if (bottom) {
+        *this = o;
+        return true;
+    }
+    bool changed = false;
+    for (size_t i = 0; i < sets.size(); i++)
+        changed |= orInto(sets[i], o.sets[i]);
+    return changed;
+}
+
+bool ValueSets::leq(const ValueSets &o) const {
+    assert(sets.size() == o.sets.size());
+    if (bottom || o.bottom)
+        return bottom;
+    for (size_t i = 0; i < sets.size(); i++)
+        if (!sets[i].subsetOf(o.sets[i]))
+            return false;
+    return true;
+}
+
+bool ValueSets::operator==(const ValueSets &o) const {
+    if (sets.size() != o.sets.size() || bottom != o.bottom)
+        return false;
+    return bottom || sets == o.sets;
+}
+
+void ValueSets::dump(std::ostream &out, const IR::VarTable &vars) const {
+    if (bottom) {
+        out << "; Unreachable" << std::endl;
+        return;
+    }
+    for (IR::VarId x = 1; x < sets.size(); x++) {
+        out << "; " << vars.getName(x) << " = {";
+        // runs of consecutive values as l..r
+        const char *separator = "";
+        int first = -1, last = -1;
+        auto flush = [&]() {
+            if (first < 0)
+                return;
+            out << separator << first;
+            if (last > first)
+                out << ".." << last;
+            separator = ", ";
+        };
+        forEach(sets[x], [&](unsigned v) {
+            if ((int)v != last + 1 || first < 0) {
+                flush();
+                first = v;
+            }
+            last = v;
+        });
+        flush();
+        out << "}" << std::endl;
+    }
+}
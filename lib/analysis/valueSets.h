@@ -0,0 +1,149 @@
+#ifndef ANALYSIS_VALUESETS_H
+#define ANALYSIS_VALUESETS_H
+
+#include "IR/IR.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace fdlang::analysis {
+
+/**
+ * A set of values in [0, 255], value v being bit v % 64 of words[v / 64].
+ * The 256 bits fill one AVX2 register, so union and intersection are one
+ * instruction each.
+ */
+struct ValueSet {
+    alignas(32) uint64_t words[4] = {0, 0, 0, 0};
+
+    /**
+     * @brief The values of [l, r] within [0, 255], empty if l > r
+     */
+    static ValueSet range(long long l, long long r);
+
+    static ValueSet single(long long v) { return range(v, v); }
+
+    bool empty() const {
+        return (words[0] | words[1] | words[2] | words[3]) == 0;
+    }
+
+    bool contains(unsigned v) const { return words[v / 64] >> v % 64 & 1; }
+
+    void insert(unsigned v) { words[v / 64] |= 1ull << v % 64; }
+
+    void erase(unsigned v) { words[v / 64] &= ~(1ull << v % 64); }
+
+    size_t count() const;
+
+    /**
+     * @brief The least value of a non-empty set
+     */
+    unsigned min() const;
+
+    /**
+     * @brief The greatest value of a non-empty set
+     */
+    unsigned max() const;
+
+    /**
+     * @brief {min(v + c, 255) | v in *this}, the program's `x = y + c'
+     */
+    ValueSet shiftUp(unsigned c) const;
+
+    /**
+     * @brief {max(v - c, 0) | v in *this}, the program's `x = y - c'
+     */
+    ValueSet shiftDown(unsigned c) const;
+
+    ValueSet operator|(const ValueSet &o) const;
+
+    ValueSet operator&(const ValueSet &o) const;
+
+    bool subsetOf(const ValueSet &o) const;
+
+    bool operator==(const ValueSet &o) const;
+
+    bool operator!=(const ValueSet &o) const { return !(*this == o); }
+};
+
+/**
+ * @brief {min(a + b, 255) | a in x, b in y}, a union of shifts of one side
+ * by each value of the other
+ */
+ValueSet saturatingAdd(const ValueSet &x, const ValueSet &y);
+
+/**
+ * @brief {max(a - b, 0) | a in x, b in y}
+ */
+ValueSet saturatingSub(const ValueSet &x, const ValueSet &y);
+
+/**
+ * The set of values of every variable of a function. Unlike an interval, a
+ * set keeps the holes a branch cuts, such as x != c, so the answers are the
+ * exact non-relational ones; and since the lattice is finite no widening
+ * is needed. Lattice operations over whole states run a register per
+ * variable with AVX2 (two with SSE2).
+ *
+ * No environment satisfies a state with an empty variable, so whenever one
+ * appears the whole state becomes bottom.
+ */
+class ValueSets {
+private:
+    std::vector<ValueSet> sets;
+    bool bottom = true;
+
+public:
+    ValueSets() = default;
+
+    /**
+     * @brief Construct a state over `numVars' variables
+     *
+     * @param isInitialization true for initialization (all zero) and false
+     * for bottom
+     */
+    ValueSets(size_t numVars, bool isInitialization);
+
+    size_t size() const { return sets.size(); }
+
+    bool isBottom() const { return bottom; }
+
+    void setBottom() { bottom = true; }
+
+    /**
+     * @brief The values of `x', empty in a bottom state
+     */
+    ValueSet get(IR::VarId x) const { return bottom ? ValueSet() : sets[x]; }
+
+    /**
+     * @brief Set `x' to `value', leaving a bottom state bottom
+     */
+    void set(IR::VarId x, const ValueSet &value);
+
+    /**
+     * @brief Intersect `x' with `mask'
+     */
+    void restrict(IR::VarId x, const ValueSet &mask);
+
+    /**
+     * @brief Join `o' into `*this'
+     *
+     * @return whether `*this' changed
+     */
+    bool joinWith(const ValueSets &o);
+
+    /**
+     * @brief Test if `*this' is less or equal than `o' in partial order <=
+     */
+    bool leq(const ValueSets &o) const;
+
+    bool operator==(const ValueSets &o) const;
+
+    bool operator!=(const ValueSets &o) const { return !(*this == o); }
+
+    void dump(std::ostream &out, const IR::VarTable &vars) const;
+};
+
+} // namespace fdlang::analysis
+
+#endif
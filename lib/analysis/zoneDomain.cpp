@@ -11,20 +11,13 @@ const long long ZoneDomain::INF = 0x3f3f3f3f;
 /**
  * @brief Construct a new Zone Domain
  *
- * @param vars names of appeared variables
+ * @param vars variables of the analysed function, which must outlive the zone
  * @param isInitialization true for initialization(all zero) and false for
  * bottom
  */
-ZoneDomain::ZoneDomain(const std::vector<std::string> &vars,
-                       bool isInitialization) {
-    _id_to_var.push_back("");
-    _var_to_id[""] = 0;
-    for (size_t i = 0; i < vars.size(); i++) {
-        size_t id = i + 1;
-        _id_to_var.push_back(vars[i]);
-        _var_to_id[vars[i]] = id;
-    }
-    n = _id_to_var.size();
+ZoneDomain::ZoneDomain(const IR::VarTable &vars, bool isInitialization)
+    : _vars(&vars) {
+    n = _vars->size();
     for (size_t i = 0; i < n; i++)
         _dbm.emplace_back(n, INF);
     if (isInitialization) {
@@ -44,18 +37,18 @@ void ZoneDomain::dump(std::ostream &out) const {
     }
 
     for (int i = 1; i < n; i++) {
-        std::string x = getVar(i);
-        IntervalDomain interval = this->projection(x);
+        std::string_view x = _vars->getName(i);
+        IntervalDomain interval = this->projection(i);
         out << "; " << x << " = [" << interval.l << ", " << interval.r << "]"
             << std::endl;
     }
 
     for (int i = 1; i < n; i++) {
-        std::string x = getVar(i);
+        std::string_view x = _vars->getName(i);
         for (int j = 1; j < n; j++) {
             if (i == j)
                 continue;
-            std::string y = getVar(j);
+            std::string_view y = _vars->getName(j);
             long long c = _dbm[i][j];
             if (c >= INF)
                 continue;
@@ -72,19 +65,31 @@ void ZoneDomain::dump(std::ostream &out) const {
  */
 ZoneDomain ZoneDomain::normalize() const {
     ZoneDomain ret = *this;
+    ret.close();
+    return ret;
+}
 
-    // todo: Floyd (about 4 lines)
+void ZoneDomain::close() {
+    for (size_t k = 0; k < n; k++)
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                _dbm[i][j] = std::min(_dbm[i][j], _dbm[i][k] + _dbm[k][j]);
+}
 
-    return ret;
+bool ZoneDomain::isNormalized() const {
+    // bottom never becomes normal, as its closure keeps decreasing
+    return isEmpty() || eq(normalize());
 }
 
 /**
  * @brief Test if `*this' is bottom
  */
 bool ZoneDomain::isEmpty() const {
-
-    // todo: Determine if there are negative loops (about 4 lines)
-
+    // Assume `*this' is already normalized, so a negative cycle shows up on
+    // the diagonal
+    for (size_t i = 0; i < n; i++)
+        if (_dbm[i][i] < 0)
+            return true;
     return false;
 }
 
@@ -115,9 +120,9 @@ bool ZoneDomain::eq(const ZoneDomain &o) const {
 /**
  * @brief Get the projection of `*this' on the variable `x'
  */
-IntervalDomain ZoneDomain::projection(const std::string &x) const {
-    size_t id = getID(x);
-    return IntervalDomain(-_dbm[id][0], _dbm[0][id]);
+IntervalDomain ZoneDomain::projection(IR::VarId x) const {
+    assert(x < n);
+    return IntervalDomain(-_dbm[x][0], _dbm[0][x]);
 }
 
 /**
@@ -134,12 +139,25 @@ ZoneDomain ZoneDomain::lub(const ZoneDomain &o) const {
     return ret;
 }
 
+bool ZoneDomain::joinWith(const ZoneDomain &o) {
+    // the join of normalized zones is normalized, so no closure is needed
+    assert(isNormalized() && o.isNormalized());
+    bool changed = false;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            if (o._dbm[i][j] > _dbm[i][j]) {
+                _dbm[i][j] = o._dbm[i][j];
+                changed = true;
+            }
+    return changed;
+}
+
 /**
  * @brief Get the new zone which forgets the variable `x'
  */
-ZoneDomain ZoneDomain::forget(const std::string &x) const {
+ZoneDomain ZoneDomain::forget(IR::VarId x) const {
     ZoneDomain ret = *this;
-    size_t k = getID(x);
+    size_t k = x;
 
     for (size_t i = 0; i < n; i++)
         for (size_t j = 0; j < n; j++) {
@@ -163,7 +181,7 @@ ZoneDomain ZoneDomain::forget(const std::string &x) const {
  */
 ZoneDomain ZoneDomain::filterInst(const IR::IfInst *inst, bool branch) const {
 
-    std::string x = inst->getOperand(0)->getAsVariable();
+    IR::VarId x = inst->getOperand(0)->getVarId();
     long long c = inst->getOperand(1)->getAsNumber();
     IR::CmpOperator op = inst->getCmpOperator();
     ZoneDomain ret = *this;
@@ -197,19 +215,19 @@ ZoneDomain ZoneDomain::filterInst(const IR::IfInst *inst, bool branch) const {
 
     switch (op) {
     case IR::CmpOperator::EQ:
-        ret = this->filter(x, "", c).filter("", x, -c);
+        ret = this->filter(x, IR::ZeroVar, c).filter(IR::ZeroVar, x, -c);
         break;
     case IR::CmpOperator::GEQ:
-        ret = this->filter("", x, -c);
+        ret = this->filter(IR::ZeroVar, x, -c);
         break;
     case IR::CmpOperator::GT:
-        ret = this->filter("", x, -(c + 1));
+        ret = this->filter(IR::ZeroVar, x, -(c + 1));
         break;
     case IR::CmpOperator::LEQ:
-        ret = this->filter(x, "", c);
+        ret = this->filter(x, IR::ZeroVar, c);
         break;
     case IR::CmpOperator::LT:
-        ret = this->filter(x, "", c - 1);
+        ret = this->filter(x, IR::ZeroVar, c - 1);
         break;
     default:
         assert(false);
@@ -223,14 +241,14 @@ ZoneDomain ZoneDomain::filterInst(const IR::IfInst *inst, bool branch) const {
 /**
  * @brief Get the new zone filtered by guard `x - y <= c'
  *
- * For case `x <= c', we set y = ""
- * For case `-y <= c', we set x = ""
+ * For case `x <= c', we set y = ZeroVar
+ * For case `-y <= c', we set x = ZeroVar
  */
-ZoneDomain ZoneDomain::filter(const std::string &x, const std::string &y,
-                              long long c) const {
+ZoneDomain ZoneDomain::filter(IR::VarId x, IR::VarId y, long long c) const {
     ZoneDomain ret = *this;
 
-    // todo: add constraint `x - y <= c' (about 3 lines)
+    size_t i = y, j = x;
+    ret._dbm[i][j] = std::min(ret._dbm[i][j], c);
 
     return ret;
 }
@@ -239,23 +257,26 @@ ZoneDomain ZoneDomain::filter(const std::string &x, const std::string &y,
  * @brief Get the new zone after excuting assigment/add/sub `inst'
  */
 ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
-    std::string x;
+    IR::VarId x;
     ZoneDomain ret;
 
-    if (const IR::AddInst *addInst = dynamic_cast<const IR::AddInst *>(inst)) {
-        x = addInst->getOperand(0)->getAsVariable();
+    // dispatch on the instruction tag, this runs once per transfer
+    if (inst->getInstType() == IR::InstType::AddInst) {
+        auto addInst = static_cast<const IR::AddInst *>(inst);
+        x = addInst->getOperand(0)->getVarId();
         IR::Value *operand1 = addInst->getOperand(1);
         IR::Value *operand2 = addInst->getOperand(2);
 
         // case: x <- c1 + c2
         if (operand1->isNumber() && operand2->isNumber())
-            ret = this->assign_case2(
-                x, "", operand1->getAsNumber() + operand2->getAsNumber());
+            ret = this->assign_case2(x, IR::ZeroVar,
+                                     operand1->getAsNumber() +
+                                         operand2->getAsNumber());
         // case: x <- y + c || x <- c + y
         else if (operand1->isNumber() || operand2->isNumber()) {
             if (operand1->isNumber())
                 std::swap(operand1, operand2);
-            std::string y = operand1->getAsVariable();
+            IR::VarId y = operand1->getVarId();
             long long c = operand2->getAsNumber();
             // subcase: x == y
             if (x == y)
@@ -267,26 +288,28 @@ ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
         // case: x <- y + z
         else {
             IntervalDomain interval1 =
-                this->projection(operand1->getAsVariable());
+                this->projection(operand1->getVarId());
             IntervalDomain interval2 =
-                this->projection(operand2->getAsVariable());
+                this->projection(operand2->getVarId());
             long long l = interval1.l + interval2.l;
             long long r = interval1.r + interval2.r;
             ret = this->assign_case3(x, l, r);
         }
     }
-    if (const IR::SubInst *subInst = dynamic_cast<const IR::SubInst *>(inst)) {
-        x = subInst->getOperand(0)->getAsVariable();
+    if (inst->getInstType() == IR::InstType::SubInst) {
+        auto subInst = static_cast<const IR::SubInst *>(inst);
+        x = subInst->getOperand(0)->getVarId();
         IR::Value *operand1 = subInst->getOperand(1);
         IR::Value *operand2 = subInst->getOperand(2);
 
         // case: x <- c1 - c2
         if (operand1->isNumber() && operand2->isNumber())
-            ret = this->assign_case2(
-                x, "", operand1->getAsNumber() - operand2->getAsNumber());
+            ret = this->assign_case2(x, IR::ZeroVar,
+                                     operand1->getAsNumber() -
+                                         operand2->getAsNumber());
         // case: x <- y - c
         else if (operand2->isNumber()) {
-            std::string y = operand1->getAsVariable();
+            IR::VarId y = operand1->getVarId();
             long long c = operand2->getAsNumber();
             // subcase: x == y
             if (x == y)
@@ -299,7 +322,7 @@ ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
         else if (operand1->isNumber()) {
             long long c = operand1->getAsNumber();
             IntervalDomain interval =
-                this->projection(operand2->getAsVariable());
+                this->projection(operand2->getVarId());
             long long l = c - interval.r;
             long long r = c - interval.l;
             ret = this->assign_case3(x, l, r);
@@ -307,25 +330,25 @@ ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
         // case: x <- y - z
         else {
             IntervalDomain interval1 =
-                this->projection(operand1->getAsVariable());
+                this->projection(operand1->getVarId());
             IntervalDomain interval2 =
-                this->projection(operand2->getAsVariable());
+                this->projection(operand2->getVarId());
             long long l = interval1.l - interval2.r;
             long long r = interval1.r - interval2.l;
             ret = this->assign_case3(x, l, r);
         }
     }
-    if (const IR::AssignInst *assignInst =
-            dynamic_cast<const IR::AssignInst *>(inst)) {
-        x = assignInst->getOperand(0)->getAsVariable();
+    if (inst->getInstType() == IR::InstType::AssignInst) {
+        auto assignInst = static_cast<const IR::AssignInst *>(inst);
+        x = assignInst->getOperand(0)->getVarId();
         IR::Value *operand = assignInst->getOperand(1);
 
         // case: x <- c
         if (operand->isNumber())
-            ret = this->assign_case2(x, "", operand->getAsNumber());
+            ret = this->assign_case2(x, IR::ZeroVar, operand->getAsNumber());
         // case: x <- y
         else if (operand->isVariable()) {
-            std::string y = operand->getAsVariable();
+            IR::VarId y = operand->getVarId();
             // subcase: x == y
             if (x == y)
                 ret = *this;
@@ -334,10 +357,10 @@ ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
                 ret = this->assign_case2(x, y, 0);
         }
     }
-    if (const IR::InputInst *inputInst =
-            dynamic_cast<const IR::InputInst *>(inst)) {
+    if (inst->getInstType() == IR::InstType::InputInst) {
+        auto inputInst = static_cast<const IR::InputInst *>(inst);
         // x <- [0, 255]
-        x = inputInst->getOperand(0)->getAsVariable();
+        x = inputInst->getOperand(0)->getVarId();
         ret = this->assign_case3(x, 0, 255);
     }
 
@@ -348,8 +371,8 @@ ZoneDomain ZoneDomain::assignInst(const IR::Inst *inst) const {
 /**
  * @brief Get the new zone after excuting `x = x + c'
  */
-ZoneDomain ZoneDomain::assign_case1(const std::string &x, long long c) const {
-    size_t i0 = getID(x);
+ZoneDomain ZoneDomain::assign_case1(IR::VarId x, long long c) const {
+    size_t i0 = x;
     ZoneDomain ret = *this;
 
     long long pc = c;
@@ -375,13 +398,19 @@ ZoneDomain ZoneDomain::assign_case1(const std::string &x, long long c) const {
 /**
  * @brief Get the new zone after excuting `x = y + c' or `x = c'
  *
- * For case `x = c', we set y = ""
+ * For case `x = c', we set y = ZeroVar
  */
-ZoneDomain ZoneDomain::assign_case2(const std::string &x, const std::string &y,
+ZoneDomain ZoneDomain::assign_case2(IR::VarId x, IR::VarId y,
                                     long long c) const {
     ZoneDomain ret;
 
-    // todo: (about 1 line)
+    // `x - y == c' only holds if `y + c' cannot saturate, otherwise fall back
+    // to the interval of `x'
+    IntervalDomain interval = this->projection(y);
+    if (0 <= interval.l + c && interval.r + c <= 255)
+        ret = this->forget(x).filter(x, y, c).filter(y, x, -c);
+    else
+        ret = this->assign_case3(x, interval.l + c, interval.r + c);
 
     return ret;
 }
@@ -389,13 +418,15 @@ ZoneDomain ZoneDomain::assign_case2(const std::string &x, const std::string &y,
 /**
  * @brief Get the new zone after excuting `x = [l, r]'
  */
-ZoneDomain ZoneDomain::assign_case3(const std::string &x, long long l,
+ZoneDomain ZoneDomain::assign_case3(IR::VarId x, long long l,
                                     long long r) const {
-    l = std::max(l, 0ll);
-    r = std::min(r, 255ll);
+    // saturate both bounds, e.g. `x = y + z' with y, z in [200, 255]
+    l = std::min(std::max(l, 0ll), 255ll);
+    r = std::min(std::max(r, 0ll), 255ll);
     ZoneDomain ret;
 
-    // todo: (about 4 lines)
+    ret = this->forget(x);
+    ret = ret.filter(x, IR::ZeroVar, r).filter(IR::ZeroVar, x, -l);
 
     return ret;
 }
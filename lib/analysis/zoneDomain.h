@@ -5,7 +5,6 @@
 
 #include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace fdlang::analysis {
@@ -21,8 +20,9 @@ private:
     static const long long INF;
     size_t n;
 
-    std::vector<std::string> _id_to_var;
-    std::unordered_map<std::string, size_t> _var_to_id;
+    // Variables of the analysed function, row and column i of the matrix
+    // belong to variable i, and row and column 0 to the zero variable
+    const IR::VarTable *_vars = nullptr;
 
     using Matrix = std::vector<std::vector<long long>>;
     /**
@@ -32,26 +32,22 @@ private:
      */
     Matrix _dbm;
 
-    std::string getVar(size_t id) const {
-        assert(0 <= id && id < _id_to_var.size());
-        return _id_to_var[id];
-    }
+    // tighten `_dbm' in place to its normal form
+    void close();
 
-    size_t getID(const std::string &x) const {
-        auto it = _var_to_id.find(x);
-        assert(it != _var_to_id.end());
-        return it->second;
-    }
+    // whether `_dbm' is already in normal form, for assertions
+    bool isNormalized() const;
 
 public:
     /**
      * @brief Construct a new Zone Domain
      *
-     * @param vars names of appeared variables
+     * @param vars variables of the analysed function, which must outlive the
+     * zone
      * @param isInitialization true for initialization(all zero) and false for
      * bottom
      */
-    ZoneDomain(const std::vector<std::string> &vars, bool isInitialization);
+    ZoneDomain(const IR::VarTable &vars, bool isInitialization);
     ZoneDomain() = default;
 
     void dump(std::ostream &out) const;
@@ -79,17 +75,24 @@ public:
     /**
      * @brief Get the projection of `*this' on the variable `x'
      */
-    IntervalDomain projection(const std::string &x) const;
+    IntervalDomain projection(IR::VarId x) const;
 
     /**
      * @brief Get the new zone which is the least upper bound of `*this' and `o'
      */
     ZoneDomain lub(const ZoneDomain &o) const;
 
+    /**
+     * @brief Join `o' into `*this', both normalized
+     *
+     * @return whether `*this' changed
+     */
+    bool joinWith(const ZoneDomain &o);
+
     /**
      * @brief Get the new zone which forgets the variable `x'
      */
-    ZoneDomain forget(const std::string &x) const;
+    ZoneDomain forget(IR::VarId x) const;
 
     /**
      * @brief Get the new zone filtered by `inst'
@@ -99,11 +102,10 @@ public:
     /**
      * @brief Get the new zone filtered by guard `x - y <= c'
      *
-     * For case `x <= c', we set y = ""
-     * For case `-y <= c', we set x = ""
+     * For case `x <= c', we set y = ZeroVar
+     * For case `-y <= c', we set x = ZeroVar
      */
-    ZoneDomain filter(const std::string &x, const std::string &y,
-                      long long c) const;
+    ZoneDomain filter(IR::VarId x, IR::VarId y, long long c) const;
 
     /**
      * @brief Get the new zone after excuting assigment/add/sub `inst'
@@ -113,21 +115,19 @@ public:
     /**
      * @brief Get the new zone after excuting `x = x + c'
      */
-    ZoneDomain assign_case1(const std::string &x, long long c) const;
+    ZoneDomain assign_case1(IR::VarId x, long long c) const;
 
     /**
      * @brief Get the new zone after excuting `x = y + c' or `x = c'
      *
-     * For case `x = c', we set y = ""
+     * For case `x = c', we set y = ZeroVar
      */
-    ZoneDomain assign_case2(const std::string &x, const std::string &y,
-                            long long c) const;
+    ZoneDomain assign_case2(IR::VarId x, IR::VarId y, long long c) const;
 
     /**
      * @brief Get the new zone after excuting `x = [l, r]'
      */
-    ZoneDomain assign_case3(const std::string &x, long long l,
-                            long long r) const;
+    ZoneDomain assign_case3(IR::VarId x, long long l, long long r) const;
 };
 
 } // namespace fdlang::analysis
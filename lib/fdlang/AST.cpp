@@ -1,6 +1,8 @@
 #include "AST.h"
 #include "ASTVisitor.h"
 
+#include <algorithm>
+
 using namespace fdlang;
 
 void Stmts::accept(ASTVisitor *visitor) { visitor->visit(this); }
@@ -19,8 +21,41 @@ void Stmts::addChild(ASTNode *node) { children.push_back(node); }
 void FunctionNodes::addChild(ASTNode *node) { children.push_back(node); }
 
 void FunctionNodes::addCallee() {
+    // calls resolve through an index by name to the last function of that
+    // name, and every function of a called name stops being a root
+    SymbolId numNames = 0;
+    for (auto child : children) {
+        auto function = static_cast<FunctionNode *>(child);
+        if (function->funcName.type == TokenType::IDENTIFIER)
+            numNames = std::max<SymbolId>(
+                numNames, function->funcName.getLiteralAsSymbol() + 1);
+    }
+    byName.assign(numNames, nullptr);
+    called.assign(numNames, false);
+    for (auto child : children) {
+        auto function = static_cast<FunctionNode *>(child);
+        if (function->funcName.type == TokenType::IDENTIFIER)
+            byName[function->funcName.getLiteralAsSymbol()] = function;
+    }
+
     for (auto child : children)
         child->addCallee(this);
+
+    for (auto child : children) {
+        auto function = static_cast<FunctionNode *>(child);
+        if (function->funcName.type == TokenType::IDENTIFIER &&
+            called[function->funcName.getLiteralAsSymbol()])
+            function->setRoot(false);
+    }
+    byName.clear();
+    called.clear();
+}
+
+FunctionNode *FunctionNodes::resolve(SymbolId name) {
+    if (name >= byName.size() || !byName[name])
+        return nullptr;
+    called[name] = true;
+    return byName[name];
 }
 void FunctionNode::addCallee(ASTNode *nodes) { body->addCallee(nodes); }
 void Stmts::addCallee(ASTNode *nodes) {
@@ -29,14 +64,12 @@ void Stmts::addCallee(ASTNode *nodes) {
     }
 }
 void CallStmt::addCallee(ASTNode *nodes) {
-    auto functionNodes = dynamic_cast<FunctionNodes *>(nodes);
-    for (auto child : functionNodes->children) {
-        auto function = dynamic_cast<FunctionNode *>(child);
-        if (function->funcName.lexeme == calleeName.lexeme) {
-            callee = function;
-            function->setRoot(false);
-        }
-    }
+    if (calleeName.type != TokenType::IDENTIFIER)
+        return;
+    auto functionNodes = static_cast<FunctionNodes *>(nodes);
+    if (FunctionNode *function =
+            functionNodes->resolve(calleeName.getLiteralAsSymbol()))
+        callee = function;
 }
 
 std::string fdlang::getASTNodeSpelling(const ASTNode &node) {
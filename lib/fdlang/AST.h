@@ -211,6 +211,12 @@ public:
 };
 
 class FunctionNodes : public ASTNode {
+private:
+    // while addCallee() runs: the last function of each name, and whether
+    // a call names it, indexed by SymbolId
+    std::vector<FunctionNode *> byName;
+    std::vector<bool> called;
+
 public:
     std::vector<ASTNode *> children;
 
@@ -227,7 +233,17 @@ public:
 
     void addChild(ASTNode *node);
 
+    /**
+     * @brief Resolve every call to the last function of its name, in time
+     * linear in the program
+     */
     void addCallee();
+
+    /**
+     * @brief The function a call to `name' resolves to, nullptr if none.
+     * Only while addCallee() runs.
+     */
+    FunctionNode *resolve(SymbolId name);
 };
 
 std::string getASTNodeSpelling(const ASTNode &node);
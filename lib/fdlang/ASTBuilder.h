@@ -0,0 +1,90 @@
+#ifndef FDLANG_ASTBUILDER_H
+#define FDLANG_ASTBUILDER_H
+
+#include "AST.h"
+#include "token.h"
+
+#include <vector>
+
+namespace fdlang {
+
+/**
+ * Builder policy for BasicParser producing the pointer AST.
+ *
+ * A builder names its node handle type `Node', returns none() for a node
+ * that failed to parse, and gets one call per node in the order the parser
+ * completes them. Stmts and FunctionNodes are opened with begin*(), receive
+ * their children through add*(), and are closed with finish*().
+ */
+class ASTBuilder {
+public:
+    using Node = ASTNode *;
+
+    static Node none() { return nullptr; }
+
+    Node beginStmts(size_t label) { return new Stmts(label); }
+
+    void addStmt(Node stmts, Node stmt) {
+        static_cast<Stmts *>(stmts)->addChild(stmt);
+    }
+
+    void finishStmts(Node stmts) {}
+
+    Node beginFunctions(size_t label) { return new FunctionNodes(label); }
+
+    void addFunction(Node functions, Node function) {
+        static_cast<FunctionNodes *>(functions)->addChild(function);
+    }
+
+    // callees are only linked when the whole program parsed
+    void finishFunctions(Node functions, bool complete) {
+        if (complete)
+            static_cast<FunctionNodes *>(functions)->addCallee();
+    }
+
+    Node cond(size_t label, const Token &leftOperand, const Token &op,
+              const Token &rightOperand) {
+        return new Cond(label, leftOperand, op, rightOperand);
+    }
+
+    Node binaryAssign(size_t label, const Token &variable,
+                      const Token &leftOperand, const Token &op,
+                      const Token &rightOperand) {
+        return new BinaryAssignStmt(label, variable, leftOperand, op,
+                                    rightOperand);
+    }
+
+    Node unaryAssign(size_t label, const Token &variable,
+                     const Token &operand) {
+        return new UnaryAssignStmt(label, variable, operand);
+    }
+
+    Node ifStmt(size_t label, Node cond, Node trueBody, Node falseBody) {
+        return new IfStmt(label, cond, trueBody, falseBody);
+    }
+
+    Node whileStmt(size_t label, Node cond, Node body) {
+        return new WhileStmt(label, cond, body);
+    }
+
+    Node check(size_t label, const Token &check,
+               const std::vector<Token> &params) {
+        return new CheckStmt(label, check, params);
+    }
+
+    Node nop(size_t label) { return new NopStmt(label); }
+
+    Node call(size_t label, const Token &calleeName,
+              const std::vector<Token> &args) {
+        return new CallStmt(label, calleeName, args);
+    }
+
+    Node function(size_t label, const Token &funcName,
+                  const std::vector<Token> &args, Node body) {
+        return new FunctionNode(label, funcName, args, body);
+    }
+};
+
+} // namespace fdlang
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FDLANG_ASTWALKER_H
+#define FDLANG_ASTWALKER_H
+
+#include "AST.h"
+
+namespace fdlang {
+
+/**
+ * Statically dispatched AST traversal, an alternative to ASTVisitor and
+ * ASTNode::accept for passes that know their visitor type at compile time.
+ *
+ * walk() switches on ASTNode::type and calls Derived::visit with the
+ * concrete node type, so no virtual call is made and the visits can be
+ * inlined. The default visit() of every node walks its children in source
+ * order; a pass defines only the overloads it cares about, brings the
+ * others in with `using ASTWalker<Derived>::visit;' and calls
+ * ASTWalker<Derived>::visit(node) where it wants the default traversal.
+ *
+ * If the derived visits are private, the derived class has to befriend
+ * ASTWalker<Derived>.
+ */
+template <typename Derived> class ASTWalker {
+private:
+    Derived &derived() { return static_cast<Derived &>(*this); }
+
+public:
+    void walk(ASTNode *node) {
+        switch (node->type) {
+        case ASTNodeType::STMTS:
+            return derived().visit(static_cast<Stmts *>(node));
+        case ASTNodeType::COND:
+            return derived().visit(static_cast<Cond *>(node));
+        case ASTNodeType::BINARY_ASSIGN_STMT:
+            return derived().visit(static_cast<BinaryAssignStmt *>(node));
+        case ASTNodeType::UNARY_ASSIGN_STMT:
+            return derived().visit(static_cast<UnaryAssignStmt *>(node));
+        case ASTNodeType::IF_STMT:
+            return derived().visit(static_cast<IfStmt *>(node));
+        case ASTNodeType::WHILE_STMT:
+            return derived().visit(static_cast<WhileStmt *>(node));
+        case ASTNodeType::CHECK_STMT:
+            return derived().visit(static_cast<CheckStmt *>(node));
+        case ASTNodeType::NOP_STMT:
+            return derived().visit(static_cast<NopStmt *>(node));
+        case ASTNodeType::CALL_STMT:
+            return derived().visit(static_cast<CallStmt *>(node));
+        case ASTNodeType::FUNCTION:
+            return derived().visit(static_cast<FunctionNode *>(node));
+        case ASTNodeType::FUNCTIONS:
+            return derived().visit(static_cast<FunctionNodes *>(node));
+        }
+    }
+
+    void visit(Stmts *node) {
+        for (ASTNode *child : node->children)
+            walk(child);
+    }
+    void visit(Cond *node) {}
+    void visit(UnaryAssignStmt *node) {}
+    void visit(BinaryAssignStmt *node) {}
+    void visit(IfStmt *node) {
+        walk(node->cond);
+        walk(node->trueBody);
+        walk(node->falseBody);
+    }
+    void visit(WhileStmt *node) {
+        walk(node->cond);
+        walk(node->body);
+    }
+    void visit(CheckStmt *node) {}
+    void visit(NopStmt *node) {}
+    void visit(CallStmt *node) {}
+    void visit(FunctionNodes *node) {
+        for (ASTNode *child : node->children)
+            walk(child);
+    }
+    void visit(FunctionNode *node) { walk(node->body); }
+};
+
+} // namespace fdlang
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef FDLANG_CHARSCAN_H
+#define FDLANG_CHARSCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FDLANG_SIMD_SCAN 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FDLANG_SIMD_SCAN 1
+#endif
+
+namespace fdlang {
+
+/**
+ * Character-class run scanning for the Scanner fast path.
+ *
+ * Each function returns the first position in [p, end) that does not belong
+ * to the run. Whole blocks of 32 (AVX2) or 16 (SSE2) bytes are classified at
+ * once; the tail, and targets without SSE2, use the scalar loop. Blocks are
+ * only loaded while they fit before `end', so the input need not be padded.
+ */
+
+inline bool isSpaceChar(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool isDigitChar(char c) { return '0' <= c && c <= '9'; }
+
+inline bool isIdentifierChar(char c) {
+    char lower = c | 0x20;
+    return ('a' <= lower && lower <= 'z') || isDigitChar(c) || c == '_';
+}
+
+#ifdef FDLANG_SIMD_SCAN
+namespace simd {
+
+#if defined(__AVX2__)
+using Block = __m256i;
+const size_t BLOCK_SIZE = 32;
+const uint32_t FULL_MASK = 0xffffffffu;
+
+inline Block load(const char *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline Block splat(char c) { return _mm256_set1_epi8(c); }
+inline Block eq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+inline Block gt(Block a, Block b) { return _mm256_cmpgt_epi8(a, b); }
+inline Block both(Block a, Block b) { return _mm256_and_si256(a, b); }
+inline Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+inline uint32_t mask(Block a) { return (uint32_t)_mm256_movemask_epi8(a); }
+#else
+using Block = __m128i;
+const size_t BLOCK_SIZE = 16;
+const uint32_t FULL_MASK = 0xffffu;
+
+inline Block load(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline Block splat(char c) { return _mm_set1_epi8(c); }
+inline Block eq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+inline Block gt(Block a, Block b) { return _mm_cmpgt_epi8(a, b); }
+inline Block both(Block a, Block b) { return _mm_and_si128(a, b); }
+inline Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+inline uint32_t mask(Block a) { return (uint32_t)_mm_movemask_epi8(a); }
+#endif
+
+// Bytes in [lo, hi]. Comparisons are signed, so bytes >= 0x80 never match.
+inline Block inRange(Block x, char lo, char hi) {
+    return both(gt(x, splat(lo - 1)), gt(splat(hi + 1), x));
+}
+
+inline uint32_t digitMask(Block x) { return mask(inRange(x, '0', '9')); }
+
+inline uint32_t identifierMask(Block x) {
+    Block letter = inRange(either(x, splat(0x20)), 'a', 'z');
+    Block digit = inRange(x, '0', '9');
+    return mask(either(either(letter, digit), eq(x, splat('_'))));
+}
+
+inline int countTrailingZeros(uint32_t x) { return __builtin_ctz(x); }
+
+inline int popcount(uint32_t x) { return __builtin_popcount(x); }
+
+} // namespace simd
+#endif
+
+inline const char *skipDigits(const char *p, const char *end) {
+#ifdef FDLANG_SIMD_SCAN
+    while ((size_t)(end - p) >= simd::BLOCK_SIZE) {
+        uint32_t m = simd::digitMask(simd::load(p));
+        if (m != simd::FULL_MASK)
+            return p + simd::countTrailingZeros(~m);
+        p += simd::BLOCK_SIZE;
+    }
+#endif
+    while (p < end && isDigitChar(*p))
+        p++;
+    return p;
+}
+
+inline const char *skipIdentifier(const char *p, const char *end) {
+#ifdef FDLANG_SIMD_SCAN
+    while ((size_t)(end - p) >= simd::BLOCK_SIZE) {
+        uint32_t m = simd::identifierMask(simd::load(p));
+        if (m != simd::FULL_MASK)
+            return p + simd::countTrailingZeros(~m);
+        p += simd::BLOCK_SIZE;
+    }
+#endif
+    while (p < end && isIdentifierChar(*p))
+        p++;
+    return p;
+}
+
+/**
+ * @brief Skip spaces, tabs and line breaks, adding the number of '\n' seen
+ * to `lines'
+ */
+inline const char *skipWhitespace(const char *p, const char *end,
+                                  size_t &lines) {
+#ifdef FDLANG_SIMD_SCAN
+    while ((size_t)(end - p) >= simd::BLOCK_SIZE) {
+        simd::Block x = simd::load(p);
+        simd::Block newline = simd::eq(x, simd::splat('\n'));
+        simd::Block blank = simd::either(simd::eq(x, simd::splat(' ')),
+                                         simd::eq(x, simd::splat('\t')));
+        blank = simd::either(blank, simd::eq(x, simd::splat('\r')));
+        uint32_t space = simd::mask(simd::either(blank, newline));
+        uint32_t newlines = simd::mask(newline);
+        if (space != simd::FULL_MASK) {
+            int n = simd::countTrailingZeros(~space);
+            lines += simd::popcount(newlines & ((1u << n) - 1));
+            return p + n;
+        }
+        lines += simd::popcount(newlines);
+        p += simd::BLOCK_SIZE;
+    }
+#endif
+    for (; p < end && isSpaceChar(*p); p++)
+        if (*p == '\n')
+            lines++;
+    return p;
+}
+
+} // namespace fdlang
+
+#endif
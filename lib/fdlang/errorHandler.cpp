@@ -1,6 +1,7 @@
 #include "errorHandler.h"
 
 #include <iostream>
+#include <mutex>
 
 void fdlang::error(size_t line, const std::string &msg) {
     fdlang::report(line, "", msg);
@@ -8,6 +9,9 @@ void fdlang::error(size_t line, const std::string &msg) {
 
 void fdlang::report(size_t line, const std::string &where,
                     const std::string &msg) {
+    // keep reports from concurrent frontend workers on separate lines
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
     std::cerr << "[line " << line << "] Error" << where << ": " << msg
               << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "flatAST.h"
+
+using namespace fdlang;
+
+ASTNode *FlatAST::materialize(NodeIndex root) const {
+    if (root == NoNode)
+        return nullptr;
+
+    const FlatNode &n = node(root);
+    auto argsOf = [&](NodeIndex id) {
+        TokenRange args = tokenRange(id, 1);
+        return std::vector<Token>(args.begin(), args.end());
+    };
+
+    switch (n.type) {
+    case ASTNodeType::STMTS: {
+        Stmts *stmts = new Stmts(n.label);
+        for (size_t i = 0; i < n.numChildren; i++)
+            stmts->addChild(materialize(child(root, i)));
+        return stmts;
+    }
+    case ASTNodeType::COND:
+        return new Cond(n.label, token(root, 0), token(root, 1),
+                        token(root, 2));
+    case ASTNodeType::BINARY_ASSIGN_STMT:
+        return new BinaryAssignStmt(n.label, token(root, 0), token(root, 1),
+                                    token(root, 2), token(root, 3));
+    case ASTNodeType::UNARY_ASSIGN_STMT:
+        return new UnaryAssignStmt(n.label, token(root, 0), token(root, 1));
+    case ASTNodeType::IF_STMT:
+        return new IfStmt(n.label, materialize(child(root, 0)),
+                          materialize(child(root, 1)),
+                          materialize(child(root, 2)));
+    case ASTNodeType::WHILE_STMT:
+        return new WhileStmt(n.label, materialize(child(root, 0)),
+                             materialize(child(root, 1)));
+    case ASTNodeType::CHECK_STMT:
+        return new CheckStmt(n.label, token(root, 0), argsOf(root));
+    case ASTNodeType::NOP_STMT:
+        return new NopStmt(n.label);
+    case ASTNodeType::CALL_STMT:
+        return new CallStmt(n.label, token(root, 0), argsOf(root));
+    case ASTNodeType::FUNCTION:
+        return new FunctionNode(n.label, token(root, 0), argsOf(root),
+                                materialize(child(root, 0)));
+    case ASTNodeType::FUNCTIONS: {
+        FunctionNodes *functions = new FunctionNodes(n.label);
+        for (size_t i = 0; i < n.numChildren; i++)
+            functions->addChild(materialize(child(root, i)));
+        if (complete)
+            functions->addCallee();
+        return functions;
+    }
+    }
+    assert(false && "Unknown AST node type");
+    return nullptr;
+}
@@ -0,0 +1,410 @@
+#ifndef FDLANG_FLATAST_H
+#define FDLANG_FLATAST_H
+
+#include "AST.h"
+#include "token.h"
+
+#include <assert.h>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+namespace fdlang {
+
+using NodeIndex = uint32_t;
+const NodeIndex NoNode = UINT32_MAX;
+
+/**
+ * A node of a FlatAST. Its tokens and children are contiguous ranges of the
+ * FlatAST token and child arrays:
+ *
+ * STMTS / FUNCTIONS   children: statements / functions
+ * COND                tokens: left operand, operator, right operand
+ * BINARY_ASSIGN_STMT  tokens: variable, left operand, operator, right operand
+ * UNARY_ASSIGN_STMT   tokens: variable, operand
+ * IF_STMT             children: cond, true body, false body
+ * WHILE_STMT          children: cond, body
+ * CHECK_STMT          tokens: check_interval, 3 params
+ * NOP_STMT            -
+ * CALL_STMT           tokens: callee name, args
+ * FUNCTION            tokens: function name, args; children: body
+ */
+struct FlatNode {
+    ASTNodeType type;
+    uint32_t label;
+    uint32_t firstToken, numTokens;
+    uint32_t firstChild, numChildren;
+};
+
+static_assert(std::is_trivial_v<FlatNode>);
+static_assert(std::is_trivially_destructible_v<Token>);
+
+class FlatAST;
+
+// A node of a FlatAST, what FlatASTWalker walks
+struct FlatNodeRef {
+    const FlatAST *ast = nullptr;
+    NodeIndex id = NoNode;
+};
+
+// A view of consecutive children of a FlatAST node
+class FlatNodeRange {
+private:
+    const FlatAST *ast = nullptr;
+    const NodeIndex *first = nullptr;
+    const NodeIndex *last = nullptr;
+
+public:
+    class iterator {
+    private:
+        const FlatAST *ast;
+        const NodeIndex *it;
+
+    public:
+        iterator(const FlatAST *ast, const NodeIndex *it) : ast(ast), it(it) {}
+
+        FlatNodeRef operator*() const { return {ast, *it}; }
+        iterator &operator++() {
+            ++it;
+            return *this;
+        }
+        bool operator!=(const iterator &o) const { return it != o.it; }
+    };
+
+    FlatNodeRange() = default;
+    FlatNodeRange(const FlatAST *ast, const NodeIndex *first, size_t size)
+        : ast(ast), first(first), last(first + size) {}
+
+    iterator begin() const { return iterator(ast, first); }
+    iterator end() const { return iterator(ast, last); }
+    size_t size() const { return last - first; }
+
+    FlatNodeRef operator[](size_t i) const {
+        assert(i < size());
+        return {ast, first[i]};
+    }
+};
+
+/**
+ * AST stored in three flat arrays of trivially destructible elements, so
+ * that building it is a handful of appends per node and freeing it releases
+ * three buffers regardless of the tree size. Walk it in place with
+ * FlatASTWalker, as Sema and IRBuilder do; materialize() builds the pointer
+ * AST for passes that only take that one.
+ */
+class FlatAST {
+private:
+    std::vector<FlatNode> nodes;
+    std::vector<Token> tokens;
+    std::vector<NodeIndex> children;
+    // parsed without errors, so callees can be linked
+    bool complete = false;
+
+public:
+    NodeIndex addNode(ASTNodeType type, size_t label) {
+        FlatNode node = {type, (uint32_t)label, 0, 0, 0, 0};
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+
+    void setTokens(NodeIndex id, std::initializer_list<Token> toks) {
+        nodes[id].firstToken = tokens.size();
+        nodes[id].numTokens = toks.size();
+        tokens.insert(tokens.end(), toks.begin(), toks.end());
+    }
+
+    void setTokens(NodeIndex id, const Token &head,
+                   const std::vector<Token> &rest) {
+        nodes[id].firstToken = tokens.size();
+        nodes[id].numTokens = 1 + rest.size();
+        tokens.push_back(head);
+        tokens.insert(tokens.end(), rest.begin(), rest.end());
+    }
+
+    void setChildren(NodeIndex id, const NodeIndex *first, size_t count) {
+        nodes[id].firstChild = children.size();
+        nodes[id].numChildren = count;
+        children.insert(children.end(), first, first + count);
+    }
+
+    void setComplete(bool isComplete) { complete = isComplete; }
+    bool isComplete() const { return complete; }
+
+    size_t size() const { return nodes.size(); }
+
+    const FlatNode &node(NodeIndex id) const {
+        assert(id < nodes.size() && "Unknown node");
+        return nodes[id];
+    }
+
+    const Token &token(NodeIndex id, size_t i) const {
+        assert(i < node(id).numTokens);
+        return tokens[node(id).firstToken + i];
+    }
+
+    NodeIndex child(NodeIndex id, size_t i) const {
+        assert(i < node(id).numChildren);
+        return children[node(id).firstChild + i];
+    }
+
+    /**
+     * @brief The tokens of `id' from the `from'th on
+     */
+    TokenRange tokenRange(NodeIndex id, size_t from = 0) const {
+        assert(from <= node(id).numTokens);
+        return TokenRange(tokens.data() + node(id).firstToken + from,
+                          node(id).numTokens - from);
+    }
+
+    FlatNodeRange childRange(NodeIndex id) const {
+        return FlatNodeRange(this, children.data() + node(id).firstChild,
+                             node(id).numChildren);
+    }
+
+    /**
+     * @brief Build the equivalent pointer AST rooted at `root', with callees
+     * linked if the tree is complete. The caller owns the result.
+     */
+    ASTNode *materialize(NodeIndex root) const;
+};
+
+/**
+ * Typed views of FlatAST nodes with the fields of the pointer AST node of
+ * the same name, except that children are FlatNodeRefs and token lists
+ * TokenRanges. of() views a node of the matching type.
+ */
+namespace flat {
+
+struct Stmts {
+    size_t label;
+    FlatNodeRange children;
+
+    static Stmts of(FlatNodeRef ref) {
+        return {ref.ast->node(ref.id).label, ref.ast->childRange(ref.id)};
+    }
+};
+
+struct Cond {
+    size_t label;
+    const Token &leftOperand, &op, &rightOperand;
+
+    static Cond of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.token(ref.id, 1), ast.token(ref.id, 2)};
+    }
+};
+
+struct BinaryAssignStmt {
+    size_t label;
+    const Token &variable, &leftOperand, &op, &rightOperand;
+
+    static BinaryAssignStmt of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.token(ref.id, 1), ast.token(ref.id, 2),
+                ast.token(ref.id, 3)};
+    }
+};
+
+struct UnaryAssignStmt {
+    size_t label;
+    const Token &variable, &operand;
+
+    static UnaryAssignStmt of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.token(ref.id, 1)};
+    }
+};
+
+struct IfStmt {
+    size_t label;
+    FlatNodeRef cond, trueBody, falseBody;
+
+    static IfStmt of(FlatNodeRef ref) {
+        FlatNodeRange kids = ref.ast->childRange(ref.id);
+        return {ref.ast->node(ref.id).label, kids[0], kids[1], kids[2]};
+    }
+};
+
+struct WhileStmt {
+    size_t label;
+    FlatNodeRef cond, body;
+
+    static WhileStmt of(FlatNodeRef ref) {
+        FlatNodeRange kids = ref.ast->childRange(ref.id);
+        return {ref.ast->node(ref.id).label, kids[0], kids[1]};
+    }
+};
+
+struct CheckStmt {
+    size_t label;
+    const Token &check;
+    TokenRange params;
+
+    static CheckStmt of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.tokenRange(ref.id, 1)};
+    }
+};
+
+struct NopStmt {
+    size_t label;
+
+    static NopStmt of(FlatNodeRef ref) {
+        return {ref.ast->node(ref.id).label};
+    }
+};
+
+struct CallStmt {
+    size_t label;
+    const Token &calleeName;
+    TokenRange args;
+
+    static CallStmt of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.tokenRange(ref.id, 1)};
+    }
+};
+
+struct FunctionNode {
+    size_t label;
+    const Token &funcName;
+    TokenRange args;
+    FlatNodeRef body;
+
+    static FunctionNode of(FlatNodeRef ref) {
+        const FlatAST &ast = *ref.ast;
+        return {ast.node(ref.id).label, ast.token(ref.id, 0),
+                ast.tokenRange(ref.id, 1), {&ast, ast.child(ref.id, 0)}};
+    }
+};
+
+struct FunctionNodes {
+    size_t label;
+    FlatNodeRange children;
+
+    static FunctionNodes of(FlatNodeRef ref) {
+        return {ref.ast->node(ref.id).label, ref.ast->childRange(ref.id)};
+    }
+};
+
+} // namespace flat
+
+/**
+ * Builder policy for BasicParser producing a FlatAST, see ASTBuilder.
+ */
+class FlatASTBuilder {
+private:
+    FlatAST ast;
+    // children of the open Stmts and FunctionNodes, innermost last
+    std::vector<NodeIndex> pending;
+    std::vector<size_t> openMarks;
+
+public:
+    using Node = NodeIndex;
+
+    static Node none() { return NoNode; }
+
+    FlatAST &getAST() { return ast; }
+
+    Node beginStmts(size_t label) { return begin(ASTNodeType::STMTS, label); }
+
+    void addStmt(Node stmts, Node stmt) { pending.push_back(stmt); }
+
+    void finishStmts(Node stmts) { finish(stmts); }
+
+    Node beginFunctions(size_t label) {
+        return begin(ASTNodeType::FUNCTIONS, label);
+    }
+
+    void addFunction(Node functions, Node function) {
+        pending.push_back(function);
+    }
+
+    void finishFunctions(Node functions, bool complete) {
+        finish(functions);
+        ast.setComplete(complete);
+    }
+
+    Node cond(size_t label, const Token &leftOperand, const Token &op,
+              const Token &rightOperand) {
+        Node id = ast.addNode(ASTNodeType::COND, label);
+        ast.setTokens(id, {leftOperand, op, rightOperand});
+        return id;
+    }
+
+    Node binaryAssign(size_t label, const Token &variable,
+                      const Token &leftOperand, const Token &op,
+                      const Token &rightOperand) {
+        Node id = ast.addNode(ASTNodeType::BINARY_ASSIGN_STMT, label);
+        ast.setTokens(id, {variable, leftOperand, op, rightOperand});
+        return id;
+    }
+
+    Node unaryAssign(size_t label, const Token &variable,
+                     const Token &operand) {
+        Node id = ast.addNode(ASTNodeType::UNARY_ASSIGN_STMT, label);
+        ast.setTokens(id, {variable, operand});
+        return id;
+    }
+
+    Node ifStmt(size_t label, Node cond, Node trueBody, Node falseBody) {
+        Node id = ast.addNode(ASTNodeType::IF_STMT, label);
+        NodeIndex kids[] = {cond, trueBody, falseBody};
+        ast.setChildren(id, kids, 3);
+        return id;
+    }
+
+    Node whileStmt(size_t label, Node cond, Node body) {
+        Node id = ast.addNode(ASTNodeType::WHILE_STMT, label);
+        NodeIndex kids[] = {cond, body};
+        ast.setChildren(id, kids, 2);
+        return id;
+    }
+
+    Node check(size_t label, const Token &check,
+               const std::vector<Token> &params) {
+        Node id = ast.addNode(ASTNodeType::CHECK_STMT, label);
+        ast.setTokens(id, check, params);
+        return id;
+    }
+
+    Node nop(size_t label) { return ast.addNode(ASTNodeType::NOP_STMT, label); }
+
+    Node call(size_t label, const Token &calleeName,
+              const std::vector<Token> &args) {
+        Node id = ast.addNode(ASTNodeType::CALL_STMT, label);
+        ast.setTokens(id, calleeName, args);
+        return id;
+    }
+
+    Node function(size_t label, const Token &funcName,
+                  const std::vector<Token> &args, Node body) {
+        Node id = ast.addNode(ASTNodeType::FUNCTION, label);
+        ast.setTokens(id, funcName, args);
+        ast.setChildren(id, &body, 1);
+        return id;
+    }
+
+private:
+    Node begin(ASTNodeType type, size_t label) {
+        openMarks.push_back(pending.size());
+        return ast.addNode(type, label);
+    }
+
+    void finish(Node id) {
+        size_t mark = openMarks.back();
+        openMarks.pop_back();
+        ast.setChildren(id, pending.data() + mark, pending.size() - mark);
+        pending.resize(mark);
+    }
+};
+
+} // namespace fdlang
+
+#endif
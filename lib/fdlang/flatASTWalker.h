@@ -0,0 +1,79 @@
+#ifndef FDLANG_FLATASTWALKER_H
+#define FDLANG_FLATASTWALKER_H
+
+#include "flatAST.h"
+
+namespace fdlang {
+
+/**
+ * Statically dispatched traversal of a FlatAST. walk() switches on
+ * FlatNode::type and calls Derived::visit with the flat:: view of the node,
+ * so a pass reads the arrays in place instead of a materialized pointer AST.
+ * The default visit() of every node walks its children in source order; a
+ * pass defines only the overloads it cares about and brings the others in
+ * with `using FlatASTWalker<Derived>::visit;'.
+ *
+ * If the derived visits are private, the derived class has to befriend
+ * FlatASTWalker<Derived>.
+ */
+template <typename Derived> class FlatASTWalker {
+private:
+    Derived &derived() { return static_cast<Derived &>(*this); }
+
+public:
+    void walk(FlatNodeRef ref) {
+        switch (ref.ast->node(ref.id).type) {
+        case ASTNodeType::STMTS:
+            return derived().visit(flat::Stmts::of(ref));
+        case ASTNodeType::COND:
+            return derived().visit(flat::Cond::of(ref));
+        case ASTNodeType::BINARY_ASSIGN_STMT:
+            return derived().visit(flat::BinaryAssignStmt::of(ref));
+        case ASTNodeType::UNARY_ASSIGN_STMT:
+            return derived().visit(flat::UnaryAssignStmt::of(ref));
+        case ASTNodeType::IF_STMT:
+            return derived().visit(flat::IfStmt::of(ref));
+        case ASTNodeType::WHILE_STMT:
+            return derived().visit(flat::WhileStmt::of(ref));
+        case ASTNodeType::CHECK_STMT:
+            return derived().visit(flat::CheckStmt::of(ref));
+        case ASTNodeType::NOP_STMT:
+            return derived().visit(flat::NopStmt::of(ref));
+        case ASTNodeType::CALL_STMT:
+            return derived().visit(flat::CallStmt::of(ref));
+        case ASTNodeType::FUNCTION:
+            return derived().visit(flat::FunctionNode::of(ref));
+        case ASTNodeType::FUNCTIONS:
+            return derived().visit(flat::FunctionNodes::of(ref));
+        }
+    }
+
+    void visit(const flat::Stmts &node) {
+        for (FlatNodeRef child : node.children)
+            walk(child);
+    }
+    void visit(const flat::Cond &node) {}
+    void visit(const flat::UnaryAssignStmt &node) {}
+    void visit(const flat::BinaryAssignStmt &node) {}
+    void visit(const flat::IfStmt &node) {
+        walk(node.cond);
+        walk(node.trueBody);
+        walk(node.falseBody);
+    }
+    void visit(const flat::WhileStmt &node) {
+        walk(node.cond);
+        walk(node.body);
+    }
+    void visit(const flat::CheckStmt &node) {}
+    void visit(const flat::NopStmt &node) {}
+    void visit(const flat::CallStmt &node) {}
+    void visit(const flat::FunctionNodes &node) {
+        for (FlatNodeRef child : node.children)
+            walk(child);
+    }
+    void visit(const flat::FunctionNode &node) { walk(node.body); }
+};
+
+} // namespace fdlang
+
+#endif
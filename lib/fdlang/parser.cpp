@@ -3,49 +3,75 @@
 #include "fdlang/AST.h"
 #include "token.h"
 
+#include "IR/IRLoweringBuilder.h"
+
 #include <assert.h>
 
 using namespace fdlang;
 
-ASTNode *Parser::parse() { return parseFunctions(); }
+template <typename Builder> auto BasicParser<Builder>::parse() -> Node {
+    return parseFunctions();
+}
 
-const Token &Parser::advance() {
+template <typename Builder> Token BasicParser<Builder>::pull() {
+    if (scanner)
+        return scanner->nextToken();
+    // stay on the trailing END_OF_FILE
+    const Token &token = (*tokens)[nextIndex];
+    if (token.type != TokenType::END_OF_FILE)
+        nextIndex++;
+    return token;
+}
+
+template <typename Builder> Token BasicParser<Builder>::advance() {
     if (isAtEnd()) {
         hasError = true;
         error(peek().line, "Parsing error, got EOF");
-        return tokens.back();
+        return peek();
     }
     current++;
-    return tokens[current - 1];
+    return previous();
 }
 
-bool Parser::isAtEnd() { return peek().type == TokenType::END_OF_FILE; }
+template <typename Builder> bool BasicParser<Builder>::isAtEnd() {
+    return peek().type == TokenType::END_OF_FILE;
+}
 
-const Token &Parser::peek() { return tokens[current]; }
+template <typename Builder>
+const Token &BasicParser<Builder>::peek(size_t k) {
+    assert(k + 1 < LOOKAHEAD && "Lookahead exceeds the token window");
+    while (pulled <= current + k)
+        window[pulled++ % LOOKAHEAD] = pull();
+    return window[(current + k) % LOOKAHEAD];
+}
 
-const Token &Parser::previous() { return tokens[current - 1]; }
+template <typename Builder> const Token &BasicParser<Builder>::previous() {
+    assert(current > 0 && "No token consumed yet");
+    return window[(current - 1) % LOOKAHEAD];
+}
 
-bool Parser::consume(TokenType type) {
-    const Token &token = advance();
+template <typename Builder> bool BasicParser<Builder>::consume(TokenType type) {
+    Token token = advance();
     if (token.type != type) {
         hasError = true;
         error(peek().line, "Parsing error, expect " + getTokenSpelling(type) +
-                               " got " + peek().lexeme);
+                               " got " + std::string(peek().lexeme));
         return false;
     }
     return true;
 }
 
-ASTNode *Parser::parseStmts() {
-    Stmts *stmts = new Stmts(label++);
+template <typename Builder> auto BasicParser<Builder>::parseStmts() -> Node {
+    Node stmts = builder.beginStmts(label++);
     while (!isAtEnd() && peek().type != TokenType::RIGHT_BRACE && !hasError) {
-        stmts->addChild(parseStmt());
+        builder.addStmt(stmts, parseStmt());
     }
+    builder.finishStmts(stmts);
     return stmts;
 }
 
-ASTNode *Parser::parseStmt() {
-    const Token &token = advance();
+template <typename Builder> auto BasicParser<Builder>::parseStmt() -> Node {
+    Token token = advance();
     switch (token.type) {
     case TokenType::IDENTIFIER:
         return parseAssignStmt();
@@ -61,204 +87,220 @@ ASTNode *Parser::parseStmt() {
         return parseCallStmt();
     default:
         hasError = true;
-        error(token.line, "Parsing error, got " + token.lexeme);
+        error(token.line,
+              "Parsing error, got " + std::string(token.lexeme));
         break;
     }
-    return nullptr;
+    return builder.none();
 }
 
-ASTNode *Parser::parseAssignStmt() {
-    if (current + 2 >= tokens.size()) {
+template <typename Builder>
+auto BasicParser<Builder>::parseAssignStmt() -> Node {
+    if (isAtEnd() || peek(1).type == TokenType::END_OF_FILE) {
         hasError = true;
-        error(peek().line, "Parsing error, got " + peek().lexeme);
-        return nullptr;
+        error(peek().line,
+              "Parsing error, got " + std::string(peek().lexeme));
+        return builder.none();
     }
-    TokenType type = tokens[current + 2].type;
+    TokenType type = peek(2).type;
     if (type == TokenType::PLUS || type == TokenType::MINUS)
         return parseBinaryAssignStmt();
     return parseUnaryAssignStmt();
 }
 
-ASTNode *Parser::parseIfStmt() {
+template <typename Builder> auto BasicParser<Builder>::parseIfStmt() -> Node {
     if (!consume(TokenType::LEFT_PAREN))
-        return nullptr;
-    ASTNode *cond = parseCond();
+        return builder.none();
+    Node cond = parseCond();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_PAREN))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::LEFT_BRACE))
-        return nullptr;
-    ASTNode *trueBody = parseStmts();
+        return builder.none();
+    Node trueBody = parseStmts();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_BRACE))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::ELSE))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::LEFT_BRACE))
-        return nullptr;
-    ASTNode *falseBody = parseStmts();
+        return builder.none();
+    Node falseBody = parseStmts();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_BRACE))
-        return nullptr;
-    return new IfStmt(label++, cond, trueBody, falseBody);
+        return builder.none();
+    return builder.ifStmt(label++, cond, trueBody, falseBody);
 }
 
-ASTNode *Parser::parseWhileStmt() {
+template <typename Builder>
+auto BasicParser<Builder>::parseWhileStmt() -> Node {
     if (!consume(TokenType::LEFT_PAREN))
-        return nullptr;
-    ASTNode *cond = parseCond();
+        return builder.none();
+    Node cond = parseCond();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_PAREN))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::LEFT_BRACE))
-        return nullptr;
-    ASTNode *body = parseStmts();
+        return builder.none();
+    Node body = parseStmts();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_BRACE))
-        return nullptr;
-    return new WhileStmt(label++, cond, body);
+        return builder.none();
+    return builder.whileStmt(label++, cond, body);
 }
 
-ASTNode *Parser::parseCheckIntervalStmt() {
-    const Token &check = previous();
+template <typename Builder>
+auto BasicParser<Builder>::parseCheckIntervalStmt() -> Node {
+    Token check = previous();
     if (!consume(TokenType::LEFT_PAREN))
-        return nullptr;
-    const Token &param0 = advance();
+        return builder.none();
+    Token param0 = advance();
     if (!consume(TokenType::COMMA))
-        return nullptr;
-    const Token &param1 = advance();
+        return builder.none();
+    Token param1 = advance();
     if (!consume(TokenType::COMMA))
-        return nullptr;
-    const Token &param2 = advance();
+        return builder.none();
+    Token param2 = advance();
     if (!consume(TokenType::RIGHT_PAREN))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::SEMICOLON))
-        return nullptr;
-    return new CheckStmt(label++, check, {param0, param1, param2});
+        return builder.none();
+    return builder.check(label++, check, {param0, param1, param2});
 }
 
-ASTNode *Parser::parseNopStmt() {
-    const Token &nop = previous();
+template <typename Builder> auto BasicParser<Builder>::parseNopStmt() -> Node {
+    // only for its assertion that the `nop' keyword was consumed
+    previous();
     if (!consume(TokenType::SEMICOLON))
-        return nullptr;
-    return new NopStmt(label++);
+        return builder.none();
+    return builder.nop(label++);
 }
 
-ASTNode *Parser::parseBinaryAssignStmt() {
-    const Token &variable = previous();
+template <typename Builder>
+auto BasicParser<Builder>::parseBinaryAssignStmt() -> Node {
+    Token variable = previous();
 
     if (!consume(TokenType::EQUAL))
-        return nullptr;
-    const Token &leftOperand = advance();
-    const Token &op = advance();
-    const Token &rightOperand = advance();
+        return builder.none();
+    Token leftOperand = advance();
+    Token op = advance();
+    Token rightOperand = advance();
     if (!consume(TokenType::SEMICOLON))
-        return nullptr;
+        return builder.none();
 
-    return new BinaryAssignStmt(label++, variable, leftOperand, op,
+    return builder.binaryAssign(label++, variable, leftOperand, op,
                                 rightOperand);
 }
 
-ASTNode *Parser::parseUnaryAssignStmt() {
-    const Token &variable = previous();
+template <typename Builder>
+auto BasicParser<Builder>::parseUnaryAssignStmt() -> Node {
+    Token variable = previous();
 
     if (!consume(TokenType::EQUAL))
-        return nullptr;
-    const Token &operand = advance();
+        return builder.none();
+    Token operand = advance();
     if (operand.type == TokenType::CALL_INPUT) {
         if (!consume(TokenType::LEFT_PAREN))
-            return nullptr;
+            return builder.none();
         if (!consume(TokenType::RIGHT_PAREN))
-            return nullptr;
+            return builder.none();
     }
     if (!consume(TokenType::SEMICOLON))
-        return nullptr;
+        return builder.none();
 
-    return new UnaryAssignStmt(label++, variable, operand);
+    return builder.unaryAssign(label++, variable, operand);
 }
 
-ASTNode *Parser::parseCond() {
-    const Token &leftOperand = advance();
-    const Token &op = advance();
-    const Token &rightOperand = advance();
+template <typename Builder> auto BasicParser<Builder>::parseCond() -> Node {
+    Token leftOperand = advance();
+    Token op = advance();
+    Token rightOperand = advance();
 
-    return new Cond(label++, leftOperand, op, rightOperand);
+    return builder.cond(label++, leftOperand, op, rightOperand);
 }
 
-ASTNode *Parser::parseCallStmt() {
-    const Token &funcName = advance();
+template <typename Builder> auto BasicParser<Builder>::parseCallStmt() -> Node {
+    Token funcName = advance();
     if (!consume(TokenType::LEFT_PAREN))
-        return nullptr;
+        return builder.none();
 
     std::vector<Token> args;
-    TokenType type = tokens[current].type;
-    while (type != TokenType::RIGHT_PAREN) {
+    TokenType type = peek().type;
+    while (type != TokenType::RIGHT_PAREN && !hasError) {
         if (type == TokenType::COMMA) {
             if (!consume(TokenType::COMMA))
-                return nullptr;
-            type = tokens[current].type;
+                return builder.none();
+            type = peek().type;
             continue;
         }
         args.push_back(advance());
-        type = tokens[current].type;
+        type = peek().type;
     }
 
     if (!consume(TokenType::RIGHT_PAREN))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::SEMICOLON))
-        return nullptr;
+        return builder.none();
 
-    return new CallStmt(label++, funcName, args);
+    return builder.call(label++, funcName, args);
 }
 
-ASTNode *Parser::parseFunctions() {
-    FunctionNodes *functions = new FunctionNodes(label++);
+template <typename Builder>
+auto BasicParser<Builder>::parseFunctions() -> Node {
+    Node functions = builder.beginFunctions(label++);
     while (!isAtEnd() && peek().type != TokenType::RIGHT_BRACE && !hasError) {
-        functions->addChild(parseFunction());
+        builder.addFunction(functions, parseFunction());
     }
-    functions->addCallee();
+    // a failed parse leaves null children behind, so callees stay unlinked
+    builder.finishFunctions(functions, !hasError);
 
     return functions;
 }
 
-ASTNode *Parser::parseFunction() {
+template <typename Builder> auto BasicParser<Builder>::parseFunction() -> Node {
     if (!consume(TokenType::FUNCTION))
-        return nullptr;
+        return builder.none();
 
-    const Token &funcName = advance();
+    Token funcName = advance();
 
     if (!consume(TokenType::LEFT_PAREN))
-        return nullptr;
+        return builder.none();
     std::vector<Token> args;
-    TokenType type = tokens[current].type;
-    while (type != TokenType::RIGHT_PAREN) {
+    TokenType type = peek().type;
+    while (type != TokenType::RIGHT_PAREN && !hasError) {
         if (type == TokenType::COMMA) {
             if (!consume(TokenType::COMMA))
-                return nullptr;
-            type = tokens[current].type;
+                return builder.none();
+            type = peek().type;
             continue;
         }
         args.push_back(advance());
-        type = tokens[current].type;
+        type = peek().type;
     }
 
     if (!consume(TokenType::RIGHT_PAREN))
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::LEFT_BRACE))
-        return nullptr;
+        return builder.none();
 
-    ASTNode *body = parseStmts();
+    Node body = parseStmts();
     if (hasError)
-        return nullptr;
+        return builder.none();
     if (!consume(TokenType::RIGHT_BRACE))
-        return nullptr;
+        return builder.none();
+
+    return builder.function(label++, funcName, args, body);
+}
 
-    return new FunctionNode(label++, funcName, args, body);
+template <typename Builder> bool BasicParser<Builder>::hadError() {
+    return hasError;
 }
 
-bool Parser::hadError() { return hasError; }
\ No newline at end of file
+template class fdlang::BasicParser<ASTBuilder>;
+template class fdlang::BasicParser<FlatASTBuilder>;
+template class fdlang::BasicParser<IR::IRLoweringBuilder>;
\ No newline at end of file
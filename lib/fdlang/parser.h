@@ -2,64 +2,110 @@
 #define FDLANG_PARSER_H
 
 #include "AST.h"
+#include "ASTBuilder.h"
+#include "flatAST.h"
+#include "scanner.h"
 #include "token.h"
 
 #include <vector>
 
 namespace fdlang {
 
-class Parser {
+/**
+ * Recursive descent parser reporting each completed node to `Builder', see
+ * ASTBuilder for the interface a builder provides
+ */
+template <typename Builder> class BasicParser {
+public:
+    using Node = typename Builder::Node;
+
 private:
-    const std::vector<Token> tokens;
-    size_t start = 0;
+    // The previous token plus up to LOOKAHEAD - 1 upcoming ones
+    static const size_t LOOKAHEAD = 4;
+
+    // Tokens are pulled from exactly one of these
+    Scanner *scanner = nullptr;
+    const std::vector<Token> *tokens = nullptr;
+    size_t nextIndex = 0;
+
+    Token window[LOOKAHEAD];
+    // number of tokens consumed and pulled so far
     size_t current = 0;
+    size_t pulled = 0;
     size_t label = 0;
     bool hasError = false;
+    Builder builder;
 
 public:
-    Parser(const std::vector<Token> &tokens) : tokens(tokens) {}
+    /**
+     * @brief Parse tokens pulled on demand from `scanner', which is never
+     * asked for more than a few tokens ahead
+     */
+    BasicParser(Scanner &scanner) : scanner(&scanner) {}
+
+    // `tokens' must end with END_OF_FILE and outlive the parser
+    BasicParser(const std::vector<Token> &tokens) : tokens(&tokens) {}
 
-    ASTNode *parse();
+    Node parse();
 
-    const Token &advance();
+    Token advance();
 
     bool isAtEnd();
 
-    const Token &peek();
+    const Token &peek(size_t k = 0);
 
     const Token &previous();
 
     bool consume(TokenType type);
 
-    ASTNode *parseStmts();
+    Node parseStmts();
 
-    ASTNode *parseStmt();
+    Node parseStmt();
 
-    ASTNode *parseAssignStmt();
+    Node parseAssignStmt();
 
-    ASTNode *parseCheckIntervalStmt();
+    Node parseCheckIntervalStmt();
 
-    ASTNode *parseIfStmt();
+    Node parseIfStmt();
 
-    ASTNode *parseWhileStmt();
+    Node parseWhileStmt();
 
-    ASTNode *parseNopStmt();
+    Node parseNopStmt();
 
-    ASTNode *parseBinaryAssignStmt();
+    Node parseBinaryAssignStmt();
 
-    ASTNode *parseUnaryAssignStmt();
+    Node parseUnaryAssignStmt();
 
-    ASTNode *parseCond();
+    Node parseCond();
 
-    ASTNode *parseCallStmt();
+    Node parseCallStmt();
 
-    ASTNode *parseFunctions();
+    Node parseFunctions();
 
-    ASTNode *parseFunction();
+    Node parseFunction();
 
     bool hadError();
+
+    /**
+     * @brief Number of labels handed out so far, the nodes parsed are
+     * labelled 0 to getLabelCount() - 1
+     */
+    size_t getLabelCount() const { return label; }
+
+    Builder &getBuilder() { return builder; }
+
+private:
+    Token pull();
 };
 
+// Builds the pointer AST
+using Parser = BasicParser<ASTBuilder>;
+// Builds a FlatAST, available from getBuilder().getAST()
+using FlatParser = BasicParser<FlatASTBuilder>;
+
+extern template class BasicParser<ASTBuilder>;
+extern template class BasicParser<FlatASTBuilder>;
+
 } // namespace fdlang
 
 #endif
\ No newline at end of file
@@ -1,13 +1,23 @@
 #include "scanner.h"
+#include "charScan.h"
 #include "errorHandler.h"
 #include "fdlang/token.h"
 
+#include <algorithm>
 #include <cctype>
+#include <climits>
 #include <cstdlib>
 
 using namespace fdlang;
 
-const std::unordered_map<std::string, TokenType> Scanner::keywords = {
+namespace {
+
+struct Keyword {
+    std::string_view spelling;
+    TokenType type;
+};
+
+constexpr Keyword keywordList[] = {
     {"if", TokenType::IF},
     {"else", TokenType::ELSE},
     {"while", TokenType::WHILE},
@@ -17,14 +27,63 @@ const std::unordered_map<std::string, TokenType> Scanner::keywords = {
     {"call", TokenType::CALL},
     {"function", TokenType::FUNCTION}};
 
+const size_t KEYWORD_SLOTS = 16;
+
+// Perfect for the keywords above, checked by the static_assert below
+constexpr size_t keywordHash(std::string_view s) {
+    return (2 * (unsigned char)s.front() + (unsigned char)s.back() +
+            s.size()) &
+           (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable {
+    Keyword slots[KEYWORD_SLOTS] = {};
+    bool collision = false;
+
+    constexpr KeywordTable() {
+        for (const Keyword &kw : keywordList) {
+            Keyword &slot = slots[keywordHash(kw.spelling)];
+            if (!slot.spelling.empty())
+                collision = true;
+            slot = kw;
+        }
+    }
+};
+
+constexpr KeywordTable keywordTable;
+static_assert(!keywordTable.collision, "keywordHash is not perfect");
+
+} // namespace
+
+std::optional<TokenType> Scanner::keywordType(std::string_view text) {
+    // keywordHash reads the first and last character
+    if (text.empty())
+        return std::nullopt;
+    const Keyword &slot = keywordTable.slots[keywordHash(text)];
+    if (slot.spelling.empty() || slot.spelling != text)
+        return std::nullopt;
+    return slot.type;
+}
+
 std::vector<Token> Scanner::scanTokens() {
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(nextToken());
+    } while (tokens.back().type != TokenType::END_OF_FILE);
+    return tokens;
+}
+
+Token Scanner::nextToken() {
     while (!isAtEnd()) {
         start = current;
         scanToken();
+        if (scanned) {
+            Token token = *scanned;
+            scanned.reset();
+            return token;
+        }
     }
-
-    tokens.emplace_back(TokenType::END_OF_FILE, "", nullptr, line);
-    return tokens;
+    return Token(TokenType::END_OF_FILE, "", Literal(), line);
 }
 
 void Scanner::scanToken() {
@@ -66,9 +125,8 @@ void Scanner::scanToken() {
     case ' ':
     case '\t':
     case '\r':
-        break;
     case '\n':
-        line++;
+        whitespace(c);
         break;
     default:
         if (std::isdigit(c)) {
@@ -89,11 +147,11 @@ char Scanner::advance() {
 
 bool Scanner::isAtEnd() { return current >= source.size(); }
 
-void Scanner::addToken(TokenType type) { addToken(type, nullptr); }
+void Scanner::addToken(TokenType type) { addToken(type, Literal()); }
 
-void Scanner::addToken(TokenType type, const std::any &literal) {
-    std::string text = source.substr(start, current - start);
-    tokens.emplace_back(type, text, literal, line);
+void Scanner::addToken(TokenType type, Literal literal) {
+    scanned.emplace(type, source.substr(start, current - start), literal,
+                    line);
 }
 
 bool Scanner::match(char expected) {
@@ -112,24 +170,46 @@ char Scanner::peek() {
     return source[current];
 }
 
+void Scanner::whitespace(char c) {
+    if (vectorized) {
+        const char *begin = source.data(), *end = begin + source.size();
+        current = skipWhitespace(begin + start, end, line) - begin;
+    } else if (c == '\n') {
+        line++;
+    }
+}
+
 void Scanner::number() {
-    while (std::isdigit(peek()))
-        advance();
+    if (vectorized) {
+        const char *begin = source.data(), *end = begin + source.size();
+        current = skipDigits(begin + current, end) - begin;
+    } else {
+        while (std::isdigit(peek()))
+            advance();
+    }
 
-    long long num = std::stoll(source.substr(start, current - start));
-    addToken(TokenType::NUMBER, num);
+    // Saturate instead of overflowing, Sema rejects anything above 255 anyway
+    long long num = 0;
+    for (size_t i = start; i < current; i++)
+        num = std::min(num * 10 + (source[i] - '0'), (long long)INT_MAX);
+    addToken(TokenType::NUMBER, Literal::ofNumber(num));
 }
 
 void Scanner::identifier() {
-    while (std::isalnum(peek()) || peek() == '_')
-        advance();
+    if (vectorized) {
+        const char *begin = source.data(), *end = begin + source.size();
+        current = skipIdentifier(begin + current, end) - begin;
+    } else {
+        while (std::isalnum(peek()) || peek() == '_')
+            advance();
+    }
 
-    std::string text = source.substr(start, current - start);
-    auto it = keywords.find(text);
-    if (it == keywords.end())
-        addToken(TokenType::IDENTIFIER);
+    std::string_view text = source.substr(start, current - start);
+    if (std::optional<TokenType> keyword = keywordType(text))
+        addToken(*keyword);
     else
-        addToken(it->second);
+        addToken(TokenType::IDENTIFIER,
+                 Literal::ofSymbol(SymbolTable::global().intern(text)));
 }
 
 bool Scanner::hadError() { return hasError; }
\ No newline at end of file
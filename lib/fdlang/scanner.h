@@ -3,28 +3,49 @@
 
 #include "token.h"
 
-#include <unordered_map>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 namespace fdlang {
 class Scanner {
 private:
-    std::string source;
-    std::vector<Token> tokens;
+    // not owned, see SourceBuffer
+    std::string_view source;
+    // the token produced by the last scanToken(), if any
+    std::optional<Token> scanned;
     size_t start = 0;
     size_t current = 0;
     size_t line = 1;
     bool hasError = false;
-
-    static const std::unordered_map<std::string, TokenType> keywords;
+    // classify whitespace, digit and identifier runs a block at a time
+    bool vectorized;
 
 public:
-    Scanner(const std::string &source) : source(source) {}
+    /**
+     * @brief Scan `source', numbering its first line `firstLine', so that a
+     * slice of a larger file reports the file's line numbers
+     */
+    Scanner(std::string_view source, bool vectorized = true,
+            size_t firstLine = 1)
+        : source(source), line(firstLine), vectorized(vectorized) {}
 
     std::vector<Token> scanTokens();
 
+    /**
+     * @brief Scan and return the next token. Once the source is exhausted,
+     * every call returns END_OF_FILE.
+     */
+    Token nextToken();
+
     bool hadError();
 
+    /**
+     * @brief The keyword spelled by `text', or nullopt for an ordinary
+     * identifier
+     */
+    static std::optional<TokenType> keywordType(std::string_view text);
+
 private:
     void scanToken();
 
@@ -34,12 +55,14 @@ private:
 
     void addToken(TokenType type);
 
-    void addToken(TokenType type, const std::any &literal);
+    void addToken(TokenType type, Literal literal);
 
     bool match(char expected);
 
     char peek();
 
+    void whitespace(char c);
+
     void number();
 
     void identifier();
@@ -7,83 +7,134 @@ using namespace fdlang;
 
 void Sema::visit(Stmts *node) {
     for (ASTNode *child : node->children) {
-        child->accept(this);
+        walk(child);
     }
 }
 
 void Sema::visit(Cond *node) {
-    checkVariable(node->leftOperand);
-    checkCondOp(node->op);
-    checkNumber(node->rightOperand);
+    checkCond(node->leftOperand, node->op, node->rightOperand);
 }
 
 void Sema::visit(UnaryAssignStmt *node) {
-    checkVariable(node->variable);
-    checkValueOrInput(node->operand);
+    checkUnaryAssign(node->variable, node->operand);
 }
 
 void Sema::visit(BinaryAssignStmt *node) {
-    checkVariable(node->variable);
-    checkValue(node->leftOperand);
-    checkArithmeticOp(node->op);
-    checkValue(node->rightOperand);
+    checkBinaryAssign(node->variable, node->leftOperand, node->op,
+                      node->rightOperand);
 }
 
 void Sema::visit(IfStmt *node) {
-    node->cond->accept(this);
-    node->trueBody->accept(this);
-    node->falseBody->accept(this);
+    walk(node->cond);
+    walk(node->trueBody);
+    walk(node->falseBody);
 }
 
 void Sema::visit(WhileStmt *node) {
-    node->cond->accept(this);
-    node->body->accept(this);
+    walk(node->cond);
+    walk(node->body);
 }
 
-void Sema::visit(CheckStmt *node) {
-    switch (node->check.type) {
-    case TokenType::CALL_CHECK_INTERVAL: {
-        checkVariable(node->params[0]);
-        checkNumber(node->params[1]);
-        checkNumber(node->params[2]);
-        break;
-    }
-    default:
-        hasError = true;
-        error(node->check.line, "Sema error, expect CALL_CHECK got " +
-                                    getTokenSpelling(node->check.type) + "(" +
-                                    node->check.lexeme + ")");
-    }
-}
+void Sema::visit(CheckStmt *node) { checkCheck(node->check, node->params); }
 
 void Sema::visit(NopStmt *node) {}
 
-void Sema::visit(CallStmt *node) {
-    for (auto param : node->args) {
-        checkValue(param);
-    }
-}
+void Sema::visit(CallStmt *node) { checkCall(node->calleeName, node->args); }
 
 void Sema::visit(FunctionNodes *node) {
     for (ASTNode *child : node->children) {
-        child->accept(this);
+        walk(child);
     }
 }
 
 void Sema::visit(FunctionNode *node) {
-    for (auto param : node->args) {
-        checkValue(param);
+    checkFunction(node->funcName, node->args);
+    walk(node->body);
+}
+
+void Sema::visit(const flat::Cond &node) {
+    checkCond(node.leftOperand, node.op, node.rightOperand);
+}
+
+void Sema::visit(const flat::UnaryAssignStmt &node) {
+    checkUnaryAssign(node.variable, node.operand);
+}
+
+void Sema::visit(const flat::BinaryAssignStmt &node) {
+    checkBinaryAssign(node.variable, node.leftOperand, node.op,
+                      node.rightOperand);
+}
+
+void Sema::visit(const flat::CheckStmt &node) {
+    checkCheck(node.check, node.params);
+}
+
+void Sema::visit(const flat::CallStmt &node) {
+    checkCall(node.calleeName, node.args);
+}
+
+void Sema::visit(const flat::FunctionNode &node) {
+    checkFunction(node.funcName, node.args);
+    walk(node.body);
+}
+
+bool Sema::checkCond(const Token &leftOperand, const Token &op,
+                     const Token &rightOperand) {
+    bool ok = checkVariable(leftOperand);
+    ok = checkCondOp(op) && ok;
+    return checkNumber(rightOperand) && ok;
+}
+
+bool Sema::checkUnaryAssign(const Token &variable, const Token &operand) {
+    bool ok = checkVariable(variable);
+    return checkValueOrInput(operand) && ok;
+}
+
+bool Sema::checkBinaryAssign(const Token &variable, const Token &leftOperand,
+                             const Token &op, const Token &rightOperand) {
+    bool ok = checkVariable(variable);
+    ok = checkValue(leftOperand) && ok;
+    ok = checkArithmeticOp(op) && ok;
+    return checkValue(rightOperand) && ok;
+}
+
+bool Sema::checkCheck(const Token &check, TokenRange params) {
+    switch (check.type) {
+    case TokenType::CALL_CHECK_INTERVAL: {
+        bool ok = checkVariable(params[0]);
+        ok = checkNumber(params[1]) && ok;
+        return checkNumber(params[2]) && ok;
     }
-    node->body->accept(this);
+    default:
+        fail(check.line, "Sema error, expect CALL_CHECK got " +
+                             getTokenSpelling(check.type) + "(" +
+                             std::string(check.lexeme) + ")");
+    }
+    return false;
+}
+
+bool Sema::checkCall(const Token &calleeName, TokenRange args) {
+    bool ok = checkVariable(calleeName);
+    for (auto param : args) {
+        ok = checkValue(param) && ok;
+    }
+    return ok;
+}
+
+bool Sema::checkFunction(const Token &funcName, TokenRange args) {
+    bool ok = checkVariable(funcName);
+    for (auto param : args) {
+        ok = checkVariable(param) && ok;
+    }
+    return ok;
 }
 
 bool Sema::checkVariable(const Token &token) {
     if (token.type != TokenType::IDENTIFIER) {
-        hasError = true;
-        error(token.line, "Sema error, expect " +
-                              getTokenSpelling(TokenType::IDENTIFIER) +
-                              " got " + getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect " +
+                             getTokenSpelling(TokenType::IDENTIFIER) +
+                             " got " + getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     return true;
@@ -91,10 +142,9 @@ bool Sema::checkVariable(const Token &token) {
 
 bool Sema::checkCondOp(const Token &token) {
     if (!token.isCondOp()) {
-        hasError = true;
-        error(token.line, "Sema error, expect CONDITIONAL_OPERATOR got " +
-                              getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect CONDITIONAL_OPERATOR got " +
+                             getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     return true;
@@ -102,17 +152,15 @@ bool Sema::checkCondOp(const Token &token) {
 
 bool Sema::checkNumber(const Token &token) {
     if (token.type != TokenType::NUMBER) {
-        hasError = true;
-        error(token.line, "Sema error, expect " +
-                              getTokenSpelling(TokenType::NUMBER) + " got " +
-                              getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect " +
+                             getTokenSpelling(TokenType::NUMBER) + " got " +
+                             getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     long long val = token.getLiteralAsNumber();
     if (val < 0 || val > 255) {
-        hasError = true;
-        error(token.line, "Sema error, the number should be between 0 and 255");
+        fail(token.line, "Sema error, the number should be between 0 and 255");
         return false;
     }
     return true;
@@ -120,10 +168,9 @@ bool Sema::checkNumber(const Token &token) {
 
 bool Sema::checkArithmeticOp(const Token &token) {
     if (!token.isArithmeticOp()) {
-        hasError = true;
-        error(token.line, "Sema error, expect ARITHEMETIC_OPERATOR got " +
-                              getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect ARITHEMETIC_OPERATOR got " +
+                             getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     return true;
@@ -131,10 +178,9 @@ bool Sema::checkArithmeticOp(const Token &token) {
 
 bool Sema::checkValue(const Token &token) {
     if (!token.isValue()) {
-        hasError = true;
-        error(token.line, "Sema error, expect VALUE got " +
-                              getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect VALUE got " +
+                             getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     return true;
@@ -142,16 +188,26 @@ bool Sema::checkValue(const Token &token) {
 
 bool Sema::checkValueOrInput(const Token &token) {
     if (!token.isValue() && token.type != TokenType::CALL_INPUT) {
-        hasError = true;
-        error(token.line, "Sema error, expect VALUE or CALL_INPUT got " +
-                              getTokenSpelling(token.type) + "(" +
-                              token.lexeme + ")");
+        fail(token.line, "Sema error, expect VALUE or CALL_INPUT got " +
+                             getTokenSpelling(token.type) + "(" +
+                             std::string(token.lexeme) + ")");
         return false;
     }
     return true;
 }
 
+void Sema::fail(size_t line, const std::string &msg) {
+    hasError = true;
+    if (deferred)
+        deferred->push_back({line, msg});
+    else
+        error(line, msg);
+}
+
 bool Sema::check() {
-    root->accept(this);
+    if (flatRoot.ast)
+        walk(flatRoot);
+    else
+        walk(root);
     return !hasError;
 }
\ No newline at end of file
@@ -2,26 +2,55 @@
 #define FDLANG_SEMA_H
 
 #include "AST.h"
-#include "ASTVisitor.h"
+#include "ASTWalker.h"
+#include "flatAST.h"
+#include "flatASTWalker.h"
+#include "token.h"
+
+#include <string>
+#include <vector>
 
 namespace fdlang {
 
-class Sema : public ASTVisitor {
+class Sema : public ASTWalker<Sema>, public FlatASTWalker<Sema> {
+public:
+    // a diagnostic held back by deferReports()
+    struct Report {
+        size_t line;
+        std::string msg;
+    };
+
 private:
-    ASTNode *root;
+    friend class ASTWalker<Sema>;
+    friend class FlatASTWalker<Sema>;
+
+    ASTNode *root = nullptr;
+    FlatNodeRef flatRoot;
     bool hasError = false;
+    std::vector<Report> *deferred = nullptr;
+
+    void visit(Stmts *node);
+    void visit(Cond *node);
+    void visit(UnaryAssignStmt *node);
+    void visit(BinaryAssignStmt *node);
+    void visit(IfStmt *node);
+    void visit(WhileStmt *node);
+    void visit(CheckStmt *node);
+    void visit(NopStmt *node);
+    void visit(CallStmt *node);
+    void visit(FunctionNodes *node);
+    void visit(FunctionNode *node);
 
-    void visit(Stmts *node) override;
-    void visit(Cond *node) override;
-    void visit(UnaryAssignStmt *node) override;
-    void visit(BinaryAssignStmt *node) override;
-    void visit(IfStmt *node) override;
-    void visit(WhileStmt *node) override;
-    void visit(CheckStmt *node) override;
-    void visit(NopStmt *node) override;
-    void visit(CallStmt *node) override;
-    void visit(FunctionNodes *node) override;
-    void visit(FunctionNode *node) override;
+    using ASTWalker<Sema>::walk;
+    using FlatASTWalker<Sema>::walk;
+    // the nodes without checks of their own walk their children
+    using FlatASTWalker<Sema>::visit;
+    void visit(const flat::Cond &node);
+    void visit(const flat::UnaryAssignStmt &node);
+    void visit(const flat::BinaryAssignStmt &node);
+    void visit(const flat::CheckStmt &node);
+    void visit(const flat::CallStmt &node);
+    void visit(const flat::FunctionNode &node);
 
     bool checkVariable(const Token &token);
     bool checkCondOp(const Token &token);
@@ -30,10 +59,38 @@ private:
     bool checkValue(const Token &token);
     bool checkValueOrInput(const Token &token);
 
+    void fail(size_t line, const std::string &msg);
+
 public:
-    Sema(ASTNode *root) : root(root) {}
+    Sema(ASTNode *root = nullptr) : root(root) {}
+
+    /**
+     * @brief Check the FlatAST below `root' in place
+     */
+    Sema(FlatNodeRef root) : flatRoot(root) {}
 
     bool check();
+
+    bool hadError() { return hasError; }
+
+    /**
+     * @brief Append diagnostics to `reports' instead of printing them
+     */
+    void deferReports(std::vector<Report> *reports) { deferred = reports; }
+
+    /**
+     * @brief Checks of single nodes given by their tokens, for clients that
+     * never build the AST. Like check(), they report every error found and
+     * return false if there was any.
+     */
+    bool checkCond(const Token &leftOperand, const Token &op,
+                   const Token &rightOperand);
+    bool checkUnaryAssign(const Token &variable, const Token &operand);
+    bool checkBinaryAssign(const Token &variable, const Token &leftOperand,
+                           const Token &op, const Token &rightOperand);
+    bool checkCheck(const Token &check, TokenRange params);
+    bool checkCall(const Token &calleeName, TokenRange args);
+    bool checkFunction(const Token &funcName, TokenRange args);
 };
 
 } // namespace fdlang
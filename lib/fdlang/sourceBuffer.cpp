@@ -0,0 +1,70 @@
+#include "sourceBuffer.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FDLANG_HAVE_MMAP 1
+#endif
+
+using namespace fdlang;
+
+SourceBuffer::SourceBuffer(const std::string &path) {
+    if (map(path))
+        return;
+    hasError = !read(path);
+}
+
+SourceBuffer::~SourceBuffer() {
+#ifdef FDLANG_HAVE_MMAP
+    if (mapped)
+        munmap(const_cast<char *>(data), length);
+#endif
+}
+
+bool SourceBuffer::map(const std::string &path) {
+#ifdef FDLANG_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+    data = static_cast<const char *>(addr);
+    length = st.st_size;
+    mapped = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SourceBuffer::read(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    file.seekg(0, std::ios::end);
+    std::streamoff fileLength = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    owned.resize(fileLength);
+    file.read(owned.data(), fileLength);
+
+    data = owned.data();
+    length = owned.size();
+    return true;
+}
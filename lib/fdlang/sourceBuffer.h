@@ -0,0 +1,47 @@
+#ifndef FDLANG_SOURCEBUFFER_H
+#define FDLANG_SOURCEBUFFER_H
+
+#include <string>
+#include <string_view>
+
+namespace fdlang {
+
+/**
+ * @brief Read-only text of a source file
+ *
+ * On POSIX systems the file is memory-mapped so that scanning does not copy
+ * it; elsewhere (or if mapping fails) it is read into an owned string.
+ * Token lexemes point into this buffer, so it must outlive every Token, AST
+ * node and IR value built from it.
+ */
+class SourceBuffer {
+private:
+    const char *data = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::string owned;
+    bool hasError = false;
+
+    bool map(const std::string &path);
+    bool read(const std::string &path);
+
+public:
+    SourceBuffer(const std::string &path);
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    ~SourceBuffer();
+
+    std::string_view text() const { return std::string_view(data, length); }
+
+    size_t size() const { return length; }
+
+    bool isMapped() const { return mapped; }
+
+    bool hadError() const { return hasError; }
+};
+
+} // namespace fdlang
+
+#endif
@@ -0,0 +1,50 @@
+#include "symbol.h"
+
+#include <assert.h>
+#include <mutex>
+
+using namespace fdlang;
+
+SymbolTable::SymbolTable() { intern(""); }
+
+SymbolTable &SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    // another thread may have interned it in between
+    auto it = ids.find(name);
+    if (it != ids.end())
+        return it->second;
+
+    SymbolId id = names.size();
+    const std::string &stored = names.emplace_back(name);
+    ids.emplace(stored, id);
+    return id;
+}
+
+SymbolId SymbolTable::lookup(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(name);
+    return it == ids.end() ? EmptySymbol : it->second;
+}
+
+std::string_view SymbolTable::name(SymbolId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    assert(id < names.size() && "Unknown symbol");
+    return names[id];
+}
+
+size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names.size();
+}
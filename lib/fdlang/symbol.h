@@ -0,0 +1,71 @@
+#ifndef FDLANG_SYMBOL_H
+#define FDLANG_SYMBOL_H
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace fdlang {
+
+/**
+ * Dense id of an interned identifier (variable or function name). Ids are
+ * handed out consecutively from 0, so they can index plain arrays.
+ */
+using SymbolId = uint32_t;
+
+/**
+ * The empty name, always interned as id 0. It never names a variable or a
+ * function; the zone domain uses it for the constant-zero variable V0.
+ */
+const SymbolId EmptySymbol = 0;
+
+/**
+ * Safe to use from several threads; lookups take a shared lock and only
+ * interning a new name takes the exclusive one.
+ */
+class SymbolTable {
+private:
+    // std::deque never moves its elements, so views into them stay valid
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, SymbolId> ids;
+    mutable std::shared_mutex mutex;
+
+public:
+    SymbolTable();
+
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    /**
+     * @brief The table shared by the scanner, AST, IR and analyses
+     */
+    static SymbolTable &global();
+
+    /**
+     * @brief Get the id of `name', interning it on first use
+     */
+    SymbolId intern(std::string_view name);
+
+    /**
+     * @brief Get the id of `name' if it has been interned, EmptySymbol if not
+     */
+    SymbolId lookup(std::string_view name) const;
+
+    std::string_view name(SymbolId id) const;
+
+    /**
+     * @brief Number of interned symbols, i.e. one past the largest id
+     */
+    size_t size() const;
+};
+
+inline std::string_view symbolName(SymbolId id) {
+    return SymbolTable::global().name(id);
+}
+
+} // namespace fdlang
+
+#endif
@@ -1,6 +1,5 @@
 #include "token.h"
 
-#include <any>
 #include <assert.h>
 
 using namespace fdlang;
@@ -65,7 +64,12 @@ std::string fdlang::getTokenSpelling(TokenType type) {
 
 long long Token::getLiteralAsNumber() const {
     assert(type == TokenType::NUMBER);
-    return std::any_cast<long long>(literal);
+    return literal.getAsNumber();
+}
+
+SymbolId Token::getLiteralAsSymbol() const {
+    assert(type == TokenType::IDENTIFIER);
+    return literal.getAsSymbol();
 }
 
 bool Token::isCondOp() const {
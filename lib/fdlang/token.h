@@ -1,8 +1,13 @@
 #ifndef FDLANG_TOKEN_H
 #define FDLANG_TOKEN_H
 
-#include <any>
+#include "symbol.h"
+
+#include <assert.h>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace fdlang {
 
@@ -43,18 +48,75 @@ enum class TokenType {
     END_OF_FILE
 };
 
+/**
+ * Payload of a token: nothing, an 8-byte number or a SymbolId
+ */
+class Literal {
+public:
+    enum class Kind : unsigned char { None, Number, Symbol };
+
+private:
+    Kind kind = Kind::None;
+    union {
+        long long number;
+        SymbolId symbol;
+    };
+
+public:
+    Literal() : number(0) {}
+
+    static Literal ofNumber(long long number) {
+        Literal ret;
+        ret.kind = Kind::Number;
+        ret.number = number;
+        return ret;
+    }
+
+    static Literal ofSymbol(SymbolId symbol) {
+        Literal ret;
+        ret.kind = Kind::Symbol;
+        ret.symbol = symbol;
+        return ret;
+    }
+
+    Kind getKind() const { return kind; }
+
+    bool hasValue() const { return kind != Kind::None; }
+
+    bool isNumber() const { return kind == Kind::Number; }
+
+    bool isSymbol() const { return kind == Kind::Symbol; }
+
+    long long getAsNumber() const {
+        assert(isNumber());
+        return number;
+    }
+
+    SymbolId getAsSymbol() const {
+        assert(isSymbol());
+        return symbol;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Literal>);
+
 struct Token {
-    const TokenType type;
-    const std::string lexeme;
-    const std::any literal;
-    const size_t line;
+    TokenType type = TokenType::END_OF_FILE;
+    // points into the source text, which must outlive the token
+    std::string_view lexeme;
+    Literal literal;
+    size_t line = 0;
 
-    Token(TokenType type, const std::string &lexeme, const std::any &literal,
+    Token() = default;
+
+    Token(TokenType type, std::string_view lexeme, Literal literal,
           size_t line)
         : type(type), lexeme(lexeme), literal(literal), line(line) {}
 
     long long getLiteralAsNumber() const;
 
+    SymbolId getLiteralAsSymbol() const;
+
     bool isCondOp() const;
 
     bool isArithmeticOp() const;
@@ -64,6 +126,30 @@ struct Token {
     bool isFunction() const;
 };
 
+// A view of consecutive tokens, such as a call's arguments
+class TokenRange {
+private:
+    const Token *first = nullptr;
+    const Token *last = nullptr;
+
+public:
+    TokenRange() = default;
+    TokenRange(const Token *first, size_t size)
+        : first(first), last(first + size) {}
+    TokenRange(const std::vector<Token> &tokens)
+        : TokenRange(tokens.data(), tokens.size()) {}
+
+    const Token *begin() const { return first; }
+    const Token *end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+
+    const Token &operator[](size_t i) const {
+        assert(i < size());
+        return first[i];
+    }
+};
+
 std::string getTokenSpelling(TokenType type);
 
 } // namespace fdlang
@@ -0,0 +1,157 @@
+#include "frontend.h"
+#include "threadPool.h"
+
+#include "fdlang/ASTWalker.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+
+using namespace fdlang;
+using namespace fdlang::frontend;
+
+namespace {
+
+// Moves every label of a subtree by `delta'
+class Relabel : public ASTWalker<Relabel> {
+private:
+    long long delta;
+
+public:
+    Relabel(long long delta) : delta(delta) {}
+
+    template <typename Node> void visit(Node *node) {
+        node->label += delta;
+        ASTWalker<Relabel>::visit(node);
+    }
+};
+
+} // namespace
+
+std::vector<SourceChunk> fdlang::frontend::splitFunctions(
+    std::string_view source) {
+    std::vector<SourceChunk> chunks;
+    size_t begin = 0, beginLine = 1, line = 1, depth = 0;
+    bool blank = true;
+    for (size_t i = 0; i < source.size(); i++) {
+        char c = source[i];
+        if (c == '\n') {
+            line++;
+            continue;
+        }
+        // parseFunctions() stops silently at a stray `}' at the top level,
+        // so nothing after it is parsed
+        if (c == '}' && depth == 0) {
+            if (!blank)
+                chunks.push_back({begin, i + 1, beginLine});
+            return chunks;
+        }
+        if (c != ' ' && c != '\t' && c != '\r')
+            blank = false;
+        if (c == '{') {
+            depth++;
+        } else if (c == '}') {
+            if (--depth == 0) {
+                chunks.push_back({begin, i + 1, beginLine});
+                begin = i + 1;
+                beginLine = line;
+                blank = true;
+            }
+        }
+    }
+    if (!blank)
+        chunks.push_back({begin, source.size(), beginLine});
+    return chunks;
+}
+
+FunctionUnit::~FunctionUnit() {
+    for (ASTNode *function : functions)
+        delete function;
+}
+
+void fdlang::frontend::buildUnit(std::string_view source,
+                                 const SourceChunk &chunk,
+                                 FunctionUnit &unit) {
+    Scanner scanner(source.substr(chunk.begin, chunk.end - chunk.begin),
+                    true, chunk.line);
+    Parser parser(scanner);
+    FunctionNodes *parsed = static_cast<FunctionNodes *>(parser.parse());
+    unit.functions.swap(parsed->children);
+    delete parsed;
+    // every label but the FunctionNodes' 0
+    unit.numLabels = parser.getLabelCount() - 1;
+    unit.labelOffset = 0;
+    if (scanner.hadError() || parser.hadError())
+        return;
+
+    bool ok = true;
+    for (ASTNode *function : unit.functions) {
+        Sema sema(function);
+        ok = sema.check() && ok;
+    }
+    if (!ok)
+        return;
+
+    for (ASTNode *function : unit.functions) {
+        unit.builders.push_back(std::make_unique<IR::IRBuilder>(function));
+        IR::Functions lowered = unit.builders.back()->lower();
+        unit.irFunctions.insert(unit.irFunctions.end(), lowered.begin(),
+                                lowered.end());
+    }
+    unit.ok = true;
+}
+
+FunctionNodes *
+fdlang::frontend::linkUnits(const std::vector<FunctionUnit *> &units,
+                            IR::Functions &functions) {
+    FunctionNodes *root = new FunctionNodes(0);
+    functions.clear();
+    size_t offset = 0;
+    for (FunctionUnit *unit : units) {
+        // a single parse labels the chunks one after another after the root
+        if (unit->labelOffset != offset) {
+            Relabel relabel((long long)offset - (long long)unit->labelOffset);
+            for (ASTNode *function : unit->functions)
+                relabel.walk(function);
+            unit->labelOffset = offset;
+        }
+        offset += unit->numLabels;
+        for (ASTNode *function : unit->functions)
+            root->addChild(function);
+        functions.insert(functions.end(), unit->irFunctions.begin(),
+                         unit->irFunctions.end());
+    }
+    root->addCallee();
+    IR::IRBuilder::link(functions);
+    return root;
+}
+
+void fdlang::frontend::releaseRoot(FunctionNodes *root) {
+    if (!root)
+        return;
+    root->children.clear();
+    delete root;
+}
+
+Frontend::~Frontend() { releaseRoot(root); }
+
+bool Frontend::run() {
+    std::vector<SourceChunk> chunks = splitFunctions(source);
+    units = std::vector<FunctionUnit>(chunks.size());
+
+    ThreadPool pool(numThreads);
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        buildUnit(source, chunks[i], units[i]);
+    });
+
+    std::vector<FunctionUnit *> linked;
+    for (FunctionUnit &unit : units) {
+        if (!unit.ok)
+            hasError = true;
+        linked.push_back(&unit);
+    }
+    if (hasError)
+        return false;
+
+    root = linkUnits(linked, functions);
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef FRONTEND_FRONTEND_H
+#define FRONTEND_FRONTEND_H
+
+#include "IR/IR.h"
+#include "IR/IRBuilder.h"
+#include "fdlang/AST.h"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fdlang::frontend {
+
+/**
+ * A top-level function's slice of the source: bytes [begin, end), the
+ * first of which is on line `line'
+ */
+struct SourceChunk {
+    size_t begin, end;
+    size_t line;
+};
+
+/**
+ * @brief Split `source' after every `}' closing a top-level brace pair.
+ * Whitespace between functions goes to the following chunk, and trailing
+ * text that is not whitespace becomes a chunk of its own. Like the parser,
+ * the split ends at a `}' that closes nothing: the text up to it becomes
+ * the last chunk unless it is blank, and the text after it is dropped.
+ */
+std::vector<SourceChunk> splitFunctions(std::string_view source);
+
+/**
+ * The AST and IR of one chunk, lowered but not linked. Owns the AST nodes
+ * and, through its builders, the IR.
+ */
+struct FunctionUnit {
+    std::vector<ASTNode *> functions;
+    // the AST labels of the chunk are 1 to numLabels plus labelOffset, the
+    // offset the last link moved them by
+    size_t numLabels = 0;
+    size_t labelOffset = 0;
+    // owners of irFunctions, one per function
+    std::vector<std::unique_ptr<IR::IRBuilder>> builders;
+    IR::Functions irFunctions;
+    bool ok = false;
+
+    FunctionUnit() = default;
+    FunctionUnit(FunctionUnit &&) = default;
+    FunctionUnit &operator=(FunctionUnit &&) = default;
+    ~FunctionUnit();
+};
+
+/**
+ * @brief Scan, parse, check and lower `chunk' of `source'. unit.ok tells
+ * whether all of it succeeded. Safe to call from several threads.
+ */
+void buildUnit(std::string_view source, const SourceChunk &chunk,
+               FunctionUnit &unit);
+
+/**
+ * @brief Gather the functions of `units' in order under a new FunctionNodes,
+ * relabel the AST nodes program-wide as a single parse labels them, link
+ * AST callees and link their IR into `functions'. The units keep owning the
+ * nodes, so free the result with releaseRoot().
+ */
+FunctionNodes *linkUnits(const std::vector<FunctionUnit *> &units,
+                         IR::Functions &functions);
+
+/**
+ * @brief Delete a root made by linkUnits() but not the nodes under it
+ */
+void releaseRoot(FunctionNodes *root);
+
+/**
+ * Frontend running scanning, parsing, Sema and IR lowering of every
+ * top-level function concurrently, followed by a sequential link step that
+ * gathers the functions in source order, resolves callees and assigns
+ * program-wide labels.
+ *
+ * The result matches the sequential Scanner, Parser, Sema and
+ * IRBuilder::build pipeline, except that diagnostics of different functions
+ * may interleave.
+ */
+class Frontend {
+private:
+    std::string_view source;
+    unsigned numThreads;
+    FunctionNodes *root = nullptr;
+    IR::Functions functions;
+    std::vector<FunctionUnit> units;
+    bool hasError = false;
+
+public:
+    /**
+     * @brief `source' must outlive the frontend. numThreads 0 uses one
+     * thread per hardware thread.
+     */
+    Frontend(std::string_view source, unsigned numThreads = 0)
+        : source(source), numThreads(numThreads) {}
+
+    ~Frontend();
+
+    Frontend(const Frontend &) = delete;
+    Frontend &operator=(const Frontend &) = delete;
+
+    /**
+     * @brief Run the frontend, return false on any scan, parse or Sema error
+     */
+    bool run();
+
+    /**
+     * @brief The whole program's AST, owned by the frontend
+     */
+    ASTNode *getAST() { return root; }
+
+    /**
+     * @brief The linked IR, owned by the frontend
+     */
+    IR::Functions getFunctions() { return functions; }
+
+    bool hadError() { return hasError; }
+};
+
+} // namespace fdlang::frontend
+
+#endif
@@ -0,0 +1,169 @@
+#include "incremental.h"
+
+#include "fdlang/ASTWalker.h"
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+using namespace fdlang;
+using namespace fdlang::frontend;
+
+namespace {
+
+// Moves a reused function to its new lines and drops its old callee links
+class Rebase : public ASTWalker<Rebase> {
+private:
+    long long delta;
+
+    void shift(Token &token) { token.line += delta; }
+
+public:
+    Rebase(long long delta) : delta(delta) {}
+
+    using ASTWalker<Rebase>::visit;
+
+    void visit(Cond *node) {
+        shift(node->leftOperand);
+        shift(node->op);
+        shift(node->rightOperand);
+    }
+
+    void visit(UnaryAssignStmt *node) {
+        shift(node->variable);
+        shift(node->operand);
+    }
+
+    void visit(BinaryAssignStmt *node) {
+        shift(node->variable);
+        shift(node->leftOperand);
+        shift(node->op);
+        shift(node->rightOperand);
+    }
+
+    void visit(CheckStmt *node) {
+        shift(node->check);
+        for (Token &param : node->params)
+            shift(param);
+    }
+
+    void visit(CallStmt *node) {
+        shift(node->calleeName);
+        for (Token &arg : node->args)
+            shift(arg);
+        node->callee = nullptr;
+    }
+
+    void visit(FunctionNode *node) {
+        shift(node->funcName);
+        for (Token &arg : node->args)
+            shift(arg);
+        node->setRoot(true);
+        ASTWalker<Rebase>::visit(node);
+    }
+};
+
+} // namespace
+
+uint64_t fdlang::frontend::fingerprint(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+IncrementalFrontend::~IncrementalFrontend() { releaseRoot(root); }
+
+bool IncrementalFrontend::update(std::string_view newSource) {
+    releaseRoot(root);
+    root = nullptr;
+    functions.clear();
+    hasError = false;
+    numReused = numRebuilt = 0;
+
+    auto source = std::make_shared<const std::string>(newSource);
+    std::vector<SourceChunk> chunks = splitFunctions(*source);
+
+    // index the previous program by fingerprint. Copies of a function are
+    // reused in order from the front, so matching stays linear however many
+    // there are; a fingerprint collision only costs a rebuild.
+    std::unordered_map<uint64_t, std::deque<size_t>> previous;
+    for (size_t i = 0; i < units.size(); i++)
+        previous[units[i]->hash].push_back(i);
+
+    std::vector<std::unique_ptr<CachedUnit>> next(chunks.size());
+    std::vector<size_t> toBuild;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        // fingerprint from the first non-blank character, so that blank
+        // lines inserted above a function do not invalidate it
+        SourceChunk &chunk = chunks[i];
+        for (; chunk.begin < chunk.end; chunk.begin++) {
+            char c = (*source)[chunk.begin];
+            if (c == '\n')
+                chunk.line++;
+            else if (c != ' ' && c != '\t' && c != '\r')
+                break;
+        }
+        std::string_view text(source->data() + chunk.begin,
+                              chunk.end - chunk.begin);
+        uint64_t hash = fingerprint(text);
+
+        auto it = previous.find(hash);
+        if (it != previous.end() && !it->second.empty() &&
+            units[it->second.front()]->text == text) {
+            next[i] = std::move(units[it->second.front()]);
+            it->second.pop_front();
+        }
+
+        if (next[i]) {
+            CachedUnit &unit = *next[i];
+            long long delta = (long long)chunk.line - (long long)unit.line;
+            Rebase rebase(delta);
+            for (ASTNode *function : unit.unit.functions)
+                rebase.walk(function);
+            if (delta != 0)
+                for (IR::Function *function : unit.unit.irFunctions)
+                    for (IR::Inst *inst : function->getInsts())
+                        if (inst->getInstType() ==
+                            IR::InstType::CheckIntervalInst) {
+                            auto *check = (IR::CheckIntervalInst *)inst;
+                            check->setLine(check->getLine() + delta);
+                        }
+            unit.line = chunk.line;
+            numReused++;
+        } else {
+            next[i] = std::make_unique<CachedUnit>();
+            next[i]->source = source;
+            next[i]->text = text;
+            next[i]->line = chunk.line;
+            next[i]->hash = hash;
+            toBuild.push_back(i);
+        }
+    }
+
+    pool.parallelFor(toBuild.size(), [&](size_t i) {
+        buildUnit(*source, chunks[toBuild[i]], next[toBuild[i]]->unit);
+    });
+    numRebuilt = toBuild.size();
+
+    // functions that disappeared are freed here
+    units = std::move(next);
+
+    std::vector<FunctionUnit *> linked;
+    for (auto &unit : units) {
+        if (!unit->unit.ok) {
+            hasError = true;
+            // rebuild it next time so its diagnostics are reported again
+            unit->hash = 0;
+            unit->text = std::string_view();
+        }
+        linked.push_back(&unit->unit);
+    }
+    if (hasError)
+        return false;
+
+    root = linkUnits(linked, functions);
+    return true;
+}
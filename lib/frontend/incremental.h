@@ -0,0 +1,101 @@
+#ifndef FRONTEND_INCREMENTAL_H
+#define FRONTEND_INCREMENTAL_H
+
+#include "frontend.h"
+#include "threadPool.h"
+
+#include "IR/IR.h"
+#include "fdlang/AST.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fdlang::frontend {
+
+/**
+ * @brief 64-bit FNV-1a hash of `text'
+ */
+uint64_t fingerprint(std::string_view text);
+
+/**
+ * Frontend for a program that is edited and re-analysed repeatedly.
+ *
+ * Each update() splits the new source at function boundaries, as Frontend
+ * does, and fingerprints every function's text. A function whose text was
+ * already seen keeps its AST and IR: only its line numbers are shifted if
+ * it moved. All other functions are scanned, parsed, checked and lowered
+ * on the thread pool. The link step then runs over the whole program
+ * again, relabelling the reused IR, in time linear in its size.
+ *
+ * `fdlang -incremental' keeps one alive and updates it on every request.
+ */
+class IncrementalFrontend {
+private:
+    struct CachedUnit {
+        FunctionUnit unit;
+        // the source version the unit was built from; token lexemes point
+        // into it
+        std::shared_ptr<const std::string> source;
+        // the function's text without leading whitespace, and its first line
+        std::string_view text;
+        size_t line;
+        uint64_t hash;
+    };
+
+    ThreadPool pool;
+    // the current program in source order
+    std::vector<std::unique_ptr<CachedUnit>> units;
+    FunctionNodes *root = nullptr;
+    IR::Functions functions;
+    size_t numReused = 0, numRebuilt = 0;
+    bool hasError = false;
+
+public:
+    /**
+     * @brief numThreads 0 uses one thread per hardware thread
+     */
+    IncrementalFrontend(unsigned numThreads = 0) : pool(numThreads) {}
+
+    ~IncrementalFrontend();
+
+    IncrementalFrontend(const IncrementalFrontend &) = delete;
+    IncrementalFrontend &operator=(const IncrementalFrontend &) = delete;
+
+    /**
+     * @brief Bring the AST and IR up to date with `source', which is copied.
+     * Return false on any scan, parse or Sema error.
+     *
+     * The previous AST and IR are released first, since the functions they
+     * share with the new program are rebased in place. After a failed
+     * update there is no result until the next successful one, though the
+     * functions that did build are still reused by it.
+     */
+    bool update(std::string_view source);
+
+    /**
+     * @brief The whole program's AST, owned by the frontend, or null if
+     * the last update failed
+     */
+    ASTNode *getAST() { return root; }
+
+    /**
+     * @brief The linked IR, owned by the frontend, or empty if the last
+     * update failed
+     */
+    IR::Functions getFunctions() { return functions; }
+
+    bool hadError() { return hasError; }
+
+    /**
+     * @brief Number of functions the last update reused and rebuilt
+     */
+    size_t reusedFunctions() const { return numReused; }
+    size_t rebuiltFunctions() const { return numRebuilt; }
+};
+
+} // namespace fdlang::frontend
+
+#endif
@@ -0,0 +1,65 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+using namespace fdlang::frontend;
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < numThreads; i++)
+        workers.emplace_back([this] { work(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)> &f) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = f;
+        count = n;
+        next = 0;
+        busy = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::work() {
+    size_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock,
+                      [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done.notify_one();
+    }
+}
+
+void ThreadPool::drain() {
+    for (size_t i = next++; i < count; i = next++)
+        task(i);
+}
@@ -0,0 +1,62 @@
+#ifndef FRONTEND_THREADPOOL_H
+#define FRONTEND_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fdlang::frontend {
+
+/**
+ * Fixed set of worker threads running one parallelFor() at a time. The
+ * calling thread takes part as well, so a pool of n threads starts n - 1
+ * workers and a pool of one runs everything inline.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+
+    // the current job: run task(i) for every i < count
+    std::function<void(size_t)> task;
+    size_t count = 0;
+    std::atomic<size_t> next{0};
+    // bumped for each job so that sleeping workers notice a new one
+    size_t generation = 0;
+    size_t busy = 0;
+    bool stopping = false;
+
+public:
+    /**
+     * @brief Start numThreads - 1 workers, or one per hardware thread when
+     * numThreads is 0
+     */
+    explicit ThreadPool(unsigned numThreads = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return workers.size() + 1; }
+
+    /**
+     * @brief Run f(0), ..., f(n - 1) across the pool and return when all
+     * have finished. Indices are handed out in increasing order.
+     */
+    void parallelFor(size_t n, const std::function<void(size_t)> &f);
+
+private:
+    void work();
+
+    void drain();
+};
+
+} // namespace fdlang::frontend
+
+#endif
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+
+#include "IR/IR.h"
+#include "IR/IRArena.h"
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+static Token identifier(std::string_view name) {
+    return Token(TokenType::IDENTIFIER, name,
+                 Literal::ofSymbol(SymbolTable::global().intern(name)), 1);
+}
+
+static Token number(long long value) {
+    return Token(TokenType::NUMBER, "", Literal::ofNumber(value), 1);
+}
+
+TEST(IRArenaTest, ValuesAreShared) {
+    IRArena arena;
+    Value *x = arena.getValue(identifier("x"));
+    EXPECT_EQ(arena.getValue(identifier("x")), x);
+    EXPECT_NE(arena.getValue(identifier("y")), x);
+    EXPECT_EQ(x->getVariableName(), "x");
+
+    Value *one = arena.getValue(number(1));
+    EXPECT_EQ(arena.getValue(number(1)), one);
+    EXPECT_NE(arena.getValue(number(2)), one);
+    EXPECT_EQ(one->getAsNumber(), 1);
+}
+
+TEST(IRArenaTest, InstructionsAreContiguous) {
+    IRArena arena;
+    Value *x = arena.getValue(identifier("x"));
+    Value *one = arena.getValue(number(1));
+
+    std::vector<Inst *> insts;
+    for (int i = 0; i < 100; i++)
+        insts.push_back(arena.create<AddInst>(x, x, one));
+    EXPECT_EQ(arena.size(), 100);
+    for (size_t i = 1; i < insts.size(); i++)
+        EXPECT_EQ((char *)insts[i] - (char *)insts[i - 1], sizeof(AddInst));
+
+    EXPECT_EQ(insts[0]->getOperandSize(), 3);
+    EXPECT_EQ(insts[0]->getOperand(0), x);
+    EXPECT_EQ(insts[0]->getOperand(2), one);
+
+    arena.clear();
+    EXPECT_EQ(arena.size(), 0);
+    EXPECT_EQ(arena.getValue(number(1))->getAsNumber(), 1);
+}
+
+TEST(IRArenaTest, CallArguments) {
+    IRArena arena;
+    std::vector<Value *> values = {arena.getValue(identifier("a")),
+                                   arena.getValue(number(3)),
+                                   arena.getValue(identifier("a"))};
+    auto call = arena.create<CallInst>(SymbolTable::global().intern("f"),
+                                       arena.copyValues(values));
+    ValueRange args = call->getArgs();
+    ASSERT_EQ(args.size(), 3);
+    EXPECT_EQ(args[0], args[2]);
+    EXPECT_EQ(args[1]->getAsNumber(), 3);
+    EXPECT_EQ(call->getOperandSize(), 0);
+    EXPECT_TRUE(arena.copyValues({}).empty());
+}
+
+// a lowered function refers to each variable and constant through one Value
+TEST(IRArenaTest, LoweredValuesAreShared) {
+    std::string src = "function f(a) {\n"
+                      "    x = a + 1;\n"
+                      "    while (x < 10) { x = x + 1; }\n"
+                      "    call f(x);\n"
+                      "    check_interval(x, 1, 10);\n"
+                      "}\n";
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    Functions funcs = parser.getBuilder().getFunctions();
+    ASSERT_EQ(funcs.size(), 1);
+
+    Value *x = nullptr, *one = nullptr;
+    for (Inst *inst : funcs[0]->getInsts()) {
+        ASSERT_LE(inst->getOperandSize(), Inst::MaxOperands);
+        for (size_t i = 0; i < inst->getOperandSize(); i++) {
+            Value *value = inst->getOperand(i);
+            if (value->isVariable() && value->getVariableName() == "x") {
+                if (!x)
+                    x = value;
+                EXPECT_EQ(value, x);
+            }
+            if (value->isNumber() && value->getAsNumber() == 1) {
+                if (!one)
+                    one = value;
+                EXPECT_EQ(value, one);
+            }
+        }
+        if (inst->getInstType() == InstType::CallInst) {
+            EXPECT_EQ(static_cast<CallInst *>(inst)->getArgs()[0], x);
+        }
+    }
+    EXPECT_NE(x, nullptr);
+    EXPECT_NE(one, nullptr);
+}
+
+// the variable names of `function' in VarId order, after the zero variable
+static std::vector<std::string> varNames(Function *function) {
+    const VarTable &vars = function->getVars();
+    std::vector<std::string> names;
+    for (VarId var = ZeroVar + 1; var < vars.size(); var++)
+        names.emplace_back(vars.getName(var));
+    return names;
+}
+
+TEST(IRArenaTest, VarsArePerFunction) {
+    std::string src = "function f(a, b) {\n"
+                      "    x = a + 1;\n"
+                      "    y = x;\n"
+                      "}\n"
+                      "function g(y) {\n"
+                      "    x = input();\n"
+                      "    y = x - 1;\n"
+                      "}\n";
+    std::vector<std::vector<std::string>> expected = {{"x", "a", "y", "b"},
+                                                      {"x", "y"}};
+
+    Scanner scanner(src);
+    LoweringParser loweringParser(scanner);
+    loweringParser.parse();
+    Functions lowered = loweringParser.getBuilder().getFunctions();
+
+    Scanner astScanner(src);
+    Parser parser(astScanner);
+    ASTNode *root = parser.parse();
+    ASSERT_TRUE(Sema(root).check());
+    IRBuilder irBuilder(root);
+    Functions built = irBuilder.build();
+
+    for (const Functions &funcs : {lowered, built}) {
+        ASSERT_EQ(funcs.size(), 2);
+        for (size_t i = 0; i < funcs.size(); i++) {
+            EXPECT_EQ(varNames(funcs[i]), expected[i]);
+            const VarTable &vars = funcs[i]->getVars();
+            for (Inst *inst : funcs[i]->getInsts())
+                for (size_t j = 0; j < inst->getOperandSize(); j++) {
+                    Value *value = inst->getOperand(j);
+                    if (value->isVariable()) {
+                        EXPECT_EQ(vars.getSymbol(value->getVarId()),
+                                  value->getAsVariable());
+                    }
+                }
+            for (Value *arg : funcs[i]->getArgs())
+                EXPECT_EQ(vars.lookup(arg->getAsVariable()), arg->getVarId());
+        }
+        // a variable of the same name in another function is another Value
+        EXPECT_NE(funcs[0]->getInsts()[1]->getOperand(0),
+                  funcs[1]->getInsts()[1]->getOperand(0));
+        EXPECT_EQ(funcs[0]->getVars().lookup(
+                      SymbolTable::global().intern("nowhere")),
+                  ZeroVar);
+    }
+    delete root;
+}
@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "analysis/intervalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRCache.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+std::string image(const Functions &funcs) {
+    std::stringstream out;
+    IRCache::write(funcs, out);
+    return out.str();
+}
+
+// positions of `insts' in their function
+std::vector<size_t> indices(Function *function, InstRange insts) {
+    std::vector<size_t> ret;
+    for (Inst *inst : insts)
+        ret.push_back(function->getIndex(inst->getLabel()));
+    return ret;
+}
+
+std::vector<std::string> names(const std::vector<Value *> &values) {
+    std::vector<std::string> ret;
+    for (Value *value : values)
+        ret.emplace_back(value->getVariableName());
+    return ret;
+}
+
+std::string intervals(const Functions &funcs) {
+    std::stringstream out;
+    analysis::IntervalAnalysis analysis(funcs);
+    analysis.run();
+    analysis.dumpResult(out);
+    return out.str();
+}
+
+void expectSameFunctions(const Functions &expected, const Functions &actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    auto position = [&](const Functions &funcs, Function *function) {
+        return std::find(funcs.begin(), funcs.end(), function) - funcs.begin();
+    };
+    for (size_t id = 0; id < expected.size(); id++) {
+        Function *x = expected[id], *y = actual[id];
+        EXPECT_EQ(x->funcName, y->funcName);
+        EXPECT_EQ(x->getBeginLabel(), y->getBeginLabel());
+        EXPECT_EQ(x->getEndLabel(), y->getEndLabel());
+        EXPECT_EQ(x->isRoot(), y->isRoot());
+        EXPECT_EQ(names(x->getArgs()), names(y->getArgs()));
+        ASSERT_EQ(x->getVars().size(), y->getVars().size());
+        for (VarId var = 0; var < x->getVars().size(); var++)
+            EXPECT_EQ(x->getVars().getSymbol(var), y->getVars().getSymbol(var));
+
+        ASSERT_EQ(x->getInsts().size(), y->getInsts().size());
+        for (size_t i = 0; i < x->getInsts().size(); i++) {
+            Inst *a = x->getInsts()[i], *b = y->getInsts()[i];
+            std::stringstream dumpA, dumpB;
+            a->dump(dumpA);
+            b->dump(dumpB);
+            EXPECT_EQ(dumpA.str(), dumpB.str());
+            ASSERT_EQ(a->getInstType(), b->getInstType());
+            for (size_t k = 0; k < a->getOperandSize(); k++) {
+                if (a->getOperand(k)->isVariable()) {
+                    EXPECT_EQ(a->getOperand(k)->getVarId(),
+                              b->getOperand(k)->getVarId());
+                }
+            }
+            EXPECT_EQ(indices(x, a->getSuccessors()),
+                      indices(y, b->getSuccessors()));
+            EXPECT_EQ(indices(x, a->getPredecessors()),
+                      indices(y, b->getPredecessors()));
+            if (a->getInstType() == InstType::CheckIntervalInst) {
+                EXPECT_EQ(static_cast<CheckIntervalInst *>(a)->getLine(),
+                          static_cast<CheckIntervalInst *>(b)->getLine());
+            }
+            if (a->getInstType() == InstType::CallInst) {
+                EXPECT_EQ(
+                    position(expected, static_cast<CallInst *>(a)->getCallee()),
+                    position(actual, static_cast<CallInst *>(b)->getCallee()));
+            }
+        }
+    }
+}
+
+TEST(IRCacheTest, RoundTrip) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        Functions funcs = parser->getBuilder().getFunctions();
+
+        // the loaded functions do not refer to the image
+        auto bytes = std::make_unique<std::string>(image(funcs));
+        IRCache cache(*bytes);
+        bytes.reset();
+        ASSERT_FALSE(cache.hadError()) << file;
+        expectSameFunctions(funcs, cache.getFunctions());
+        EXPECT_EQ(intervals(funcs), intervals(cache.getFunctions())) << file;
+        EXPECT_EQ(image(cache.getFunctions()), image(funcs));
+    }
+}
+
+TEST(IRCacheTest, RejectsBadImages) {
+    SourceBuffer src(TESTCASES_DIR "/call1.fdlang");
+    ASSERT_FALSE(src.hadError());
+    auto parser = lower(src.text());
+    std::string bytes = image(parser->getBuilder().getFunctions());
+
+    // every proper prefix is truncated
+    for (size_t size = 0; size < bytes.size(); size += 8) {
+        IRCache cache(std::string_view(bytes.data(), size));
+        EXPECT_TRUE(cache.hadError()) << size;
+        EXPECT_TRUE(cache.getFunctions().empty());
+    }
+
+    std::string badMagic = bytes;
+    badMagic[0] = 'X';
+    EXPECT_TRUE(IRCache(badMagic).hadError());
+
+    // the version follows the 8-byte magic
+    std::string badVersion = bytes;
+    badVersion[8] ^= 0xff;
+    EXPECT_TRUE(IRCache(badVersion).hadError());
+
+    // flipping any single byte never loads anything out of bounds
+    for (size_t i = 0; i < bytes.size(); i++) {
+        std::string corrupt = bytes;
+        corrupt[i] ^= 0x80;
+        IRCache cache(corrupt);
+        if (cache.hadError())
+            continue;
+        for (Function *function : cache.getFunctions())
+            for (Inst *inst : function->getInsts())
+                for (Inst *successor : inst->getSuccessors())
+                    EXPECT_EQ(function->getInstByLabel(successor->getLabel()),
+                              successor);
+    }
+}
+
+TEST(IRCacheTest, RejectsBadOperands) {
+    // every instruction type, with operands of both kinds where allowed
+    auto parser = lower("function main() {\n"
+                        "    x = input();\n"
+                        "    y = 3;\n"
+                        "    while (x < 100) {\n"
+                        "        x = x + 1;\n"
+                        "        y = 7 - y;\n"
+                        "    }\n"
+                        "    if (y == 4) { z = x; } else { nop; }\n"
+                        "    check_interval(x, 100, 255);\n"
+                        "    call f(x, 2);\n"
+                        "}\n"
+                        "function f(a, b) {\n"
+                        "    a = b + 1;\n"
+                        "}\n");
+    std::string bytes = image(parser->getBuilder().getFunctions());
+
+    // replacing any word with a small index, such as an operand's value
+    // index, loads either nothing or operands of the kinds analyses expect
+    size_t loaded = 0;
+    for (size_t i = 0; i + 4 <= bytes.size(); i += 4) {
+        for (uint32_t index = 0; index < 16; index++) {
+            std::string corrupt = bytes;
+            std::memcpy(&corrupt[i], &index, sizeof(index));
+            IRCache cache(corrupt);
+            if (cache.hadError())
+                continue;
+            loaded++;
+            for (Function *function : cache.getFunctions()) {
+                const VarTable &vars = function->getVars();
+                for (Inst *inst : function->getInsts()) {
+                    InstType type = inst->getInstType();
+                    for (size_t k = 0; k < inst->getOperandSize(); k++) {
+                        Value *operand = inst->getOperand(k);
+                        if (operand->isVariable()) {
+                            EXPECT_EQ(vars.getSymbol(operand->getVarId()),
+                                      operand->getAsVariable());
+                        }
+                        if (k == 0 && type != InstType::CallInst) {
+                            EXPECT_TRUE(operand->isVariable()) << i;
+                        }
+                        if (k > 0 && (type == InstType::IfInst ||
+                                      type == InstType::CheckIntervalInst)) {
+                            EXPECT_TRUE(operand->isNumber()) << i;
+                        }
+                    }
+                }
+            }
+            if (!cache.getFunctions().empty())
+                intervals(cache.getFunctions());
+        }
+    }
+    // the words that hold the same index load the same program
+    EXPECT_GT(loaded, 0);
+}
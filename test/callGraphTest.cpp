@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/IR.h"
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/callGraph.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+CallInst *firstCall(Function *function) {
+    for (Inst *inst : function->getInsts())
+        if (inst->getInstType() == InstType::CallInst)
+            return static_cast<CallInst *>(inst);
+    return nullptr;
+}
+
+std::vector<CallGraph::FunctionId> ids(CSRGraph::NodeRange range) {
+    return std::vector<CallGraph::FunctionId>(range.begin(), range.end());
+}
+
+// components are numbered bottom-up and the topological order puts every
+// caller before its callees in other components
+void checkOrder(const CallGraph &graph) {
+    std::vector<size_t> position(graph.size());
+    const std::vector<CallGraph::FunctionId> &order =
+        graph.getTopologicalOrder();
+    ASSERT_EQ(order.size(), graph.size());
+    for (size_t i = 0; i < order.size(); i++)
+        position[order[i]] = i;
+    for (CallGraph::FunctionId caller = 0; caller < graph.size(); caller++) {
+        for (CallGraph::FunctionId callee : graph.getCallees(caller)) {
+            EXPECT_GE(graph.getComponent(caller), graph.getComponent(callee));
+            if (graph.getComponent(caller) != graph.getComponent(callee)) {
+                EXPECT_LT(position[caller], position[callee]);
+            }
+        }
+    }
+}
+
+const std::string program = "function main() {\n"
+                            "    call f(1);\n"
+                            "    call g(2);\n"
+                            "    call f(3);\n"
+                            "}\n"
+                            "function f(a) {\n"
+                            "    nop;\n"
+                            "}\n"
+                            "function g(b) {\n"
+                            "    call h(b);\n"
+                            "}\n"
+                            "function h(c) {\n"
+                            "    call g(c);\n"
+                            "    call f(c);\n"
+                            "}\n"
+                            "function k(d) {\n"
+                            "    call k(d);\n"
+                            "}\n";
+
+TEST(CallGraph, Components) {
+    auto parser = lower(program);
+    Functions funcs = parser->getBuilder().getFunctions();
+    CallGraph graph(funcs);
+    ASSERT_EQ(graph.size(), 5);
+    const CallGraph::FunctionId main = 0, f = 1, g = 2, h = 3, k = 4;
+    EXPECT_EQ(graph.lookup(funcs[h]->funcName), h);
+    EXPECT_EQ(graph.lookup(EmptySymbol), CallGraph::NoFunction);
+
+    // one edge per callee, in the order of the first call
+    EXPECT_EQ(ids(graph.getCallees(main)),
+              (std::vector<CallGraph::FunctionId>{f, g}));
+    EXPECT_EQ(ids(graph.getCallees(h)),
+              (std::vector<CallGraph::FunctionId>{g, f}));
+    EXPECT_EQ(ids(graph.getCallers(f)),
+              (std::vector<CallGraph::FunctionId>{main, h}));
+    EXPECT_EQ(graph.getRoots(), (std::vector<CallGraph::FunctionId>{main}));
+
+    EXPECT_EQ(graph.getComponent(g), graph.getComponent(h));
+    EXPECT_EQ(graph.getMembers(graph.getComponent(g)).size(), 2);
+    EXPECT_EQ(graph.numComponents(), 4);
+    EXPECT_FALSE(graph.isRecursive(main));
+    EXPECT_FALSE(graph.isRecursive(f));
+    EXPECT_TRUE(graph.isRecursive(g));
+    EXPECT_TRUE(graph.isRecursive(k));
+    checkOrder(graph);
+}
+
+TEST(CallGraph, LinkResolvesByName) {
+    // the last function of a name wins, and every one of a called name
+    // stops being a root, as when calls were resolved by scanning
+    auto parser = lower("function main() {\n"
+                        "    call f(1);\n"
+                        "}\n"
+                        "function f(a) {\n"
+                        "    nop;\n"
+                        "}\n"
+                        "function f(b) {\n"
+                        "    nop;\n"
+                        "}\n");
+    Functions funcs = parser->getBuilder().getFunctions();
+    CallInst *call = firstCall(funcs[0]);
+    ASSERT_NE(call, nullptr);
+    EXPECT_EQ(call->getCallee(), funcs[2]);
+    EXPECT_TRUE(funcs[0]->isRoot());
+    EXPECT_FALSE(funcs[1]->isRoot());
+    EXPECT_FALSE(funcs[2]->isRoot());
+
+    // relinking without the callee leaves the call unresolved
+    Functions alone = {funcs[0]};
+    IRBuilder::link(alone);
+    EXPECT_EQ(call->getCallee(), nullptr);
+    CallGraph graph(alone);
+    EXPECT_TRUE(graph.getCallees(0).empty());
+}
+
+TEST(CallGraph, ASTCallees) {
+    Scanner scanner(program);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    auto functions = static_cast<FunctionNodes *>(root);
+    std::vector<FunctionNode *> nodes;
+    for (ASTNode *child : functions->children)
+        nodes.push_back(static_cast<FunctionNode *>(child));
+    auto firstCall = [](FunctionNode *function) {
+        auto body = static_cast<Stmts *>(function->body);
+        return static_cast<CallStmt *>(body->children[0]);
+    };
+    EXPECT_EQ(firstCall(nodes[0])->callee, nodes[1]);
+    EXPECT_EQ(firstCall(nodes[2])->callee, nodes[3]);
+    EXPECT_EQ(firstCall(nodes[4])->callee, nodes[4]);
+    EXPECT_TRUE(nodes[0]->isRoot());
+    for (size_t i = 1; i < nodes.size(); i++)
+        EXPECT_FALSE(nodes[i]->isRoot());
+    delete root;
+}
+
+TEST(CallGraph, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        Functions funcs = parser->getBuilder().getFunctions();
+        CallGraph graph(funcs);
+        for (CallGraph::FunctionId id = 0; id < graph.size(); id++)
+            EXPECT_EQ(graph.getCallers(id).empty(), funcs[id]->isRoot())
+                << file;
+        checkOrder(graph);
+    }
+}
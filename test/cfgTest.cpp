@@ -0,0 +1,207 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/CSRGraph.h"
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/basicBlock.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+// the blocks partition the instructions in order and mirror their edges
+void checkBlocks(Function *function) {
+    BlockGraph graph(function);
+    Insts insts;
+    for (size_t id = 0; id < graph.size(); id++) {
+        BasicBlock *block = graph.getBlock(id);
+        ASSERT_EQ(block->getId(), id);
+        ASSERT_FALSE(block->getInsts().empty());
+        for (Inst *inst : block->getInsts()) {
+            EXPECT_EQ(graph.getBlockOf(inst->getLabel()), block);
+            insts.push_back(inst);
+        }
+
+        // only the first instruction is entered from elsewhere, and only the
+        // last one leaves
+        for (size_t i = 0; i + 1 < block->getInsts().size(); i++) {
+            Inst *inst = block->getInsts()[i];
+            Inst *next = block->getInsts()[i + 1];
+            ASSERT_EQ(inst->getSuccessors().size(), 1);
+            EXPECT_EQ(inst->getSuccessors()[0], next);
+            ASSERT_EQ(next->getPredecessors().size(), 1);
+            EXPECT_EQ(next->getPredecessors()[0], inst);
+        }
+
+        const auto &successors = block->back()->getSuccessors();
+        ASSERT_EQ(block->getSuccessors().size(), successors.size());
+        for (size_t i = 0; i < successors.size(); i++) {
+            EXPECT_EQ(block->getSuccessors()[i]->front(), successors[i]);
+            const auto &predecessors =
+                block->getSuccessors()[i]->getPredecessors();
+            EXPECT_NE(std::find(predecessors.begin(), predecessors.end(),
+                                block),
+                      predecessors.end());
+        }
+        EXPECT_EQ(block->getPredecessors().size(),
+                  block->front()->getPredecessors().size());
+    }
+    EXPECT_EQ(insts, function->getInsts());
+    EXPECT_EQ(graph.getEntry(), graph.getBlock(0));
+}
+
+TEST(CFG, BasicBlocks) {
+    std::string src = "function main() {\n"
+                      "    x = input();\n"
+                      "    y = 0;\n"
+                      "    if (x < 10) {\n"
+                      "        y = 1;\n"
+                      "    } else {\n"
+                      "        nop;\n"
+                      "    }\n"
+                      "    while (y < 5) {\n"
+                      "        y = y + 1;\n"
+                      "    }\n"
+                      "    check_interval(y, 1, 5);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Function *main = parser->getBuilder().getFunctions()[0];
+    checkBlocks(main);
+
+    // L: x = input(); y = 0; if (x < 10) goto T;
+    // goto F;
+    // T: y = 1; goto E;
+    // F:
+    // E:
+    // W: if (y < 5) goto B;
+    // goto X;
+    // B: y = y + 1; goto W;
+    // X: check_interval(y, 1, 5); L:
+    BlockGraph graph(main);
+    ASSERT_EQ(graph.size(), 9);
+    std::vector<size_t> sizes, successors;
+    for (size_t id = 0; id < graph.size(); id++) {
+        sizes.push_back(graph.getBlock(id)->getInsts().size());
+        successors.push_back(graph.getBlock(id)->getSuccessors().size());
+    }
+    EXPECT_EQ(sizes, (std::vector<size_t>{4, 1, 3, 1, 1, 2, 1, 3, 3}));
+    EXPECT_EQ(successors, (std::vector<size_t>{2, 1, 1, 1, 1, 2, 1, 1, 0}));
+
+    // the if block falls through to `goto F' and jumps to T
+    BasicBlock *entry = graph.getEntry();
+    EXPECT_EQ(entry->back()->getInstType(), InstType::IfInst);
+    EXPECT_EQ(entry->getSuccessors()[0], graph.getBlock(1));
+    EXPECT_EQ(entry->getSuccessors()[1], graph.getBlock(2));
+    // the loop head is entered from before the loop and from the body
+    EXPECT_EQ(graph.getBlock(5)->getPredecessors().size(), 2);
+}
+
+TEST(CFG, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        for (Function *function : parser->getBuilder().getFunctions())
+            checkBlocks(function);
+    }
+}
+
+TEST(CFG, FewerBlocksThanInsts) {
+    SourceBuffer src(TESTCASES_DIR "/loop3.fdlang");
+    ASSERT_FALSE(src.hadError());
+    auto parser = lower(src.text());
+    Function *main = parser->getBuilder().getFunctions()[0];
+    BlockGraph graph(main);
+    EXPECT_LE(graph.size() * 2, main->getInsts().size());
+}
+
+TEST(CFG, CSRBuilder) {
+    CSRGraph::Builder builder(4);
+    builder.addEdge(2, 0);
+    builder.addEdge(0, 3);
+    builder.addEdge(0, 1);
+    builder.addEdge(2, 2);
+    builder.addEdge(1, 2);
+    CSRGraph graph = builder.build();
+
+    auto ids = [](CSRGraph::NodeRange range) {
+        return std::vector<NodeId>(range.begin(), range.end());
+    };
+    ASSERT_EQ(graph.size(), 4);
+    EXPECT_EQ(graph.numEdges(), 5);
+    // successors keep their insertion order
+    EXPECT_EQ(ids(graph.successors(0)), (std::vector<NodeId>{3, 1}));
+    EXPECT_EQ(ids(graph.successors(1)), (std::vector<NodeId>{2}));
+    EXPECT_EQ(ids(graph.successors(2)), (std::vector<NodeId>{0, 2}));
+    EXPECT_TRUE(graph.successors(3).empty());
+    EXPECT_EQ(ids(graph.predecessors(0)), (std::vector<NodeId>{2}));
+    EXPECT_EQ(ids(graph.predecessors(2)), (std::vector<NodeId>{2, 1}));
+    EXPECT_EQ(ids(graph.predecessors(3)), (std::vector<NodeId>{0}));
+}
+
+TEST(CFG, CSRMatchesInsts) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        for (Function *function : parser->getBuilder().getFunctions()) {
+            const Insts &insts = function->getInsts();
+            CSRGraph graph = CSRGraph::fromInsts(function);
+            ASSERT_EQ(graph.size(), insts.size());
+            for (NodeId node = 0; node < insts.size(); node++) {
+                Inst *inst = insts[node];
+                EXPECT_EQ(function->getIndex(inst->getLabel()), node);
+                EXPECT_EQ(function->getInstByLabel(inst->getLabel()), inst);
+
+                std::vector<Inst *> successors, predecessors;
+                for (NodeId successor : graph.successors(node))
+                    successors.push_back(insts[successor]);
+                for (NodeId predecessor : graph.predecessors(node))
+                    predecessors.push_back(insts[predecessor]);
+                EXPECT_EQ(successors,
+                          std::vector<Inst *>(inst->getSuccessors().begin(),
+                                              inst->getSuccessors().end()));
+                // predecessors come in instruction order
+                std::vector<Inst *> expected(inst->getPredecessors().begin(),
+                                             inst->getPredecessors().end());
+                std::sort(expected.begin(), expected.end(),
+                          [](Inst *a, Inst *b) {
+                              return a->getLabel() < b->getLabel();
+                          });
+                EXPECT_EQ(predecessors, expected);
+            }
+
+            BlockGraph blocks(function);
+            CSRGraph blockGraph = CSRGraph::fromBlocks(blocks);
+            ASSERT_EQ(blockGraph.size(), blocks.size());
+            for (NodeId node = 0; node < blocks.size(); node++) {
+                const auto &successors =
+                    blocks.getBlock(node)->getSuccessors();
+                ASSERT_EQ(blockGraph.successors(node).size(),
+                          successors.size());
+                for (size_t i = 0; i < successors.size(); i++)
+                    EXPECT_EQ(blockGraph.successors(node)[i],
+                              successors[i]->getId());
+                EXPECT_EQ(blockGraph.predecessors(node).size(),
+                          blocks.getBlock(node)->getPredecessors().size());
+            }
+        }
+    }
+}
@@ -0,0 +1,267 @@
+#include "gtest/gtest.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/ASTTraversePrinter.h"
+#include "fdlang/ASTWalker.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+#include "fdlang/sourceBuffer.h"
+#include "frontend/frontend.h"
+#include "frontend/incremental.h"
+#include "frontend/threadPool.h"
+
+#include "IR/IRBuilder.h"
+
+#include "analysis/modelChecker.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::frontend;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+// the label of every node in walking order
+class LabelPrinter : public ASTWalker<LabelPrinter> {
+private:
+    std::ostream &out;
+
+public:
+    LabelPrinter(std::ostream &out) : out(out) {}
+
+    template <typename Node> void visit(Node *node) {
+        out << node->label << " ";
+        ASTWalker<LabelPrinter>::visit(node);
+    }
+};
+
+std::string dump(ASTNode *root, const IR::Functions &funcs) {
+    std::stringstream out;
+    ASTTraversePrinter printer(out);
+    root->accept(&printer);
+    LabelPrinter labels(out);
+    labels.walk(root);
+    out << "\n";
+    for (IR::Function *func : funcs) {
+        func->dump(out);
+        out << (func->isRoot() ? "root\n" : "callee\n");
+        for (IR::Inst *inst : func->getInsts())
+            if (inst->getInstType() == IR::InstType::CheckIntervalInst)
+                out << "check at line "
+                    << static_cast<IR::CheckIntervalInst *>(inst)->getLine()
+                    << "\n";
+    }
+    return out.str();
+}
+
+std::string sequential(std::string_view src) {
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    EXPECT_FALSE(parser.hadError());
+    Sema sema(root);
+    EXPECT_TRUE(sema.check());
+    IR::IRBuilder irBuilder(root);
+    std::string ret = dump(root, irBuilder.build());
+    delete root;
+    return ret;
+}
+
+TEST(Frontend, SplitFunctions) {
+    std::string src = "function a() { if (x < 1) { nop; } else { nop; } }\n"
+                      "\n"
+                      "function b(x) {\n    nop;\n}\n";
+    std::vector<SourceChunk> chunks = splitFunctions(src);
+    ASSERT_EQ(chunks.size(), 2);
+    EXPECT_EQ(chunks[0].begin, 0);
+    EXPECT_EQ(src[chunks[0].end - 1], '}');
+    EXPECT_EQ(chunks[0].line, 1);
+    EXPECT_EQ(chunks[1].begin, chunks[0].end);
+    EXPECT_EQ(chunks[1].end, src.size() - 1);
+    EXPECT_EQ(chunks[1].line, 1);
+
+    // trailing garbage is kept for the parser to report
+    EXPECT_EQ(splitFunctions(src + "x").size(), 3);
+    EXPECT_EQ(splitFunctions(" \n\t").size(), 0);
+}
+
+TEST(Frontend, MatchesSequential) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+
+        for (unsigned numThreads : {1, 4}) {
+            Frontend frontend(src.text(), numThreads);
+            ASSERT_TRUE(frontend.run()) << file;
+            EXPECT_EQ(dump(frontend.getAST(), frontend.getFunctions()),
+                      sequential(src.text()))
+                << file;
+        }
+    }
+}
+
+TEST(Frontend, StrayBrace) {
+    // the parser stops at a `}' closing nothing, so f is never parsed
+    std::string src = "function main() { a = 1; check_interval(a, 1, 1); } }"
+                      " function f() { b = 2; }";
+    EXPECT_EQ(splitFunctions(src).size(), 1);
+    std::string expected = sequential(src);
+    EXPECT_EQ(expected.find("f("), std::string::npos) << expected;
+
+    for (unsigned numThreads : {1, 2}) {
+        Frontend frontend(src, numThreads);
+        ASSERT_TRUE(frontend.run());
+        EXPECT_EQ(dump(frontend.getAST(), frontend.getFunctions()),
+                  expected);
+    }
+}
+
+std::string modelCheck(ASTNode *root) {
+    analysis::NaiveModelChecker modelChecker(root);
+    modelChecker.run();
+    std::stringstream out;
+    modelChecker.dumpResult(out);
+    return out.str();
+}
+
+TEST(Frontend, ModelChecker) {
+    // the model checker keys its states by AST label, so labels restarting
+    // in every function would merge main's a with f's m
+    std::string src = "function main() {\n    a = 20;\n"
+                      "    check_interval(a, 0, 30);\n    call f(a);\n}\n"
+                      "function f(m) {\n    m = m + 100;\n"
+                      "    check_interval(m, 0, 30);\n}\n";
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    std::string expected = modelCheck(root);
+    delete root;
+    EXPECT_NE(expected.find("Line 3: YES"), std::string::npos) << expected;
+
+    Frontend frontend(src, 2);
+    ASSERT_TRUE(frontend.run());
+    EXPECT_EQ(modelCheck(frontend.getAST()), expected);
+}
+
+TEST(Frontend, LineNumbers) {
+    std::string src = "function f() {\n    nop;\n}\n"
+                      "function main() {\n    x = 1;\n"
+                      "    check_interval(x, 0, 1);\n}\n";
+    Frontend frontend(src, 2);
+    ASSERT_TRUE(frontend.run());
+    IR::Functions funcs = frontend.getFunctions();
+    ASSERT_EQ(funcs.size(), 2);
+
+    size_t line = 0;
+    for (IR::Inst *inst : funcs[1]->getInsts())
+        if (inst->getInstType() == IR::InstType::CheckIntervalInst)
+            line = static_cast<IR::CheckIntervalInst *>(inst)->getLine();
+    EXPECT_EQ(line, 6);
+}
+
+TEST(Frontend, Errors) {
+    std::string parseError = "function f() { nop; }\nfunction g() { x = ; }";
+    Frontend parseFrontend(parseError, 2);
+    EXPECT_FALSE(parseFrontend.run());
+    EXPECT_TRUE(parseFrontend.hadError());
+
+    std::string semaError =
+        "function f() { check_interval(x, 0, 256); }\nfunction g() { nop; }";
+    Frontend semaFrontend(semaError, 2);
+    EXPECT_FALSE(semaFrontend.run());
+}
+
+TEST(Frontend, ThreadPool) {
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3);
+    for (size_t n : {0, 1, 100}) {
+        std::vector<std::atomic<int>> hits(n);
+        pool.parallelFor(n, [&](size_t i) { hits[i]++; });
+        for (size_t i = 0; i < n; i++)
+            EXPECT_EQ(hits[i], 1);
+    }
+}
+
+TEST(Frontend, Incremental) {
+    std::string f = "function f(a) {\n    a = a + 1;\n"
+                    "    check_interval(a, 1, 255);\n}\n";
+    std::string g = "function g() {\n    x = input();\n    call f(x);\n"
+                    "    check_interval(x, 0, 255);\n}\n";
+    std::string h = "function h() {\n    nop;\n}\n";
+    std::string h2 = "function h() {\n    y = 3;\n}\n";
+
+    IncrementalFrontend frontend(2);
+    auto expectUpdate = [&](const std::string &src, size_t reused,
+                            size_t rebuilt) {
+        ASSERT_TRUE(frontend.update(src));
+        EXPECT_EQ(frontend.reusedFunctions(), reused);
+        EXPECT_EQ(frontend.rebuiltFunctions(), rebuilt);
+        EXPECT_EQ(dump(frontend.getAST(), frontend.getFunctions()),
+                  sequential(src));
+    };
+
+    expectUpdate(f + g + h, 0, 3);
+    // unchanged
+    expectUpdate(f + g + h, 3, 0);
+    // one function edited
+    expectUpdate(f + g + h2, 2, 1);
+    // functions move down, their check lines follow
+    expectUpdate("\n\n" + h + f + g, 2, 1);
+    // the callee disappears and comes back
+    expectUpdate(g + h, 2, 0);
+    expectUpdate(g + f + h, 2, 1);
+}
+
+TEST(Frontend, IncrementalErrors) {
+    std::string f = "function f() {\n    nop;\n}\n";
+    std::string broken = "function g() {\n    x = ;\n}\n";
+    std::string fixed = "function g() {\n    x = 1;\n}\n";
+
+    IncrementalFrontend frontend(1);
+    EXPECT_FALSE(frontend.update(f + broken));
+    EXPECT_TRUE(frontend.hadError());
+    EXPECT_EQ(frontend.getAST(), nullptr);
+
+    // a failed function is rebuilt even if its text is unchanged
+    EXPECT_FALSE(frontend.update(f + broken));
+    EXPECT_EQ(frontend.reusedFunctions(), 1);
+
+    ASSERT_TRUE(frontend.update(f + fixed));
+    EXPECT_EQ(frontend.reusedFunctions(), 1);
+    EXPECT_EQ(dump(frontend.getAST(), frontend.getFunctions()),
+              sequential(f + fixed));
+
+    // a failed update leaves no result behind, not the previous one
+    EXPECT_FALSE(frontend.update(f + broken));
+    EXPECT_EQ(frontend.getAST(), nullptr);
+    EXPECT_TRUE(frontend.getFunctions().empty());
+}
+
+TEST(Frontend, IncrementalCopies) {
+    // copies of one function are matched to their previous copies in order
+    std::string f = "function f() {\n    x = 1;\n}\n";
+    std::string g = "function g() {\n    call f();\n}\n";
+    std::string src;
+    for (int i = 0; i < 100; i++)
+        src += f;
+
+    IncrementalFrontend frontend(1);
+    ASSERT_TRUE(frontend.update(src));
+    ASSERT_TRUE(frontend.update(g + src + g));
+    EXPECT_EQ(frontend.reusedFunctions(), 100);
+    EXPECT_EQ(frontend.rebuiltFunctions(), 2);
+    EXPECT_EQ(dump(frontend.getAST(), frontend.getFunctions()),
+              sequential(g + src + g));
+}
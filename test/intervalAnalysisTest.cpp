@@ -5,6 +5,7 @@
 #include "fdlang/parser.h"
 #include "fdlang/scanner.h"
 #include "fdlang/sema.h"
+#include "fdlang/sourceBuffer.h"
 
 #include "analysis/intervalAnalysis.h"
 #include "analysis/modelChecker.h"
@@ -72,16 +73,16 @@ void compare(const std::string &our, const std::string &expected) {
 }
 
 void check(std::string &filepath) {
-    std::string src = readSrc(TESTCASES_DIR "/" + filepath);
+    fdlang::SourceBuffer src(TESTCASES_DIR "/" + filepath);
     std::string expected = readSrc(TESTCASES_DIR "/" + filepath + ".expected");
     std::stringstream result;
 
-    fdlang::Scanner scanner(src);
-    std::vector<fdlang::Token> tokens = scanner.scanTokens();
-    EXPECT_FALSE(scanner.hadError());
+    EXPECT_FALSE(src.hadError());
 
-    fdlang::Parser parser(tokens);
+    fdlang::Scanner scanner(src.text());
+    fdlang::Parser parser(scanner);
     fdlang::ASTNode *root = parser.parse();
+    EXPECT_FALSE(scanner.hadError());
     EXPECT_FALSE(parser.hadError());
 
     fdlang::Sema sema(root);
@@ -0,0 +1,242 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/CSRGraph.h"
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/controlFlowInfo.h"
+#include "IR/dominatorTree.h"
+#include "IR/loopForest.h"
+#include "IR/passManager.h"
+#include "IR/simplifyPasses.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+// the nodes in `loop', header and nested loops included
+std::vector<NodeId> members(const LoopForest &loops, size_t size,
+                            LoopForest::LoopId loop) {
+    std::vector<NodeId> ret;
+    for (NodeId node = 0; node < size; node++)
+        if (loops.contains(loop, node))
+            ret.push_back(node);
+    return ret;
+}
+
+// a header dominates its reducible loop, the loop is closed under paths
+// that stay below the header, and nesting agrees with depths
+void checkLoops(const CSRGraph &graph, const DominatorTree &dominators,
+                const LoopForest &loops) {
+    for (LoopForest::LoopId id = 0; id < loops.size(); id++) {
+        const LoopForest::Loop &loop = loops.getLoop(id);
+        EXPECT_TRUE(loops.isHeader(loop.header));
+        EXPECT_EQ(loops.getLoopFor(loop.header), id);
+        EXPECT_FALSE(loop.latches.empty());
+        if (loop.parent == LoopForest::NoLoop) {
+            EXPECT_EQ(loop.depth, 1);
+        } else {
+            EXPECT_LT(loop.parent, id);
+            EXPECT_EQ(loop.depth, loops.getLoop(loop.parent).depth + 1);
+            EXPECT_TRUE(loops.contains(loop.parent, loop.header));
+        }
+        for (NodeId node : members(loops, graph.size(), id)) {
+            if (loop.reducible) {
+                EXPECT_TRUE(dominators.dominates(loop.header, node));
+            }
+            for (NodeId successor : graph.successors(node)) {
+                bool inside = loops.contains(id, successor);
+                bool exit = std::binary_search(loop.exits.begin(),
+                                               loop.exits.end(), successor);
+                EXPECT_NE(inside, exit);
+            }
+        }
+        for (NodeId latch : loop.latches)
+            EXPECT_TRUE(loops.contains(id, latch));
+    }
+}
+
+TEST(LoopForest, Nested) {
+    // 0 -> 1 -> 2 -> 3 -> 2, 3 -> 4 -> 1, 4 -> 5, 5 -> 5, 5 -> 6
+    CSRGraph graph = makeGraph(
+        8, {{0, 1}, {1, 2}, {2, 3}, {3, 2}, {3, 4}, {4, 1}, {4, 5}, {5, 5},
+            {5, 6}, {7, 6}});
+    DominatorTree dominators(graph, 0);
+    LoopForest loops(graph, 0);
+    checkLoops(graph, dominators, loops);
+
+    ASSERT_EQ(loops.size(), 3);
+    const LoopForest::Loop &outer = loops.getLoop(0);
+    EXPECT_EQ(outer.header, 1);
+    EXPECT_EQ(outer.parent, LoopForest::NoLoop);
+    EXPECT_TRUE(outer.reducible);
+    EXPECT_EQ(outer.latches, (std::vector<NodeId>{4}));
+    EXPECT_EQ(outer.exits, (std::vector<NodeId>{5}));
+    EXPECT_EQ(outer.children, (std::vector<LoopForest::LoopId>{1}));
+    EXPECT_EQ(members(loops, graph.size(), 0),
+              (std::vector<NodeId>{1, 2, 3, 4}));
+
+    const LoopForest::Loop &inner = loops.getLoop(1);
+    EXPECT_EQ(inner.header, 2);
+    EXPECT_EQ(inner.parent, 0);
+    EXPECT_EQ(inner.depth, 2);
+    EXPECT_EQ(inner.latches, (std::vector<NodeId>{3}));
+    EXPECT_EQ(inner.exits, (std::vector<NodeId>{4}));
+
+    // a self-loop is a loop of its own
+    const LoopForest::Loop &self = loops.getLoop(2);
+    EXPECT_EQ(self.header, 5);
+    EXPECT_EQ(self.latches, (std::vector<NodeId>{5}));
+    EXPECT_EQ(self.exits, (std::vector<NodeId>{6}));
+
+    EXPECT_EQ(loops.getDepth(0), 0);
+    EXPECT_EQ(loops.getDepth(1), 1);
+    EXPECT_EQ(loops.getDepth(3), 2);
+    EXPECT_EQ(loops.getDepth(4), 1);
+    EXPECT_EQ(loops.getDepth(5), 1);
+    EXPECT_EQ(loops.getDepth(6), 0);
+    // unreachable nodes are in no loop
+    EXPECT_EQ(loops.getLoopFor(7), LoopForest::NoLoop);
+    EXPECT_FALSE(loops.contains(1, 4));
+}
+
+TEST(LoopForest, Irreducible) {
+    // 1 and 2 are both entered from 0
+    CSRGraph graph =
+        makeGraph(4, {{0, 1}, {0, 2}, {1, 2}, {2, 1}, {2, 3}});
+    DominatorTree dominators(graph, 0);
+    LoopForest loops(graph, 0);
+    checkLoops(graph, dominators, loops);
+
+    ASSERT_EQ(loops.size(), 1);
+    const LoopForest::Loop &loop = loops.getLoop(0);
+    EXPECT_FALSE(loop.reducible);
+    // the entry the search reaches first heads it
+    EXPECT_EQ(loop.header, 1);
+    EXPECT_EQ(loop.latches, (std::vector<NodeId>{2}));
+    EXPECT_EQ(loop.exits, (std::vector<NodeId>{3}));
+    EXPECT_EQ(members(loops, graph.size(), 0), (std::vector<NodeId>{1, 2}));
+}
+
+TEST(LoopForest, Loop3) {
+    SourceBuffer src(TESTCASES_DIR "/loop3.fdlang");
+    ASSERT_FALSE(src.hadError());
+    auto parser = lower(src.text());
+    Function *main = parser->getBuilder().getFunctions()[0];
+    const Insts &insts = main->getInsts();
+    ControlFlowInfo &info = main->getControlFlow();
+    const LoopForest &loops = info.getLoops();
+    checkLoops(info.getGraph(), info.getDominators(), loops);
+
+    // four whiles, each nested in the one before
+    ASSERT_EQ(loops.size(), 4);
+    for (LoopForest::LoopId id = 0; id < loops.size(); id++) {
+        const LoopForest::Loop &loop = loops.getLoop(id);
+        EXPECT_EQ(loop.depth, id + 1);
+        EXPECT_EQ(loop.parent, id == 0 ? LoopForest::NoLoop : id - 1);
+        EXPECT_TRUE(loop.reducible);
+        EXPECT_EQ(insts[loop.header]->getInstType(), InstType::LabelInst);
+        EXPECT_EQ(loop.latches.size(), 1);
+        EXPECT_EQ(loop.exits.size(), 1);
+        if (id > 0) {
+            // an inner loop exits into the body of the one around it
+            EXPECT_TRUE(loops.contains(id - 1, loop.exits[0]));
+            EXPECT_EQ(loops.getLoopFor(loop.exits[0]), id - 1);
+        }
+    }
+
+    // the checks after the loops are in none
+    for (NodeId node = 0; node < insts.size(); node++) {
+        if (insts[node]->getInstType() == InstType::CheckIntervalInst) {
+            EXPECT_EQ(loops.getDepth(node), 0);
+        }
+    }
+}
+
+TEST(LoopForest, PostDominators) {
+    auto parser = lower("function main() {\n"
+                        "  if (x > 0) { y = 1; } else { y = 2; }\n"
+                        "  z = y;\n"
+                        "}\n");
+    Function *main = parser->getBuilder().getFunctions()[0];
+    const Insts &insts = main->getInsts();
+    ControlFlowInfo &info = main->getControlFlow();
+    const DominatorTree &postDominators = info.getPostDominators();
+    const DominatorTree &dominators = info.getDominators();
+    EXPECT_EQ(postDominators.getRoot(), info.getExitNode());
+
+    NodeId branch = 0, join = 0;
+    for (NodeId node = 0; node < insts.size(); node++) {
+        if (insts[node]->getInstType() == InstType::IfInst)
+            branch = node;
+        if (insts[node]->getPredecessors().size() == 2)
+            join = node;
+    }
+    ASSERT_NE(join, 0);
+    // the join post-dominates the branch and everything before it, but
+    // neither arm does; the branch dominates the join
+    for (NodeId node = 0; node <= branch; node++)
+        EXPECT_TRUE(postDominators.dominates(join, node));
+    for (Inst *arm : insts[branch]->getSuccessors()) {
+        NodeId armNode = main->getIndex(arm->getLabel());
+        EXPECT_FALSE(postDominators.dominates(armNode, branch));
+        EXPECT_TRUE(postDominators.dominates(join, armNode));
+    }
+    EXPECT_TRUE(dominators.dominates(branch, join));
+    EXPECT_EQ(info.getLoops().size(), 0);
+}
+
+TEST(LoopForest, CachedUntilChanged) {
+    SourceBuffer src(TESTCASES_DIR "/loop1.fdlang");
+    ASSERT_FALSE(src.hadError());
+    auto parser = lower(src.text());
+    Functions funcs = parser->getBuilder().getFunctions();
+    Function *main = funcs[0];
+    ControlFlowInfo *info = &main->getControlFlow();
+    const LoopForest *loops = &info->getLoops();
+    EXPECT_EQ(&main->getControlFlow(), info);
+    EXPECT_EQ(&info->getLoops(), loops);
+    EXPECT_EQ(loops->size(), 1);
+
+    PassManager manager;
+    addSimplifyPasses(manager);
+    manager.run(funcs);
+    ControlFlowInfo &relinked = main->getControlFlow();
+    EXPECT_EQ(relinked.getGraph().size(), main->getInsts().size());
+    EXPECT_EQ(relinked.getLoops().size(), 1);
+    checkLoops(relinked.getGraph(), relinked.getDominators(),
+               relinked.getLoops());
+}
+
+TEST(LoopForest, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        for (Function *function : parser->getBuilder().getFunctions()) {
+            ControlFlowInfo &info = function->getControlFlow();
+            checkLoops(info.getGraph(), info.getDominators(),
+                       info.getLoops());
+            const DominatorTree &postDominators = info.getPostDominators();
+            // structured code reaches the end from everywhere it starts
+            for (NodeId node : info.getDominators().getReversePostOrder())
+                EXPECT_TRUE(postDominators.isReachable(node)) << file;
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include "fdlang/scanner.h"
+
+#include "analysis/intervalAnalysis.h"
+#include "analysis/packedIntervals.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <sstream>
+#include <string>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+// more than one block, so the kernels cross a block boundary
+const size_t numVars = 70;
+
+Interval interval(long long l, long long r) { return {l, r, false}; }
+
+TEST(PackedIntervals, Lattice) {
+    PackedIntervals bottom(numVars, false), zero(numVars, true);
+    EXPECT_TRUE(bottom.isBottom());
+    EXPECT_FALSE(zero.isBottom());
+    EXPECT_EQ(zero.get(69), interval(0, 0));
+    EXPECT_TRUE(bottom.get(3).isBottom);
+    EXPECT_TRUE(bottom.leq(zero));
+    EXPECT_FALSE(zero.leq(bottom));
+
+    PackedIntervals a = zero, b = zero;
+    a.set(1, interval(3, 10));
+    a.set(40, interval(200, 255));
+    b.set(1, interval(8, 20));
+    b.set(65, interval(7, 7));
+
+    PackedIntervals join = a;
+    EXPECT_TRUE(join.joinWith(b));
+    EXPECT_EQ(join.get(1), interval(3, 20));
+    EXPECT_EQ(join.get(40), interval(0, 255));
+    EXPECT_EQ(join.get(65), interval(0, 7));
+    EXPECT_TRUE(a.leq(join));
+    EXPECT_TRUE(b.leq(join));
+    EXPECT_FALSE(join.leq(a));
+    EXPECT_FALSE(join.joinWith(a));
+
+    PackedIntervals meet = join.meet(a);
+    EXPECT_EQ(meet, a);
+    // x1 in [3, 10] and [8, 20], but x40 in [200, 255] and [0, 0]
+    EXPECT_TRUE(a.meet(b).isBottom());
+
+    PackedIntervals fromBottom = bottom;
+    EXPECT_TRUE(fromBottom.joinWith(a));
+    EXPECT_EQ(fromBottom, a);
+    EXPECT_FALSE(a.joinWith(bottom));
+    EXPECT_TRUE(a.meet(bottom).isBottom());
+}
+
+TEST(PackedIntervals, Restrict) {
+    PackedIntervals state(numVars, true);
+    state.set(33, interval(10, 300));
+    EXPECT_EQ(state.get(33), interval(10, 255));
+    state.restrict(33, 0, 50);
+    EXPECT_EQ(state.get(33), interval(10, 50));
+    state.restrict(33, 51, 255);
+    EXPECT_TRUE(state.isBottom());
+    state.set(33, interval(1, 1));
+    EXPECT_TRUE(state.isBottom());
+}
+
+TEST(PackedIntervals, CopyOnWrite) {
+    PackedIntervals a(numVars, true);
+    a.set(2, interval(1, 9));
+    PackedIntervals b = a;
+    EXPECT_TRUE(b.shares(a));
+    b.set(2, interval(1, 9));
+    EXPECT_TRUE(b.shares(a));
+    b.set(66, interval(4, 4));
+    EXPECT_FALSE(b.shares(a));
+    EXPECT_EQ(a.get(66), interval(0, 0));
+    EXPECT_EQ(b.get(2), interval(1, 9));
+
+    // a join that changes nothing writes nothing, and one whose result is
+    // the other side takes its blocks
+    PackedIntervals wide = b;
+    wide.set(66, interval(0, 10));
+    PackedIntervals before = wide;
+    EXPECT_FALSE(wide.joinWith(b));
+    EXPECT_TRUE(wide.shares(before));
+    EXPECT_TRUE(b.joinWith(wide));
+    EXPECT_TRUE(b.shares(wide));
+    PackedIntervals bottom(numVars, false);
+    EXPECT_TRUE(bottom.joinWith(a));
+    EXPECT_TRUE(bottom.shares(a));
+}
+
+TEST(PackedIntervals, SaturatingArithmetic) {
+    EXPECT_EQ(saturatingAdd(interval(100, 200), interval(50, 60)),
+              interval(150, 255));
+    EXPECT_EQ(saturatingSub(interval(10, 200), interval(50, 60)),
+              interval(0, 150));
+    EXPECT_TRUE(saturatingAdd(Interval(), interval(1, 1)).isBottom);
+}
+
+TEST(PackedIntervals, Analysis) {
+    std::string src = "function main() {\n"
+                      "    x = input();\n"
+                      "    y = 0;\n"
+                      "    while (x < 100) {\n"
+                      "        x = x + 1;\n"
+                      "    }\n"
+                      "    check_interval(x, 100, 255);\n"
+                      "    if (x == 100) {\n"
+                      "        y = x - 90;\n"
+                      "    } else {\n"
+                      "        y = 250 + x;\n"
+                      "    }\n"
+                      "    check_interval(y, 10, 255);\n"
+                      "    check_interval(y, 11, 255);\n"
+                      "    if (x < 100) {\n"
+                      "        check_interval(y, 0, 0);\n"
+                      "    } else {\n"
+                      "        nop;\n"
+                      "    }\n"
+                      "}\n";
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    IntervalAnalysis analysis(parser.getBuilder().getFunctions());
+    analysis.run();
+    std::stringstream out;
+    analysis.dumpResult(out);
+    EXPECT_EQ(out.str(), "Line 7: YES\n"
+                         "Line 13: YES\n"
+                         "Line 14:  NO\n"
+                         "Line 16: Unreachable\n");
+}
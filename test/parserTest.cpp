@@ -0,0 +1,369 @@
+#include "gtest/gtest.h"
+
+#include "fdlang/AST.h"
+#include "fdlang/ASTTraversePrinter.h"
+#include "fdlang/ASTWalker.h"
+#include "fdlang/flatAST.h"
+#include "fdlang/flatASTWalker.h"
+#include "fdlang/parser.h"
+#include "fdlang/scanner.h"
+#include "fdlang/sema.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+// the IR of every function below `root', which has to pass Sema
+template <typename Root> std::string checkedIR(Root root) {
+    std::stringstream out;
+    Sema sema(root);
+    EXPECT_TRUE(sema.check());
+    IR::IRBuilder irBuilder(root);
+    for (IR::Function *func : irBuilder.build())
+        func->dump(out);
+    return out.str();
+}
+
+// formatted source followed by the IR of every function
+std::string dump(ASTNode *root) {
+    std::stringstream out;
+    ASTTraversePrinter printer(out);
+    root->accept(&printer);
+    return out.str() + checkedIR(root);
+}
+
+TEST(Parser, FlatMatchesPointer) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+
+        Scanner scanner(src.text());
+        Parser parser(scanner);
+        ASTNode *root = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+
+        Scanner flatScanner(src.text());
+        FlatParser flatParser(flatScanner);
+        NodeIndex flatRoot = flatParser.parse();
+        ASSERT_FALSE(flatParser.hadError());
+        const FlatAST &ast = flatParser.getBuilder().getAST();
+        EXPECT_TRUE(ast.isComplete());
+        EXPECT_EQ(ast.node(flatRoot).type, ASTNodeType::FUNCTIONS);
+
+        ASTNode *materialized = ast.materialize(flatRoot);
+        EXPECT_EQ(dump(root), dump(materialized)) << file;
+
+        delete root;
+        delete materialized;
+    }
+}
+
+TEST(Parser, FlatLayout) {
+    std::string src = "function f(a, b) {\n"
+                      "    if (a < 3) { x = a + 1; } else { nop; }\n"
+                      "    check_interval(x, 0, 4);\n"
+                      "}";
+    Scanner scanner(src);
+    FlatParser parser(scanner);
+    NodeIndex root = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    const FlatAST &ast = parser.getBuilder().getAST();
+
+    ASSERT_EQ(ast.node(root).numChildren, 1);
+    NodeIndex function = ast.child(root, 0);
+    EXPECT_EQ(ast.node(function).type, ASTNodeType::FUNCTION);
+    EXPECT_EQ(ast.node(function).numTokens, 3);
+    EXPECT_EQ(ast.token(function, 2).lexeme, "b");
+
+    NodeIndex body = ast.child(function, 0);
+    ASSERT_EQ(ast.node(body).numChildren, 2);
+    NodeIndex ifStmt = ast.child(body, 0);
+    EXPECT_EQ(ast.node(ifStmt).type, ASTNodeType::IF_STMT);
+    NodeIndex cond = ast.child(ifStmt, 0);
+    EXPECT_EQ(ast.token(cond, 1).type, TokenType::LESS);
+    NodeIndex trueBody = ast.child(ifStmt, 1);
+    EXPECT_EQ(ast.node(ast.child(trueBody, 0)).type,
+              ASTNodeType::BINARY_ASSIGN_STMT);
+
+    NodeIndex check = ast.child(body, 1);
+    EXPECT_EQ(ast.node(check).type, ASTNodeType::CHECK_STMT);
+    EXPECT_EQ(ast.token(check, 3).getLiteralAsNumber(), 4);
+}
+
+TEST(Parser, FlatIncomplete) {
+    std::string src = "function main() {\n    x = 1 +";
+    Scanner scanner(src);
+    FlatParser parser(scanner);
+    NodeIndex root = parser.parse();
+    EXPECT_TRUE(parser.hadError());
+    EXPECT_FALSE(parser.getBuilder().getAST().isComplete());
+
+    ASTNode *materialized = parser.getBuilder().getAST().materialize(root);
+    ASSERT_NE(materialized, nullptr);
+    delete materialized;
+}
+
+// records the node types in visiting order, defaulting every traversal
+class TypeRecorder : public ASTWalker<TypeRecorder> {
+public:
+    std::vector<ASTNodeType> types;
+
+    template <typename Node> void visit(Node *node) {
+        types.push_back(node->type);
+        ASTWalker<TypeRecorder>::visit(node);
+    }
+};
+
+// the same with ASTVisitor, written out as the existing passes do
+class VirtualTypeRecorder : public ASTVisitor {
+public:
+    std::vector<ASTNodeType> types;
+
+    void visit(Stmts *node) override {
+        types.push_back(node->type);
+        for (ASTNode *child : node->children)
+            child->accept(this);
+    }
+    void visit(Cond *node) override { types.push_back(node->type); }
+    void visit(UnaryAssignStmt *node) override { types.push_back(node->type); }
+    void visit(BinaryAssignStmt *node) override {
+        types.push_back(node->type);
+    }
+    void visit(IfStmt *node) override {
+        types.push_back(node->type);
+        node->cond->accept(this);
+        node->trueBody->accept(this);
+        node->falseBody->accept(this);
+    }
+    void visit(WhileStmt *node) override {
+        types.push_back(node->type);
+        node->cond->accept(this);
+        node->body->accept(this);
+    }
+    void visit(CheckStmt *node) override { types.push_back(node->type); }
+    void visit(NopStmt *node) override { types.push_back(node->type); }
+    void visit(CallStmt *node) override { types.push_back(node->type); }
+    void visit(FunctionNodes *node) override {
+        types.push_back(node->type);
+        for (ASTNode *child : node->children)
+            child->accept(this);
+    }
+    void visit(FunctionNode *node) override {
+        types.push_back(node->type);
+        node->body->accept(this);
+    }
+};
+
+TEST(Parser, WalkerMatchesVisitor) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        Scanner scanner(src.text());
+        Parser parser(scanner);
+        ASTNode *root = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+
+        TypeRecorder walker;
+        walker.walk(root);
+        VirtualTypeRecorder visitor;
+        root->accept(&visitor);
+        EXPECT_EQ(walker.types, visitor.types) << file;
+        EXPECT_EQ(walker.types.front(), ASTNodeType::FUNCTIONS);
+        delete root;
+    }
+}
+
+// records the node types of a FlatAST in visiting order
+class FlatTypeRecorder : public FlatASTWalker<FlatTypeRecorder> {
+public:
+    std::vector<ASTNodeType> types;
+
+    template <typename Node> void visit(const Node &node, ASTNodeType type) {
+        types.push_back(type);
+        FlatASTWalker<FlatTypeRecorder>::visit(node);
+    }
+
+    void visit(const flat::Stmts &n) { visit(n, ASTNodeType::STMTS); }
+    void visit(const flat::Cond &n) { visit(n, ASTNodeType::COND); }
+    void visit(const flat::UnaryAssignStmt &n) {
+        visit(n, ASTNodeType::UNARY_ASSIGN_STMT);
+    }
+    void visit(const flat::BinaryAssignStmt &n) {
+        visit(n, ASTNodeType::BINARY_ASSIGN_STMT);
+    }
+    void visit(const flat::IfStmt &n) { visit(n, ASTNodeType::IF_STMT); }
+    void visit(const flat::WhileStmt &n) { visit(n, ASTNodeType::WHILE_STMT); }
+    void visit(const flat::CheckStmt &n) { visit(n, ASTNodeType::CHECK_STMT); }
+    void visit(const flat::NopStmt &n) { visit(n, ASTNodeType::NOP_STMT); }
+    void visit(const flat::CallStmt &n) { visit(n, ASTNodeType::CALL_STMT); }
+    void visit(const flat::FunctionNode &n) {
+        visit(n, ASTNodeType::FUNCTION);
+    }
+    void visit(const flat::FunctionNodes &n) {
+        visit(n, ASTNodeType::FUNCTIONS);
+    }
+};
+
+TEST(Parser, FlatWalkerMatchesPointer) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+
+        Scanner scanner(src.text());
+        Parser parser(scanner);
+        ASTNode *root = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+
+        // Sema and IRBuilder read the FlatAST in place
+        Scanner flatScanner(src.text());
+        FlatParser flatParser(flatScanner);
+        FlatNodeRef flatRoot = {&flatParser.getBuilder().getAST(),
+                                flatParser.parse()};
+        ASSERT_FALSE(flatParser.hadError());
+        EXPECT_EQ(checkedIR(flatRoot), checkedIR(root)) << file;
+        TypeRecorder walker;
+        walker.walk(root);
+        FlatTypeRecorder flatWalker;
+        flatWalker.walk(flatRoot);
+        EXPECT_EQ(flatWalker.types, walker.types) << file;
+        delete root;
+    }
+}
+
+TEST(Parser, FlatSemaErrors) {
+    std::string src = "function f(1, a) {\n"
+                      "    x = 300;\n"
+                      "    while (x < y) {\n"
+                      "        check_interval(x, 0, 256);\n"
+                      "    }\n"
+                      "}\n"
+                      "function 2() {\n"
+                      "    call f(x, 1);\n"
+                      "}\n";
+
+    testing::internal::CaptureStderr();
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    Sema sema(root);
+    EXPECT_FALSE(sema.check());
+    std::string expected = testing::internal::GetCapturedStderr();
+    EXPECT_FALSE(expected.empty());
+    delete root;
+
+    testing::internal::CaptureStderr();
+    Scanner flatScanner(src);
+    FlatParser flatParser(flatScanner);
+    NodeIndex flatRoot = flatParser.parse();
+    ASSERT_FALSE(flatParser.hadError());
+    Sema flatSema(FlatNodeRef{&flatParser.getBuilder().getAST(), flatRoot});
+    EXPECT_FALSE(flatSema.check());
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), expected);
+}
+
+// the IR with the line of every check, which dump() leaves out
+std::string dumpIR(const IR::Functions &funcs) {
+    std::stringstream out;
+    for (IR::Function *func : funcs) {
+        func->dump(out);
+        out << (func->isRoot() ? "root\n" : "callee\n");
+        for (IR::Inst *inst : func->getInsts())
+            if (inst->getInstType() == IR::InstType::CheckIntervalInst)
+                out << "check at line "
+                    << static_cast<IR::CheckIntervalInst *>(inst)->getLine()
+                    << "\n";
+    }
+    return out.str();
+}
+
+// diagnostics of scanning, parsing, Sema and lowering `src' through the AST
+std::string sequentialErrors(const std::string &src) {
+    testing::internal::CaptureStderr();
+    Scanner scanner(src);
+    Parser parser(scanner);
+    ASTNode *root = parser.parse();
+    if (!scanner.hadError() && !parser.hadError()) {
+        Sema sema(root);
+        sema.check();
+    }
+    delete root;
+    return testing::internal::GetCapturedStderr();
+}
+
+std::string loweringErrors(const std::string &src) {
+    testing::internal::CaptureStderr();
+    Scanner scanner(src);
+    LoweringParser parser(scanner);
+    parser.parse();
+    bool failed = scanner.hadError() || parser.hadError() ||
+                  parser.getBuilder().hadError();
+    EXPECT_TRUE(failed);
+    EXPECT_TRUE(parser.getBuilder().getFunctions().empty());
+    return testing::internal::GetCapturedStderr();
+}
+
+TEST(Parser, LoweringMatchesIRBuilder) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+
+        Scanner scanner(src.text());
+        Parser parser(scanner);
+        ASTNode *root = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+        Sema sema(root);
+        ASSERT_TRUE(sema.check());
+        IR::IRBuilder irBuilder(root);
+        std::string expected = dumpIR(irBuilder.build());
+
+        Scanner loweringScanner(src.text());
+        LoweringParser loweringParser(loweringScanner);
+        loweringParser.parse();
+        ASSERT_FALSE(loweringParser.hadError());
+        ASSERT_FALSE(loweringParser.getBuilder().hadError());
+        EXPECT_EQ(dumpIR(loweringParser.getBuilder().getFunctions()),
+                  expected)
+            << file;
+        delete root;
+    }
+}
+
+TEST(Parser, LoweringErrors) {
+    // Sema errors in headers, conditions and bodies, in Sema's order
+    std::string semaErrors = "function f(1, a) {\n"
+                             "    x = 300;\n"
+                             "    while (x < y) {\n"
+                             "        check_interval(x, 0, 256);\n"
+                             "    }\n"
+                             "}\n"
+                             "function 2() {\n"
+                             "    call f(x, 1);\n"
+                             "}\n";
+    // a parse error hides Sema errors before it
+    std::string parseError = "function f() {\n"
+                             "    x = 300 + 1;\n"
+                             "}\n"
+                             "function g( {\n"
+                             "}\n";
+    for (const std::string &src : {semaErrors, parseError}) {
+        std::string expected = sequentialErrors(src);
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(loweringErrors(src), expected);
+    }
+}
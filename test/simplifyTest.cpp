@@ -0,0 +1,255 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "analysis/relationalNumericalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRArena.h"
+#include "IR/IRBuilder.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/SSAForm.h"
+#include "IR/passManager.h"
+#include "IR/simplifyPasses.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+static Token identifier(std::string_view name) {
+    return Token(TokenType::IDENTIFIER, name,
+                 Literal::ofSymbol(SymbolTable::global().intern(name)), 1);
+}
+
+size_t countChecks(const Functions &funcs) {
+    size_t ret = 0;
+    for (Function *function : funcs)
+        for (Inst *inst : function->getInsts())
+            ret += inst->getInstType() == InstType::CheckIntervalInst;
+    return ret;
+}
+
+bool hasCalls(const Functions &funcs) {
+    for (Function *function : funcs)
+        for (Inst *inst : function->getInsts())
+            if (inst->getInstType() == InstType::CallInst)
+                return true;
+    return false;
+}
+
+std::string zones(const Functions &funcs) {
+    std::stringstream out;
+    analysis::RelationalNumericalAnalysis analysis(funcs);
+    analysis.run();
+    analysis.dumpResult(out);
+    return out.str();
+}
+
+TEST(SimplifyTest, Loop) {
+    std::string src = "function main() {\n"
+                      "    x = 1;\n"
+                      "    while (x < 10) {\n"
+                      "        x = x + 1;\n"
+                      "    }\n"
+                      "    check_interval(x, 10, 10);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    PassManager manager;
+    addSimplifyPasses(manager);
+    manager.run(funcs);
+    // the loop test is inverted to leave the loop, the body falls through
+    EXPECT_EQ(dumpInsts(funcs[0]), "L1 :  x = 1;\n"
+                                   "L2 :  \n"
+                                   "L3 :  if x >= 10 then goto L6;\n"
+                                   "L4 :  x = x + 1;\n"
+                                   "L5 :  goto L2;\n"
+                                   "L6 :  \n"
+                                   "L7 :  check_interval(x, 10, 10);\n");
+    EXPECT_EQ(funcs[0]->getEndLabel(), 8);
+}
+
+TEST(SimplifyTest, ConstantBranches) {
+    // Sema only lets variables be compared to numbers, so build by hand
+    //     x = 3 + 4;
+    //     y = 9223372036854775807 + 1;
+    //     if (1 > 2) { check_interval(x, 6, 6); } else { nop; }
+    //     if (x >= x) { nop; } else { x = 0; }
+    //     check_interval(x, 7, 7);
+    IRArena arena;
+    Value *x = arena.getValue(identifier("x"));
+    Value *y = arena.getValue(identifier("y"));
+    Insts insts;
+    insts.push_back(arena.create<AddInst>(x, arena.getNumber(3),
+                                          arena.getNumber(4)));
+    insts.push_back(arena.create<AddInst>(
+        y, arena.getNumber(9223372036854775807), arena.getNumber(1)));
+    for (bool second : {false, true}) {
+        Inst *labelTrue = arena.create<LabelInst>();
+        Inst *labelFalse = arena.create<LabelInst>();
+        Inst *labelEnd = arena.create<LabelInst>();
+        if (second)
+            insts.push_back(
+                arena.create<IfInst>(x, CmpOperator::GEQ, x, labelTrue));
+        else
+            insts.push_back(arena.create<IfInst>(
+                arena.getNumber(1), CmpOperator::GT, arena.getNumber(2),
+                labelTrue));
+        insts.push_back(arena.create<GotoInst>(labelFalse));
+        insts.push_back(labelTrue);
+        if (!second) {
+            auto check = arena.create<CheckIntervalInst>(
+                x, arena.getNumber(6), arena.getNumber(6));
+            check->setLine(6);
+            insts.push_back(check);
+        }
+        insts.push_back(arena.create<GotoInst>(labelEnd));
+        insts.push_back(labelFalse);
+        if (second)
+            insts.push_back(arena.create<AssignInst>(x, arena.getNumber(0)));
+        insts.push_back(labelEnd);
+    }
+    auto check = arena.create<CheckIntervalInst>(x, arena.getNumber(7),
+                                                 arena.getNumber(7));
+    check->setLine(15);
+    insts.push_back(check);
+    Function main(SymbolTable::global().intern("main"), {}, insts,
+                  arena.takeVars());
+    Functions funcs = {&main};
+    IRBuilder::link(funcs);
+
+    PassManager manager;
+    addSimplifyPasses(manager);
+    manager.run(funcs);
+    // out-of-range numbers are clamped before folding, the check in dead
+    // code stays unreachable
+    EXPECT_EQ(dumpInsts(funcs[0]),
+              "L1 :  x = 7;\n"
+              "L2 :  y = 255;\n"
+              "L3 :  goto L5;\n"
+              "L4 :  check_interval(x, 6, 6);\n"
+              "L5 :  \n"
+              "L6 :  check_interval(x, 7, 7);\n");
+    EXPECT_TRUE(funcs[0]->getInstByLabel(4)->getPredecessors().empty());
+    EXPECT_EQ(zones(funcs), "Line 6: Unreachable\n"
+                            "Line 15: YES\n");
+
+    const auto &statistics = manager.getStatistics();
+    ASSERT_EQ(statistics.size(), 5);
+    EXPECT_EQ(statistics[0].name, "constant-folding");
+    EXPECT_GT(statistics[0].changes, 0);
+    EXPECT_GT(statistics[1].removedInsts, 0);
+}
+
+TEST(SimplifyTest, SaturatingFold) {
+    // `+' saturates at 255 and `-' at 0, so folding must too
+    std::string src = "function main() {\n"
+                      "    x = 200 + 100;\n"
+                      "    y = 3 - 5;\n"
+                      "    check_interval(x, 255, 255);\n"
+                      "    check_interval(y, 0, 0);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    std::string before = zones(funcs);
+    PassManager manager;
+    addSimplifyPasses(manager);
+    manager.run(funcs);
+    EXPECT_EQ(dumpInsts(funcs[0]), "L1 :  x = 255;\n"
+                                   "L2 :  y = 0;\n"
+                                   "L3 :  check_interval(x, 255, 255);\n"
+                                   "L4 :  check_interval(y, 0, 0);\n");
+    EXPECT_EQ(zones(funcs), before);
+    EXPECT_EQ(before, "Line 4: YES\nLine 5: YES\n");
+}
+
+TEST(SimplifyTest, DeadFunctions) {
+    std::string src = "function main() {\n"
+                      "    call f(1);\n"
+                      "}\n"
+                      "function f(a) {\n"
+                      "    nop;\n"
+                      "}\n"
+                      "function g(b) {\n"
+                      "    call h(b);\n"
+                      "}\n"
+                      "function h(c) {\n"
+                      "    call g(c);\n"
+                      "}\n"
+                      "function k(d) {\n"
+                      "    call k(d);\n"
+                      "    check_interval(d, 0, 0);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    PassManager manager;
+    addSimplifyPasses(manager);
+    manager.run(funcs);
+    // g and h only call each other, k has a check
+    std::vector<std::string> names;
+    for (Function *function : funcs)
+        names.emplace_back(symbolName(function->funcName));
+    EXPECT_EQ(names, (std::vector<std::string>{"main", "f", "k"}));
+    EXPECT_EQ(manager.getStatistics().back().removedFunctions, 2);
+    // relinked: f's label follows main's
+    EXPECT_EQ(funcs[1]->getBeginLabel(), funcs[0]->getEndLabel() + 2);
+    EXPECT_EQ(static_cast<CallInst *>(funcs[0]->getInsts()[0])->getCallee(),
+              funcs[1]);
+}
+
+TEST(SimplifyTest, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        Functions funcs = parser->getBuilder().getFunctions();
+        size_t checks = countChecks(funcs);
+        // the zone analysis does not handle calls
+        bool analyse = !hasCalls(funcs);
+        std::string before = analyse ? zones(funcs) : "";
+
+        PassManager manager;
+        addSimplifyPasses(manager);
+        manager.run(funcs);
+        EXPECT_EQ(countChecks(funcs), checks) << file;
+        if (analyse) {
+            EXPECT_EQ(zones(funcs), before) << file;
+        }
+        for (Function *function : funcs) {
+            for (Inst *inst : function->getInsts()) {
+                Inst *dest = nullptr;
+                if (inst->getInstType() == InstType::GotoInst)
+                    dest = static_cast<GotoInst *>(inst)->getDestInst();
+                if (inst->getInstType() == InstType::IfInst)
+                    dest = static_cast<IfInst *>(inst)->getDestInst();
+                if (dest) {
+                    EXPECT_EQ(dest->getInstType(), InstType::LabelInst)
+                        << file;
+                }
+            }
+            SSAForm ssa(function);
+        }
+
+        // simplifying again changes nothing
+        PassManager again;
+        addSimplifyPasses(again);
+        again.run(funcs);
+        for (const auto &entry : again.getStatistics())
+            EXPECT_EQ(entry.changes, 0) << file << " " << entry.name;
+    }
+}
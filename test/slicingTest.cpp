@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "analysis/relationalNumericalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/passManager.h"
+#include "IR/simplifyPasses.h"
+#include "IR/slicingPass.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+size_t countChecks(const Functions &funcs) {
+    size_t ret = 0;
+    for (Function *function : funcs)
+        for (Inst *inst : function->getInsts())
+            ret += inst->getInstType() == InstType::CheckIntervalInst;
+    return ret;
+}
+
+bool hasCalls(const Functions &funcs) {
+    for (Function *function : funcs)
+        for (Inst *inst : function->getInsts())
+            if (inst->getInstType() == InstType::CallInst)
+                return true;
+    return false;
+}
+
+std::string zones(const Functions &funcs) {
+    std::stringstream out;
+    analysis::RelationalNumericalAnalysis analysis(funcs);
+    analysis.run();
+    analysis.dumpResult(out);
+    return out.str();
+}
+
+// every variable a Value names is in its function's table under that name
+void checkVars(Function *function) {
+    const VarTable &vars = function->getVars();
+    auto check = [&](Value *value) {
+        if (!value->isVariable())
+            return;
+        ASSERT_LT(value->getVarId(), vars.size());
+        EXPECT_EQ(vars.getSymbol(value->getVarId()), value->getAsVariable());
+    };
+    for (Value *arg : function->getArgs())
+        check(arg);
+    for (Inst *inst : function->getInsts()) {
+        for (size_t i = 0; i < inst->getOperandSize(); i++)
+            check(inst->getOperand(i));
+        if (inst->getInstType() == InstType::CallInst)
+            for (Value *arg : static_cast<CallInst *>(inst)->getArgs())
+                check(arg);
+    }
+}
+
+TEST(SlicingTest, DropsUncheckedValues) {
+    std::string src = "function main() {\n"
+                      "    x = 1;\n"
+                      "    z = input();\n"
+                      "    w = 0;\n"
+                      "    while (z < 100) {\n"
+                      "        z = z + 1;\n"
+                      "        w = w + z;\n"
+                      "    }\n"
+                      "    while (x < 10) {\n"
+                      "        y = y + x;\n"
+                      "        x = x + 1;\n"
+                      "        if (w > 5) {\n"
+                      "            w = w - 1;\n"
+                      "        } else {\n"
+                      "            nop;\n"
+                      "        }\n"
+                      "    }\n"
+                      "    check_interval(x, 10, 10);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    std::string before = zones(funcs);
+
+    PassManager manager;
+    manager.addPass(std::make_unique<BackwardSlicing>());
+    manager.run(funcs);
+    Function *main = funcs[0];
+    // the loops stay, as they might not exit, but not what they compute
+    // beyond their own tests
+    EXPECT_EQ(dumpInsts(main), "L1 :  x = 1;\n"
+                               "L2 :  z = input();\n"
+                               "L3 :  \n"
+                               "L4 :  if z < 100 then goto L6;\n"
+                               "L5 :  goto L9;\n"
+                               "L6 :  \n"
+                               "L7 :  z = z + 1;\n"
+                               "L8 :  goto L3;\n"
+                               "L9 :  \n"
+                               "L10:  if x < 10 then goto L12;\n"
+                               "L11:  goto L15;\n"
+                               "L12:  \n"
+                               "L13:  x = x + 1;\n"
+                               "L14:  goto L9;\n"
+                               "L15:  \n"
+                               "L16:  check_interval(x, 10, 10);\n");
+    // only x, z and the zero variable are left
+    EXPECT_EQ(main->getVars().size(), 3);
+    checkVars(main);
+    EXPECT_EQ(zones(funcs), before);
+    // a slice is its own slice
+    EXPECT_EQ(manager.getStatistics()[0].changes, 1);
+}
+
+TEST(SlicingTest, KeepsEndlessLoops) {
+    // x never changes, so the loop never exits and the check is unreachable
+    std::string src = "function main() {\n"
+                      "    x = 0;\n"
+                      "    y = 5;\n"
+                      "    while (x < 10) {\n"
+                      "        z = z + 1;\n"
+                      "    }\n"
+                      "    check_interval(y, 5, 5);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    std::string before = zones(funcs);
+    EXPECT_EQ(before, "Line 7: Unreachable\n");
+
+    PassManager manager;
+    manager.addPass(std::make_unique<BackwardSlicing>());
+    manager.run(funcs);
+    std::string dump = dumpInsts(funcs[0]);
+    EXPECT_NE(dump.find("x = 0;"), std::string::npos);
+    EXPECT_NE(dump.find("if x"), std::string::npos);
+    EXPECT_EQ(dump.find("z"), std::string::npos);
+    checkVars(funcs[0]);
+    EXPECT_EQ(zones(funcs), before);
+}
+
+TEST(SlicingTest, KeepsControlDependences) {
+    std::string src = "function main() {\n"
+                      "    a = input();\n"
+                      "    b = input();\n"
+                      "    if (a > 5) {\n"
+                      "        x = 1;\n"
+                      "    } else {\n"
+                      "        x = 2;\n"
+                      "    }\n"
+                      "    b = b + 1;\n"
+                      "    check_interval(x, 1, 1);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Functions funcs = parser->getBuilder().getFunctions();
+    PassManager manager;
+    manager.addPass(std::make_unique<BackwardSlicing>());
+    manager.run(funcs);
+    std::string dump = dumpInsts(funcs[0]);
+    EXPECT_NE(dump.find("a = input();"), std::string::npos);
+    EXPECT_NE(dump.find("if a"), std::string::npos);
+    EXPECT_NE(dump.find("x = 1;"), std::string::npos);
+    EXPECT_NE(dump.find("x = 2;"), std::string::npos);
+    EXPECT_EQ(dump.find("b"), std::string::npos);
+    EXPECT_EQ(funcs[0]->getVars().size(), 3);
+    checkVars(funcs[0]);
+}
+
+TEST(SlicingTest, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        Functions funcs = parser->getBuilder().getFunctions();
+        size_t checks = countChecks(funcs);
+        std::vector<size_t> numVars;
+        for (Function *function : funcs)
+            numVars.push_back(function->getVars().size());
+        // the zone analysis does not handle calls
+        bool analyse = !hasCalls(funcs);
+        std::string before = analyse ? zones(funcs) : "";
+
+        PassManager manager;
+        addSimplifyPasses(manager);
+        manager.addPass(std::make_unique<BackwardSlicing>());
+        manager.run(funcs);
+        EXPECT_EQ(countChecks(funcs), checks) << file;
+        if (analyse) {
+            EXPECT_EQ(zones(funcs), before) << file;
+        }
+        for (size_t i = 0; i < funcs.size(); i++) {
+            EXPECT_LE(funcs[i]->getVars().size(), numVars[i]) << file;
+            checkVars(funcs[i]);
+        }
+    }
+}
@@ -0,0 +1,248 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "IR/CSRGraph.h"
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/SSAForm.h"
+#include "IR/dominatorTree.h"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::IR;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "call1.fdlang",
+    "call2.fdlang",     "call3.fdlang",     "call4.fdlang",
+    "corner.fdlang",    "deadcode1.fdlang", "deadcode2.fdlang",
+    "loop1.fdlang",     "loop2.fdlang",     "loop3.fdlang",
+    "loop4.fdlang",     "loop5.fdlang",     "nobranch1.fdlang",
+    "nobranch2.fdlang", "nobranch3.fdlang", "rel1.fdlang",
+    "rel2.fdlang",      "rel3.fdlang",      "rel4.fdlang"};
+
+std::string dumpSSA(const SSAForm &ssa) {
+    std::stringstream out;
+    ssa.dump(out);
+    return out.str();
+}
+
+// every name is defined once and its definition dominates its uses
+void checkSSA(const SSAForm &ssa) {
+    const BlockGraph &blocks = ssa.getBlocks();
+    const DominatorTree &dominators = ssa.getDominators();
+    Function *function = ssa.getFunction();
+
+    // block and position in it of every instruction, phis at -1
+    std::vector<std::pair<size_t, long>> position(function->getInsts().size());
+    for (size_t id = 0; id < blocks.size(); id++) {
+        const Insts &insts = blocks.getBlock(id)->getInsts();
+        for (size_t i = 0; i < insts.size(); i++)
+            position[function->getIndex(insts[i]->getLabel())] = {id, i};
+    }
+    auto blockOf = [&](Inst *inst) {
+        return position[function->getIndex(inst->getLabel())].first;
+    };
+
+    std::vector<bool> defined(ssa.numVersions(), false);
+    auto define = [&](Inst *inst) {
+        Value *value = inst->getOperand(0);
+        ASSERT_TRUE(value->isVersioned());
+        EXPECT_EQ(ssa.getVersion(value->getVersion()), value);
+        EXPECT_EQ(ssa.getDef(value->getVersion()), inst);
+        EXPECT_FALSE(defined[value->getVersion()]);
+        defined[value->getVersion()] = true;
+    };
+    // `value' is read by `user' in block `block' at `index'
+    auto checkRead = [&](Value *value, Inst *user, size_t block,
+                         long index) {
+        ASSERT_TRUE(value->isVersioned());
+        auto users = ssa.getUses(value->getVersion());
+        EXPECT_NE(std::find(users.begin(), users.end(), user), users.end());
+        Inst *def = ssa.getDef(value->getVersion());
+        if (!def)
+            return;
+        size_t defBlock = def->getInstType() == InstType::PhiInst
+                              ? blocks.getBlockOf(def->getLabel())->getId()
+                              : blockOf(def);
+        EXPECT_TRUE(dominators.dominates(defBlock, block));
+        if (defBlock == block && def->getInstType() != InstType::PhiInst) {
+            EXPECT_LT(position[function->getIndex(def->getLabel())].second,
+                      index);
+        }
+    };
+
+    for (size_t id = 0; id < blocks.size(); id++) {
+        for (PhiInst *phi : ssa.getPhis(id)) {
+            EXPECT_TRUE(dominators.isReachable(id));
+            define(phi);
+            auto predecessors = ssa.getCFG().predecessors(id);
+            ValueRange incoming = phi->getIncoming();
+            ASSERT_EQ(incoming.size(), predecessors.size());
+            for (size_t i = 0; i < incoming.size(); i++) {
+                EXPECT_EQ(incoming[i]->getVarId(),
+                          phi->getOperand(0)->getVarId());
+                // read at the end of the predecessor
+                if (dominators.isReachable(predecessors[i]))
+                    checkRead(incoming[i], phi, predecessors[i], LONG_MAX);
+            }
+        }
+        if (!dominators.isReachable(id))
+            continue;
+        const Insts &insts = blocks.getBlock(id)->getInsts();
+        for (size_t i = 0; i < insts.size(); i++) {
+            Inst *inst = insts[i];
+            size_t first = 0;
+            switch (inst->getInstType()) {
+            case InstType::AddInst:
+            case InstType::SubInst:
+            case InstType::AssignInst:
+            case InstType::InputInst:
+                define(inst);
+                first = 1;
+                break;
+            case InstType::CallInst:
+                for (Value *arg : static_cast<CallInst *>(inst)->getArgs())
+                    if (arg->isVariable())
+                        checkRead(arg, inst, id, i);
+                break;
+            default:
+                break;
+            }
+            for (size_t j = first; j < inst->getOperandSize(); j++)
+                if (inst->getOperand(j)->isVariable())
+                    checkRead(inst->getOperand(j), inst, id, i);
+        }
+    }
+    for (uint32_t version = 0; version < ssa.numVersions(); version++)
+        EXPECT_EQ(defined[version], ssa.getDef(version) != nullptr);
+}
+
+TEST(SSA, Dominators) {
+    // 0 -> 1 -> 2 -> 4, 0 -> 3 -> 4, 4 -> 1, 5 -> 4 unreachable
+    CSRGraph::Builder builder(6);
+    builder.addEdge(0, 1);
+    builder.addEdge(1, 2);
+    builder.addEdge(2, 4);
+    builder.addEdge(0, 3);
+    builder.addEdge(3, 4);
+    builder.addEdge(4, 1);
+    builder.addEdge(5, 4);
+    CSRGraph graph = builder.build();
+    DominatorTree tree(graph, 0);
+
+    const NodeId None = DominatorTree::NoNode;
+    std::vector<NodeId> idoms;
+    for (NodeId node = 0; node < graph.size(); node++)
+        idoms.push_back(tree.getIDom(node));
+    EXPECT_EQ(idoms, (std::vector<NodeId>{None, 0, 1, 0, 0, None}));
+    EXPECT_FALSE(tree.isReachable(5));
+    EXPECT_TRUE(tree.dominates(0, 2));
+    EXPECT_TRUE(tree.dominates(1, 2));
+    EXPECT_TRUE(tree.dominates(4, 4));
+    EXPECT_FALSE(tree.dominates(1, 4));
+    EXPECT_FALSE(tree.dominates(5, 4));
+    EXPECT_EQ(tree.getReversePostOrder().front(), 0);
+    EXPECT_EQ(tree.getReversePostOrder().size(), 5);
+
+    CSRGraph frontiers = tree.frontiers(graph);
+    auto frontier = [&](NodeId node) {
+        auto range = frontiers.successors(node);
+        std::vector<NodeId> ret(range.begin(), range.end());
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+    EXPECT_EQ(frontier(0), std::vector<NodeId>{});
+    EXPECT_EQ(frontier(1), std::vector<NodeId>{4});
+    EXPECT_EQ(frontier(2), std::vector<NodeId>{4});
+    EXPECT_EQ(frontier(3), std::vector<NodeId>{4});
+    EXPECT_EQ(frontier(4), std::vector<NodeId>{1});
+}
+
+TEST(SSA, Loop) {
+    std::string src = "function main() {\n"
+                      "    x = 1;\n"
+                      "    while (x < 10) {\n"
+                      "        y = y + x;\n"
+                      "        x = x + 1;\n"
+                      "    }\n"
+                      "    check_interval(y, 45, 45);\n"
+                      "}\n";
+    auto parser = lower(src);
+    Function *main = parser->getBuilder().getFunctions()[0];
+    std::string before = dumpInsts(main);
+    {
+        SSAForm ssa(main);
+        checkSSA(ssa);
+        // y is read before it is written, so y.1 is its value on entry
+        EXPECT_EQ(dumpSSA(ssa), "function main() {\n"
+                                "L1 :  \n"
+                                "L2 :  x.0 = 1;\n"
+                                "L3 :  \n"
+                                "L3 :  x.2 = phi(x.0, x.5);\n"
+                                "L3 :  y.3 = phi(y.1, y.4);\n"
+                                "L4 :  if x.2 < 10 then goto L6;\n"
+                                "L5 :  goto L10;\n"
+                                "L6 :  \n"
+                                "L7 :  y.4 = y.3 + x.2;\n"
+                                "L8 :  x.5 = x.2 + 1;\n"
+                                "L9 :  goto L3;\n"
+                                "L10:  \n"
+                                "L11:  check_interval(y.3, 45, 45);\n"
+                                "L12:  \n"
+                                "}\n");
+        EXPECT_EQ(ssa.numPhis(), 2);
+        EXPECT_EQ(ssa.getDef(1), nullptr);
+        // x.2 feeds the condition, both instructions of the body
+        EXPECT_EQ(ssa.getUses(2).size(), 3);
+    }
+    EXPECT_EQ(dumpInsts(main), before);
+}
+
+TEST(SSA, SemiPruned) {
+    // t never lives across blocks, so it needs no phi even though both
+    // branches write it
+    std::string src = "function main() {\n"
+                      "    x = input();\n"
+                      "    if (x < 10) {\n"
+                      "        t = x + 1;\n"
+                      "        x = t;\n"
+                      "    } else {\n"
+                      "        t = 2;\n"
+                      "        x = t - 1;\n"
+                      "    }\n"
+                      "    check_interval(x, 1, 10);\n"
+                      "}\n";
+    auto parser = lower(src);
+    SSAForm ssa(parser->getBuilder().getFunctions()[0]);
+    checkSSA(ssa);
+    ASSERT_EQ(ssa.numPhis(), 1);
+    for (size_t id = 0; id < ssa.getBlocks().size(); id++)
+        for (PhiInst *phi : ssa.getPhis(id))
+            EXPECT_EQ(phi->getOperand(0)->getVariableName(), "x");
+}
+
+TEST(SSA, AllTestcases) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        for (Function *function : parser->getBuilder().getFunctions()) {
+            std::string before = dumpInsts(function);
+            {
+                SSAForm ssa(function);
+                checkSSA(ssa);
+            }
+            // leaving SSA form restores the function
+            EXPECT_EQ(dumpInsts(function), before) << file;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef TEST_TESTUTILS_H
+#define TEST_TESTUTILS_H
+
+#include "gtest/gtest.h"
+
+#include "fdlang/scanner.h"
+
+#include "IR/CSRGraph.h"
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// a lowered program. The parser keeps a pointer to its scanner, so both are
+// owned here; `src' only has to outlive lower() itself.
+struct Lowered {
+    std::unique_ptr<fdlang::Scanner> scanner;
+    std::unique_ptr<fdlang::LoweringParser> parser;
+
+    fdlang::LoweringParser *operator->() const { return parser.get(); }
+};
+
+// lowers `src', the parser owns the functions
+inline Lowered lower(std::string_view src) {
+    Lowered lowered;
+    lowered.scanner = std::make_unique<fdlang::Scanner>(src);
+    lowered.parser = std::make_unique<fdlang::LoweringParser>(*lowered.scanner);
+    lowered.parser->parse();
+    EXPECT_FALSE(lowered.scanner->hadError());
+    EXPECT_FALSE(lowered.parser->hadError());
+    EXPECT_FALSE(lowered.parser->getBuilder().hadError());
+    return lowered;
+}
+
+// the instructions of `function', one per line
+inline std::string dumpInsts(fdlang::IR::Function *function) {
+    std::stringstream out;
+    for (fdlang::IR::Inst *inst : function->getInsts()) {
+        inst->dump(out);
+        out << "\n";
+    }
+    return out.str();
+}
+
+using Edge = std::pair<fdlang::IR::NodeId, fdlang::IR::NodeId>;
+
+// a graph of `size' nodes with `edges'
+inline fdlang::IR::CSRGraph makeGraph(size_t size, std::vector<Edge> edges) {
+    fdlang::IR::CSRGraph::Builder builder(size);
+    for (auto [from, to] : edges)
+        builder.addEdge(from, to);
+    return builder.build();
+}
+
+#endif
@@ -1,13 +1,18 @@
 #include "gtest/gtest.h"
 
+#include "fdlang/ASTTraversePrinter.h"
+#include "fdlang/parser.h"
 #include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
 
+#include <fstream>
 #include <numeric>
+#include <sstream>
 #include <vector>
 
 using namespace fdlang;
 
-std::vector<Token> scan(const std::string &src) {
+std::vector<Token> scan(std::string_view src) {
     Scanner scanner(src);
     return Scanner(src).scanTokens();
 }
@@ -86,16 +91,148 @@ TEST(Tokenize, Number) {
     for (int i = 0; i < tokens.size(); i++) {
         if (tokens[i].type == TokenType::END_OF_FILE)
             continue;
-        if (!tokens[i].literal.has_value() ||
-            tokens[i].literal.type() != typeid(long long)) {
+        if (!tokens[i].literal.hasValue() || !tokens[i].literal.isNumber()) {
             eq = false;
             break;
         }
-        if (std::any_cast<long long>(tokens[i].literal) != expected[i]) {
+        if (tokens[i].literal.getAsNumber() != expected[i]) {
             eq = false;
             break;
         }
     }
 
     EXPECT_TRUE(eq);
-}
\ No newline at end of file
+}
+
+TEST(Tokenize, SourceBuffer) {
+    std::string path = TESTCASES_DIR "/loop3.fdlang";
+    SourceBuffer buffer(path);
+    EXPECT_FALSE(buffer.hadError());
+
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::string src = ss.str();
+    EXPECT_EQ(buffer.text(), src);
+
+    std::vector<Token> fromBuffer = scan(buffer.text());
+    std::vector<Token> fromString = scan(src);
+    EXPECT_EQ(fromBuffer.size(), fromString.size());
+
+    // lexemes are views into the buffer, not copies
+    const char *begin = buffer.text().data();
+    const char *end = begin + buffer.size();
+    bool eq = true, inBuffer = true;
+    for (size_t i = 0; i < fromBuffer.size(); i++) {
+        if (fromBuffer[i].type != fromString[i].type ||
+            fromBuffer[i].lexeme != fromString[i].lexeme ||
+            fromBuffer[i].line != fromString[i].line)
+            eq = false;
+        if (fromBuffer[i].type == TokenType::END_OF_FILE)
+            continue;
+        if (fromBuffer[i].lexeme.data() < begin ||
+            fromBuffer[i].lexeme.data() >= end)
+            inBuffer = false;
+    }
+
+    EXPECT_TRUE(eq);
+    EXPECT_TRUE(inBuffer);
+}
+
+TEST(Tokenize, MissingSource) {
+    SourceBuffer buffer(TESTCASES_DIR "/does_not_exist.fdlang");
+    EXPECT_TRUE(buffer.hadError());
+    EXPECT_EQ(buffer.size(), 0);
+}
+
+TEST(Tokenize, Symbol) {
+    std::string src = "a b a function b a_1";
+    std::vector<Token> tokens = scan(src);
+
+    EXPECT_EQ(tokens.size(), 7);
+    EXPECT_EQ(tokens[0].getLiteralAsSymbol(), tokens[2].getLiteralAsSymbol());
+    EXPECT_EQ(tokens[1].getLiteralAsSymbol(), tokens[4].getLiteralAsSymbol());
+    EXPECT_NE(tokens[0].getLiteralAsSymbol(), tokens[1].getLiteralAsSymbol());
+    EXPECT_NE(tokens[0].getLiteralAsSymbol(), tokens[5].getLiteralAsSymbol());
+    EXPECT_NE(tokens[0].getLiteralAsSymbol(), EmptySymbol);
+
+    for (int i : {0, 1, 5})
+        EXPECT_EQ(symbolName(tokens[i].getLiteralAsSymbol()),
+                  tokens[i].lexeme);
+}
+
+TEST(Tokenize, Keyword) {
+    std::vector<std::pair<std::string, TokenType>> keywords = {
+        {"if", TokenType::IF},
+        {"else", TokenType::ELSE},
+        {"while", TokenType::WHILE},
+        {"input", TokenType::CALL_INPUT},
+        {"check_interval", TokenType::CALL_CHECK_INTERVAL},
+        {"nop", TokenType::NOP},
+        {"call", TokenType::CALL},
+        {"function", TokenType::FUNCTION}};
+    for (auto &[spelling, type] : keywords)
+        EXPECT_EQ(Scanner::keywordType(spelling), type);
+
+    // same length, first and last character as a keyword, or a prefix of one
+    for (std::string near : {"iff", "i", "eose", "whale", "inpt", "nap", "cal",
+                             "functions", "check_intervals", "If", "_if"})
+        EXPECT_EQ(Scanner::keywordType(near), std::nullopt) << near;
+    EXPECT_EQ(Scanner::keywordType(""), std::nullopt);
+}
+
+TEST(Tokenize, Vectorized) {
+    // runs longer than a SIMD block, runs ending on a block boundary, and
+    // line breaks inside whitespace runs
+    std::string src = "function main() {\n"
+                      "    a_very_long_identifier_spanning_two_blocks = 1;\n"
+                      "\t\r\n\n                                         \n"
+                      "    x1234567890123456789012345678901 = input();\n"
+                      "    if (x<=255) { nop; } else { y = 00000000000000007; }"
+                      "\n}";
+    for (int pad = 0; pad < 40; pad++) {
+        std::string padded =
+            std::string(pad, ' ') + src + std::string(pad, 'z');
+        std::vector<Token> scalar = Scanner(padded, false).scanTokens();
+        std::vector<Token> vectorized = Scanner(padded, true).scanTokens();
+
+        ASSERT_EQ(scalar.size(), vectorized.size());
+        for (size_t i = 0; i < scalar.size(); i++) {
+            EXPECT_EQ(scalar[i].type, vectorized[i].type);
+            EXPECT_EQ(scalar[i].lexeme, vectorized[i].lexeme);
+            EXPECT_EQ(scalar[i].line, vectorized[i].line);
+        }
+        EXPECT_EQ(vectorized.back().line, 8);
+    }
+}
+
+TEST(Tokenize, Stream) {
+    std::string path = TESTCASES_DIR "/call3.fdlang";
+    SourceBuffer buffer(path);
+    ASSERT_FALSE(buffer.hadError());
+
+    std::vector<Token> tokens = scan(buffer.text());
+    Scanner scanner(buffer.text());
+    for (const Token &expected : tokens) {
+        Token token = scanner.nextToken();
+        EXPECT_EQ(token.type, expected.type);
+        EXPECT_EQ(token.lexeme, expected.lexeme);
+        EXPECT_EQ(token.line, expected.line);
+    }
+    EXPECT_EQ(scanner.nextToken().type, TokenType::END_OF_FILE);
+
+    // parsing from the stream and from the vector builds the same AST
+    std::stringstream fromVector, fromStream;
+    ASTTraversePrinter vectorPrinter(fromVector), streamPrinter(fromStream);
+    Parser vectorParser(tokens);
+    vectorParser.parse()->accept(&vectorPrinter);
+    EXPECT_FALSE(vectorParser.hadError());
+
+    Scanner streamScanner(buffer.text());
+    Parser streamParser(streamScanner);
+    streamParser.parse()->accept(&streamPrinter);
+    EXPECT_FALSE(streamParser.hadError());
+
+    EXPECT_FALSE(fromVector.str().empty());
+    EXPECT_EQ(fromVector.str(), fromStream.str());
+}
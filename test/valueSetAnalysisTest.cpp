@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "analysis/intervalAnalysis.h"
+#include "analysis/valueSetAnalysis.h"
+#include "analysis/valueSets.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "corner.fdlang",
+    "deadcode1.fdlang", "deadcode2.fdlang", "loop1.fdlang",
+    "loop2.fdlang",     "loop3.fdlang",     "loop4.fdlang",
+    "loop5.fdlang",     "nobranch1.fdlang", "nobranch2.fdlang",
+    "nobranch3.fdlang", "rel1.fdlang",      "rel2.fdlang",
+    "rel3.fdlang",      "rel4.fdlang"};
+
+ValueSet values(std::vector<unsigned> list) {
+    ValueSet ret;
+    for (unsigned v : list)
+        ret.insert(v);
+    return ret;
+}
+
+template <typename Analysis>
+std::vector<std::string> analyse(const IR::Functions &funcs,
+                                 IterationStrategy strategy) {
+    Analysis analysis(funcs);
+    analysis.setIterationStrategy(strategy);
+    analysis.run();
+    std::stringstream out;
+    analysis.dumpResult(out);
+    std::vector<std::string> ret;
+    for (std::string line; std::getline(out, line);)
+        ret.push_back(line);
+    return ret;
+}
+
+TEST(ValueSet, Sets) {
+    ValueSet a = ValueSet::range(60, 70);
+    EXPECT_EQ(a.count(), 11);
+    EXPECT_EQ(a.min(), 60);
+    EXPECT_EQ(a.max(), 70);
+    EXPECT_TRUE(ValueSet::range(5, 4).empty());
+    EXPECT_EQ(ValueSet::range(-10, 300), ValueSet::range(0, 255));
+    EXPECT_EQ(ValueSet::range(0, 255).count(), 256);
+
+    ValueSet b = values({3, 65, 200});
+    EXPECT_EQ(a & b, ValueSet::single(65));
+    EXPECT_EQ((a | b).count(), 13);
+    EXPECT_TRUE(a.subsetOf(a | b));
+    EXPECT_FALSE(b.subsetOf(a));
+    b.erase(65);
+    EXPECT_FALSE(b.contains(65));
+    EXPECT_TRUE((a & b).empty());
+}
+
+TEST(ValueSet, SaturatingArithmetic) {
+    ValueSet a = values({0, 63, 64, 130, 250});
+    // shifts cross word boundaries and saturate at either end
+    EXPECT_EQ(a.shiftUp(1), values({1, 64, 65, 131, 251}));
+    EXPECT_EQ(a.shiftUp(70), values({70, 133, 134, 200, 255}));
+    EXPECT_EQ(a.shiftUp(300), ValueSet::single(255));
+    EXPECT_EQ(a.shiftDown(64), values({0, 66, 186}));
+    EXPECT_EQ(a.shiftDown(128), values({0, 2, 122}));
+    EXPECT_EQ(a.shiftDown(0), a);
+
+    // {10, 20} + {1, 2, 240} and {10, 20} - {1, 15}
+    ValueSet x = values({10, 20}), y = values({1, 2, 240});
+    EXPECT_EQ(saturatingAdd(x, y), values({11, 12, 21, 22, 250, 255}));
+    EXPECT_EQ(saturatingAdd(y, x), saturatingAdd(x, y));
+    EXPECT_EQ(saturatingSub(x, values({1, 15})), values({0, 5, 9, 19}));
+    EXPECT_TRUE(saturatingAdd(x, ValueSet()).empty());
+}
+
+TEST(ValueSet, States) {
+    ValueSets bottom(40, false), zero(40, true);
+    EXPECT_TRUE(bottom.isBottom());
+    EXPECT_EQ(zero.get(39), ValueSet::single(0));
+    EXPECT_TRUE(bottom.leq(zero));
+    EXPECT_FALSE(zero.leq(bottom));
+
+    ValueSets a = zero;
+    a.set(3, values({1, 5}));
+    EXPECT_FALSE(a.leq(zero));
+    ValueSets join = zero;
+    EXPECT_TRUE(join.joinWith(a));
+    EXPECT_EQ(join.get(3), values({0, 1, 5}));
+    EXPECT_FALSE(join.joinWith(a));
+    EXPECT_TRUE(a.leq(join));
+
+    ValueSets fromBottom = bottom;
+    EXPECT_TRUE(fromBottom.joinWith(a));
+    EXPECT_EQ(fromBottom, a);
+    a.restrict(3, ValueSet::range(2, 4));
+    EXPECT_TRUE(a.isBottom());
+}
+
+TEST(ValueSetAnalysis, Holes) {
+    // an interval analysis fills the gap between 1 and 200
+    auto parser = lower("function main() {\n"
+                        "    x = input();\n"
+                        "    if (x == 100) {\n"
+                        "        y = 1;\n"
+                        "    } else {\n"
+                        "        y = 200;\n"
+                        "    }\n"
+                        "    if (y == 50) {\n"
+                        "        check_interval(y, 0, 0);\n"
+                        "    } else {\n"
+                        "        nop;\n"
+                        "    }\n"
+                        "    if (y > 1) {\n"
+                        "        check_interval(y, 200, 200);\n"
+                        "    } else {\n"
+                        "        check_interval(y, 1, 1);\n"
+                        "    }\n"
+                        "    z = y + y;\n"
+                        "    if (z > 2) {\n"
+                        "        check_interval(z, 201, 255);\n"
+                        "    } else {\n"
+                        "        nop;\n"
+                        "    }\n"
+                        "}\n");
+    IR::Functions funcs = parser->getBuilder().getFunctions();
+    EXPECT_EQ(analyse<ValueSetAnalysis>(funcs, IterationStrategy::FIFO),
+              (std::vector<std::string>{"Line 9: Unreachable",
+                                        "Line 14: YES", "Line 16: YES",
+                                        "Line 20: YES"}));
+    EXPECT_EQ(analyse<IntervalAnalysis>(funcs, IterationStrategy::FIFO),
+              (std::vector<std::string>{"Line 9:  NO", "Line 14:  NO",
+                                        "Line 16: YES", "Line 20:  NO"}));
+}
+
+// never wrong where the expected answers say otherwise, and at least as
+// precise as the interval analysis
+TEST(ValueSetAnalysis, RunAll) {
+    size_t total = 0, exact = 0, intervalExact = 0;
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        std::ifstream expectedFile(TESTCASES_DIR "/" + file + ".expected");
+        std::vector<std::string> expected;
+        for (std::string line; std::getline(expectedFile, line);)
+            expected.push_back(line.substr(0, line.find(';')));
+
+        auto parser = lower(src.text());
+        IR::Functions funcs = parser->getBuilder().getFunctions();
+        auto ours = analyse<ValueSetAnalysis>(funcs, IterationStrategy::FIFO);
+        auto intervals =
+            analyse<IntervalAnalysis>(funcs, IterationStrategy::FIFO);
+        EXPECT_EQ(analyse<ValueSetAnalysis>(funcs, IterationStrategy::WTO),
+                  ours)
+            << file;
+        ASSERT_EQ(ours.size(), expected.size()) << file;
+        ASSERT_EQ(intervals.size(), expected.size()) << file;
+        for (size_t i = 0; i < ours.size(); i++) {
+            total++;
+            exact += ours[i] == expected[i];
+            intervalExact += intervals[i] == expected[i];
+            // an over-approximation may only answer NO wrongly
+            if (ours[i] != expected[i]) {
+                EXPECT_NE(ours[i].find(" NO"), std::string::npos)
+                    << file << ": " << ours[i];
+            }
+            if (intervals[i] == expected[i]) {
+                EXPECT_EQ(ours[i], expected[i]) << file;
+            }
+        }
+    }
+    EXPECT_GT(exact, intervalExact);
+    printf("Exact: %lu of %lu, intervals %lu\n", exact, total,
+           intervalExact);
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "testUtils.h"
+
+#include "fdlang/scanner.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "analysis/intervalAnalysis.h"
+
+#include "IR/IR.h"
+#include "IR/IRLoweringBuilder.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fdlang;
+using namespace fdlang::analysis;
+
+const std::vector<std::string> files = {
+    "branch1.fdlang",   "branch2.fdlang",   "corner.fdlang",
+    "deadcode1.fdlang", "deadcode2.fdlang", "loop1.fdlang",
+    "loop2.fdlang",     "loop3.fdlang",     "loop4.fdlang",
+    "loop5.fdlang",     "nobranch1.fdlang", "nobranch2.fdlang",
+    "nobranch3.fdlang", "rel1.fdlang",      "rel2.fdlang",
+    "rel3.fdlang",      "rel4.fdlang"};
+
+// no loop head grows this often without widening
+const size_t NoWidening = 1 << 20;
+
+std::string analyse(const IR::Functions &funcs, size_t delay,
+                    size_t *iterations = nullptr) {
+    IntervalAnalysis analysis(funcs);
+    analysis.setWideningDelay(delay);
+    analysis.run();
+    if (iterations)
+        *iterations = analysis.getIterations();
+    std::stringstream out;
+    analysis.dumpResult(out);
+    return out.str();
+}
+
+std::string countedLoop(int bound) {
+    std::string n = std::to_string(bound);
+    return "function main() {\n"
+           "    i = 0;\n"
+           "    while (i < " +
+           n +
+           ") {\n"
+           "        i = i + 1;\n"
+           "    }\n"
+           "    check_interval(i, " +
+           n + ", " + n +
+           ");\n"
+           "}\n";
+}
+
+TEST(Widening, CountedLoops) {
+    std::vector<size_t> counts;
+    for (int bound : {10, 100, 250}) {
+        auto parser = lower(countedLoop(bound));
+        IR::Functions funcs = parser->getBuilder().getFunctions();
+        size_t widened, plain;
+        EXPECT_EQ(analyse(funcs, 1, &widened), "Line 6: YES\n");
+        EXPECT_EQ(analyse(funcs, NoWidening, &plain), "Line 6: YES\n");
+        EXPECT_LT(widened, plain);
+        counts.push_back(widened);
+    }
+    // the iterations do not depend on the bound
+    EXPECT_EQ(counts[0], counts[1]);
+    EXPECT_EQ(counts[1], counts[2]);
+}
+
+TEST(Widening, SameResults) {
+    for (const std::string &file : files) {
+        SourceBuffer src(TESTCASES_DIR "/" + file);
+        ASSERT_FALSE(src.hadError());
+        auto parser = lower(src.text());
+        IR::Functions funcs = parser->getBuilder().getFunctions();
+        size_t widened, plain;
+        std::string expected = analyse(funcs, NoWidening, &plain);
+        for (size_t delay : {0, 1, 3})
+            EXPECT_EQ(analyse(funcs, delay, &widened), expected) << file;
+        EXPECT_LE(widened, plain) << file;
+    }
+}
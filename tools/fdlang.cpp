@@ -4,36 +4,33 @@
 #include "fdlang/parser.h"
 #include "fdlang/scanner.h"
 #include "fdlang/sema.h"
+#include "fdlang/sourceBuffer.h"
+
+#include "frontend/frontend.h"
+#include "frontend/incremental.h"
 
 #include "analysis/interAnalysis.h"
 #include "analysis/intervalAnalysis.h"
 #include "analysis/modelChecker.h"
 #include "analysis/relationalNumericalAnalysis.h"
+#include "analysis/valueSetAnalysis.h"
 
 #include "IR/IRBuilder.h"
+#include "IR/IRCache.h"
+#include "IR/IRLoweringBuilder.h"
+#include "IR/SSAForm.h"
+#include "IR/passManager.h"
+#include "IR/simplifyPasses.h"
+#include "IR/slicingPass.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 
 std::set<std::string> options;
 
-std::string readSrc(const std::string &path) {
-    std::ifstream file(path);
-    file.seekg(0, std::ios::end);
-    std::streamoff fileLength = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    char *buffer = new char[fileLength + 1];
-    file.read(buffer, fileLength);
-    buffer[fileLength] = '\0';
-    std::string ret = buffer;
-
-    if (buffer)
-        delete[] buffer;
-
-    return ret;
-}
-
 int main(int argc, char *argv[]) {
 
     if (argc == 1) {
@@ -41,83 +38,248 @@ int main(int argc, char *argv[]) {
                      "[-format] "
                      "[-modelchecker] "
                      "[-interval-analysis] "
+                     "[-widening-delay=N] "
+                     "[-valueset-analysis] "
                      "[-zone-analysis] "
+                     "[-wto] "
                      "[-inter-analysis] "
                      "[-dumpir] "
+                     "[-dumpssa] "
+                     "[-simplify] "
+                     "[-simplify-stats] "
+                     "[-slice] "
+                     "[-j[threads]] "
+                     "[-incremental] "
+                     "[-emit-ircache=path] "
+                     "[-load-ircache] "
                      "path-to-src-file"
                   << std::endl;
         std::cout << "e.g.: fdlang -interval-analysis src.fdlang" << std::endl;
+        std::cout << "      fdlang -emit-ircache=src.irc src.fdlang"
+                  << std::endl;
+        std::cout << "      fdlang -load-ircache -interval-analysis src.irc"
+                  << std::endl;
         return 0;
     }
 
     std::string filepath;
+    // -j runs the frontend on a thread per hardware thread, -jN on N
+    bool parallelFrontend = false;
+    unsigned numThreads = 0;
+    // -emit-ircache=path writes the linked IR there, -load-ircache reads
+    // the IR from such a file instead of source
+    const char emitIRCache[] = "-emit-ircache=";
+    std::string irCachePath;
+    // -widening-delay=N lets interval loop heads grow N times before
+    // widening
+    const char wideningDelayOption[] = "-widening-delay=";
+    long wideningDelay = -1;
     for (int i = 1; i < argc; i++) {
         options.emplace(argv[i]);
         if (i == argc - 1)
             filepath = argv[i];
+        else if (std::string(argv[i]).rfind("-j", 0) == 0) {
+            parallelFrontend = true;
+            numThreads = std::atoi(argv[i] + 2);
+        } else if (std::string(argv[i]).rfind(emitIRCache, 0) == 0)
+            irCachePath = argv[i] + std::strlen(emitIRCache);
+        else if (std::string(argv[i]).rfind(wideningDelayOption, 0) == 0)
+            wideningDelay =
+                std::atol(argv[i] + std::strlen(wideningDelayOption));
     }
     bool doFormat = options.count("-format");
     bool doModelChecker = options.count("-modelchecker");
     bool doDumpir = options.count("-dumpir");
+    bool doDumpSSA = options.count("-dumpssa");
     bool doIntervalAnalysis = options.count("-interval-analysis");
+    bool doValueSetAnalysis = options.count("-valueset-analysis");
     bool doZoneAnalysis = options.count("-zone-analysis");
+    // -wto iterates the interval, value-set and zone analyses in weak
+    // topological order instead of first in first out
+    auto strategy = options.count("-wto")
+                        ? fdlang::analysis::IterationStrategy::WTO
+                        : fdlang::analysis::IterationStrategy::FIFO;
     bool doInterAnalysis = options.count("-inter-analysis");
+    bool doLoadIRCache = options.count("-load-ircache");
+    bool doSimplifyStats = options.count("-simplify-stats");
+    bool doSimplify = doSimplifyStats || options.count("-simplify");
+    bool doSlice = options.count("-slice");
+    // -incremental keeps the frontend alive and answers again on request
+    bool doIncremental = options.count("-incremental");
 
-    std::string src = readSrc(filepath);
-    fdlang::Scanner scanner(src);
-    std::vector<fdlang::Token> tokens = scanner.scanTokens();
-    if (scanner.hadError())
+    if (doIncremental && (doLoadIRCache || doSimplify || doSlice)) {
+        // the passes would rewrite IR the next update reuses
+        std::cerr << "-incremental reads source and cannot be combined with "
+                     "-load-ircache, -simplify or -slice"
+                  << std::endl;
         return 0;
+    }
 
-    fdlang::Parser parser(tokens);
-    fdlang::ASTNode *root = parser.parse();
-    if (parser.hadError())
+    if (doLoadIRCache && (doFormat || doModelChecker)) {
+        std::cerr << "-format and -modelchecker need the source, not an IR "
+                     "cache"
+                  << std::endl;
         return 0;
+    }
 
-    fdlang::Sema sema(root);
-    if (!sema.check())
-        return 0;
+    // everything asked for from the program's AST and IR; root is only
+    // read by -format and -modelchecker
+    auto output = [&](fdlang::ASTNode *root, fdlang::IR::Functions funcs) {
+        // the passes own the instructions they create
+        fdlang::IR::PassManager passManager;
+        if (doSimplify)
+            fdlang::IR::addSimplifyPasses(passManager);
+        // -slice keeps only what the checks depend on
+        if (doSlice)
+            passManager.addPass(
+                std::make_unique<fdlang::IR::BackwardSlicing>());
+        if (doSimplify || doSlice) {
+            passManager.run(funcs);
+            if (doSimplifyStats)
+                passManager.dumpStatistics(std::cout);
+        }
 
-    if (doFormat) {
-        fdlang::ASTTraversePrinter printer(std::cout);
-        root->accept(&printer);
-    }
+        if (!irCachePath.empty()) {
+            std::ofstream out(irCachePath, std::ios::binary);
+            fdlang::IR::IRCache::write(funcs, out);
+            if (!out) {
+                std::cerr << "Cannot write " << irCachePath << std::endl;
+                return false;
+            }
+        }
 
-    if (doModelChecker) {
-        fdlang::analysis::NaiveModelChecker modelChecker(root);
-        modelChecker.run();
-        modelChecker.dumpResult(std::cout);
-    }
+        if (doFormat) {
+            fdlang::ASTTraversePrinter printer(std::cout);
+            root->accept(&printer);
+        }
 
-    fdlang::IR::IRBuilder irBuilder(root);
-    fdlang::IR::Functions funcs = irBuilder.build();
+        if (doModelChecker) {
+            fdlang::analysis::NaiveModelChecker modelChecker(root);
+            modelChecker.run();
+            modelChecker.dumpResult(std::cout);
+        }
 
-    if (doDumpir) {
-        for (auto func : funcs) {
-            func->dump(std::cout);
-            std::cout << std::endl;
+        if (doDumpir) {
+            for (auto func : funcs) {
+                func->dump(std::cout);
+                std::cout << std::endl;
+            }
         }
-    }
 
-    if (doIntervalAnalysis || doZoneAnalysis) {
-        if (doIntervalAnalysis) {
-            fdlang::analysis::IntervalAnalysis analysis(funcs);
-            analysis.run();
-            analysis.dumpResult(std::cout);
+        if (doDumpSSA) {
+            for (auto func : funcs) {
+                fdlang::IR::SSAForm ssa(func);
+                ssa.dump(std::cout);
+                std::cout << std::endl;
+            }
         }
 
-        if (doZoneAnalysis) {
-            fdlang::analysis::RelationalNumericalAnalysis analysis(funcs);
+        if (doIntervalAnalysis || doValueSetAnalysis || doZoneAnalysis) {
+            if (doIntervalAnalysis) {
+                fdlang::analysis::IntervalAnalysis analysis(funcs);
+                analysis.setIterationStrategy(strategy);
+                if (wideningDelay >= 0)
+                    analysis.setWideningDelay(wideningDelay);
+                analysis.run();
+                analysis.dumpResult(std::cout);
+            }
+
+            if (doValueSetAnalysis) {
+                fdlang::analysis::ValueSetAnalysis analysis(funcs);
+                analysis.setIterationStrategy(strategy);
+                analysis.run();
+                analysis.dumpResult(std::cout);
+            }
+
+            if (doZoneAnalysis) {
+                fdlang::analysis::RelationalNumericalAnalysis analysis(funcs);
+                analysis.setIterationStrategy(strategy);
+                analysis.run();
+                analysis.dumpResult(std::cout);
+            }
+        }
+
+        if (doInterAnalysis) {
+            fdlang::analysis::InterAnalysis analysis(funcs);
             analysis.run();
             analysis.dumpResult(std::cout);
         }
+
+        return true;
+    };
+
+    if (doIncremental) {
+        // every line on standard input re-reads the source and re-runs the
+        // outputs, rebuilding only the functions whose text changed
+        fdlang::frontend::IncrementalFrontend frontend(numThreads);
+        std::string request;
+        do {
+            fdlang::SourceBuffer src(filepath);
+            if (src.hadError()) {
+                std::cerr << "Cannot read " << filepath << std::endl;
+            } else if (frontend.update(src.text())) {
+                if (!output(frontend.getAST(), frontend.getFunctions()))
+                    return 0;
+                std::cerr << "reused " << frontend.reusedFunctions()
+                          << ", rebuilt " << frontend.rebuiltFunctions()
+                          << " functions" << std::endl;
+            }
+            // a blank line ends every answer
+            std::cout << std::endl;
+        } while (std::getline(std::cin, request));
+        return 0;
     }
 
-    if (doInterAnalysis) {
-        fdlang::analysis::InterAnalysis analysis(funcs);
-        analysis.run();
-        analysis.dumpResult(std::cout);
+    fdlang::SourceBuffer src(filepath);
+    if (src.hadError()) {
+        std::cerr << "Cannot read " << filepath << std::endl;
+        return 0;
     }
+    fdlang::ASTNode *root;
+    fdlang::IR::Functions funcs;
+    std::unique_ptr<fdlang::IR::IRBuilder> irBuilder;
+    std::unique_ptr<fdlang::LoweringParser> loweringParser;
+    std::unique_ptr<fdlang::IR::IRCache> irCache;
+    fdlang::frontend::Frontend frontend(src.text(), numThreads);
+    if (doLoadIRCache) {
+        // the mapped file is read in place
+        irCache = std::make_unique<fdlang::IR::IRCache>(src.text());
+        if (irCache->hadError()) {
+            std::cerr << "Cannot load IR cache " << filepath << std::endl;
+            return 0;
+        }
+        funcs = irCache->getFunctions();
+    } else if (parallelFrontend) {
+        if (!frontend.run())
+            return 0;
+        root = frontend.getAST();
+        funcs = frontend.getFunctions();
+    } else if (!doFormat && !doModelChecker) {
+        // only the IR is needed, lower it while parsing
+        fdlang::Scanner scanner(src.text());
+        loweringParser = std::make_unique<fdlang::LoweringParser>(scanner);
+        loweringParser->parse();
+        if (scanner.hadError() || loweringParser->hadError() ||
+            loweringParser->getBuilder().hadError())
+            return 0;
+        funcs = loweringParser->getBuilder().getFunctions();
+    } else {
+        fdlang::Scanner scanner(src.text());
+        fdlang::Parser parser(scanner);
+        root = parser.parse();
+        if (scanner.hadError() || parser.hadError())
+            return 0;
+
+        fdlang::Sema sema(root);
+        if (!sema.check())
+            return 0;
+
+        irBuilder = std::make_unique<fdlang::IR::IRBuilder>(root);
+        funcs = irBuilder->build();
+    }
+
+    if (!output(root, funcs))
+        return 0;
 
     return 0;
 }
\ No newline at end of file